@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Records the golden files of --golden-verify into this folder, from a build
+# of a reference commit rather than of the working tree, so that later changes
+# to the voice, mixer and effects are checked against the sound from before.
+#
+# The default reference is 2cf3592, the commit that added the scenarios: the
+# first one they can be rendered on. Pass another commit to record from it.
+#
+#   PROJUCER=/path/to/Projucer JUCE_MODULES=/path/to/JUCE/modules Golden/record.sh [commit]
+#
+# Only run it again when a change of the sound is intended, and commit the
+# WAV files with that change.
+
+set -e
+
+commit=${1:-2cf3592}
+: "${PROJUCER:?set PROJUCER to the Projucer binary}"
+: "${JUCE_MODULES:?set JUCE_MODULES to the JUCE modules folder}"
+
+repo=$(git rev-parse --show-toplevel)
+work=$(mktemp -d)
+
+git -C "$repo" worktree add --detach "$work" "$commit"
+trap 'git -C "$repo" worktree remove --force "$work"' EXIT
+
+"$PROJUCER" --set-global-search-path linux defaultJuceModulePath "$JUCE_MODULES"
+"$PROJUCER" --resave "$work/Headless/simple_sampler_headless.jucer"
+make -C "$work/Headless/Builds/LinuxMakefile" CONFIG=Release -j"$(nproc)"
+
+"$work/Headless/Builds/LinuxMakefile/build/simple_sampler_headless" --golden-record "$repo/Golden"
+echo "Recorded from $(git -C "$repo" rev-parse --short "$commit") into $repo/Golden"
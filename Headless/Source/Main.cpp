@@ -0,0 +1,686 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 3:42:17pm
+    Author:  Vincent Choqueuse
+
+    Entry point of the headless build: the sampler engine with its audio and
+    MIDI devices, set up from a config file, without any window.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/SamplerEngine.h"
+#include "../../Source/EngineConfig.h"
+#include "../../Source/OfflineRenderer.h"
+#include "../../Source/Benchmarks.h"
+#include "../../Source/GoldenTests.h"
+#include "../../Source/KitPackage.h"
+#include "../../Source/Trace.h"
+#include "../../Source/RealtimeChecker.h"
+#include <atomic>
+#include <csignal>
+#include <iostream>
+
+namespace
+{
+    std::atomic<bool> quitRequested (false), traceRequested (false);
+
+    void requestQuit (int)
+    {
+        quitRequested = true;
+    }
+
+    void requestTrace (int)
+    {
+        traceRequested = true;
+    }
+
+    //==============================================================================
+    /** Watches for SIGINT/SIGTERM, reports once the engine can be played and what
+        the real-time settings could do, and dumps the callback statistics.
+     */
+    struct RunMonitor  : private Timer
+    {
+        RunMonitor (SamplerEngine& e, double startMs, double statsSeconds, OutputStream* statsOut, TraceDumper* dumper)
+        :   engine (e), bootStartMs (startMs), reported (false), tuningReported (false),
+            statsIntervalMs (statsSeconds * 1000.0), lastStatsMs (Time::getMillisecondCounterHiRes()),
+            statsStream (statsOut), traceDumper (dumper), previous (engine.getTelemetrySnapshot())
+        {
+            startTimer (50);
+        }
+
+        void timerCallback() override
+        {
+            if (quitRequested)
+            {
+                stopTimer();
+                MessageManager::getInstance()->stopDispatchLoop();
+                return;
+            }
+
+            if (traceRequested.exchange (false) && traceDumper != nullptr)
+                traceDumper->dumpNow();
+
+            const RealtimeTuning& tuning = engine.getRealtimeTuning();
+
+            if (! tuningReported && tuning.getSettings().enabled && tuning.isAudioThreadTuned())
+            {
+                tuningReported = true;
+                std::cout << tuning.getReport() << std::flush;
+            }
+
+            KitDownloader& downloader = engine.getKitDownloader();
+
+            if (! reported && (engine.isPlayable() || (! downloader.isBusy() && downloader.getStatus().isNotEmpty())))
+            {
+                reported = true;
+
+                if (engine.isPlayable())
+                    std::cout << "Playable after " << String (Time::getMillisecondCounterHiRes() - bootStartMs, 1) << " ms" << std::endl;
+                else
+                    std::cout << downloader.getStatus() << std::endl;
+            }
+
+            const double now = Time::getMillisecondCounterHiRes();
+
+            if (statsIntervalMs > 0.0 && now - lastStatsMs >= statsIntervalMs)
+            {
+                lastStatsMs = now;
+                writeStats();
+            }
+        }
+
+        /** One line of JSON: the figures of the last period, and the totals since the start. */
+        void writeStats()
+        {
+            const AudioTelemetry::Snapshot current (engine.getTelemetrySnapshot());
+
+            DynamicObject::Ptr totals (new DynamicObject());
+            totals->setProperty ("callbacks", current.numCallbacks);
+            totals->setProperty ("loadPercent", current.getLoadPercent());
+            totals->setProperty ("maxLoadPercent", current.maxLoadPercent);
+            totals->setProperty ("overruns", current.numOverruns);
+            totals->setProperty ("lateCallbacks", current.numLateCallbacks);
+            totals->setProperty ("deviceXruns", current.deviceXruns);
+            totals->setProperty ("peakVoices", current.peakVoices);
+
+            DynamicObject::Ptr line (new DynamicObject());
+            line->setProperty ("time", Time::getCurrentTime().toISO8601 (true));
+            line->setProperty ("uptimeSeconds", (Time::getMillisecondCounterHiRes() - bootStartMs) * 0.001);
+            line->setProperty ("period", current.since (previous).toVar());
+            line->setProperty ("total", var (totals.get()));
+            line->setProperty ("padPeaksDb", getPadPeaks());
+
+            const String json (JSON::toString (var (line.get()), true));
+
+            if (statsStream != nullptr)
+            {
+                statsStream->writeText (json + "\n", false, false, nullptr);
+                statsStream->flush();
+            }
+            else
+            {
+                std::cout << json << std::endl;
+            }
+
+            previous = current;
+        }
+
+        /** Held peak of each pad of the kit, in dB, as the voices last published it. */
+        var getPadPeaks() const
+        {
+            const VoiceStateChannel::Snapshot states (engine.getSynth().getVoiceStates());
+            Array<var> peaks;
+
+            for (int pad = 0; pad < jmin ((int) VoiceStateChannel::maxPads, engine.getSynth().nb_samples); ++pad)
+                peaks.add (roundToInt (Decibels::gainToDecibels (states.pads[pad].peakLevel) * 10.0f) / 10.0);
+
+            return peaks;
+        }
+
+        SamplerEngine& engine;
+        double bootStartMs;
+        bool reported, tuningReported;
+        double statsIntervalMs, lastStatsMs;
+        OutputStream* statsStream;
+        TraceDumper* traceDumper;
+        AudioTelemetry::Snapshot previous;
+    };
+
+    /** Prints the bytes fetched as a kit downloads, and stops the message loop once it is done. */
+    struct DownloadMonitor  : private Timer
+    {
+        DownloadMonitor (KitDownloader& d)  : downloader (d), lastBytes (-1)
+        {
+            startTimer (250);
+        }
+
+        void timerCallback() override
+        {
+            const int64 bytes = downloader.getBytesDownloaded();
+
+            if (bytes != lastBytes)
+            {
+                lastBytes = bytes;
+                std::cout << bytes << " / " << downloader.getTotalBytes() << " bytes" << std::endl;
+            }
+
+            if (quitRequested || ! downloader.isBusy())
+            {
+                stopTimer();
+                MessageManager::getInstance()->stopDispatchLoop();
+            }
+        }
+
+        KitDownloader& downloader;
+        int64 lastBytes;
+    };
+
+    /** In a build with SIMPLE_SAMPLER_RT_CHECK=1, how often the real-time code broke its rules. */
+    void printRealtimeSummary()
+    {
+        const String summary (RealtimeChecker::getSummary());
+
+        if (summary.isNotEmpty())
+            std::cout << summary << std::endl;
+    }
+
+    //==============================================================================
+    EngineConfig loadConfig (const ArgumentList& args)
+    {
+        EngineConfig config;
+        File configFile (EngineConfig::getDefaultFile());
+
+        if (args.containsOption ("--config"))
+            configFile = args.getExistingFileForOption ("--config");
+        else if (! configFile.existsAsFile())
+            return config;
+
+        const Result result (config.loadFromFile (configFile));
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+
+        return config;
+    }
+
+    void runEngine (const ArgumentList& args)
+    {
+        const double bootStartMs = Time::getMillisecondCounterHiRes();
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        const EngineConfig config (loadConfig (args));
+
+        // before the engine starts its threads, so that they all get a ring
+        if (args.containsOption ("--trace"))
+        {
+            if (! Trace::isCompiledIn())
+                std::cout << "Built without SIMPLE_SAMPLER_TRACE=1, the trace will be empty" << std::endl;
+
+            Trace::enable();
+            TRACE_THREAD_NAME ("message");
+        }
+
+        SamplerEngine engine;
+        const String error (engine.initialise (config));
+
+        if (error.isNotEmpty())
+            ConsoleApplication::fail ("Cannot open the audio device: " + error);
+
+        if (AudioIODevice* device = engine.getDeviceManager().getCurrentAudioDevice())
+            std::cout << device->getName() << ", " << device->getCurrentSampleRate() << " Hz, "
+                      << device->getCurrentBufferSizeSamples() << " samples" << std::endl;
+
+        // appended to, so a restarted service keeps its history
+        std::unique_ptr<FileOutputStream> statsFile;
+
+        if (args.containsOption ("--stats-file"))
+        {
+            statsFile = args.getFileForOption ("--stats-file").createOutputStream();
+
+            if (statsFile == nullptr || statsFile->failedToOpen())
+                ConsoleApplication::fail ("Cannot write " + args.getFileForOption ("--stats-file").getFullPathName());
+        }
+
+        const double statsSeconds = args.containsOption ("--stats") ? args.getValueForOption ("--stats").getDoubleValue()
+                                                                    : (statsFile != nullptr ? 10.0 : 0.0);
+
+        // on each xrun the device or the callback timing reports, and on SIGUSR1
+        std::unique_ptr<TraceDumper> traceDumper;
+
+        if (args.containsOption ("--trace"))
+            traceDumper.reset (new TraceDumper (args.getFileForOption ("--trace"), [&engine]
+            {
+                const AudioTelemetry::Snapshot snapshot (engine.getTelemetrySnapshot());
+                return snapshot.numOverruns + snapshot.numLateCallbacks + jmax (0, snapshot.deviceXruns);
+            }));
+
+        std::signal (SIGINT, requestQuit);
+        std::signal (SIGTERM, requestQuit);
+
+       #ifdef SIGUSR1
+        std::signal (SIGUSR1, requestTrace);
+       #endif
+
+        {
+            RunMonitor monitor (engine, bootStartMs, statsSeconds, statsFile.get(), traceDumper.get());
+            MessageManager::getInstance()->runDispatchLoop();
+        }
+
+        engine.shutdown();
+        printRealtimeSummary();
+    }
+
+    void downloadKit (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        EngineConfig config (loadConfig (args));
+
+        if (args.containsOption ("--kit-server"))
+            config.kitServer = args.getValueForOption ("--kit-server");
+
+        if (args.containsOption ("--kit-root"))
+            config.kitRoot = args.getFileForOption ("--kit-root");
+
+        if (args.containsOption ("--parallel"))
+            config.maxParallelDownloads = args.getValueForOption ("--parallel").getIntValue();
+
+        // no audio device: only the synth the samples load into
+        DrumSynthesiser synth;
+        synth.setKitRoot (config.kitRoot);
+
+        KitDownloader downloader (synth);
+        downloader.setMaxParallelDownloads (config.maxParallelDownloads);
+
+        if (config.kitServer.isNotEmpty())
+            downloader.setServer (config.kitServer);
+
+        std::signal (SIGINT, requestQuit);
+        std::signal (SIGTERM, requestQuit);
+
+        const double startMs = Time::getMillisecondCounterHiRes();
+        downloader.downloadKit (args[1].text.getIntValue());
+
+        {
+            DownloadMonitor monitor (downloader);
+            MessageManager::getInstance()->runDispatchLoop();
+        }
+
+        std::cout << downloader.getStatus() << " in " << String (Time::getMillisecondCounterHiRes() - startMs, 0) << " ms" << std::endl;
+
+        if (! downloader.isKitReady())
+            ConsoleApplication::fail ("The kit is incomplete, run again to resume");
+
+        if (downloader.getNumFailed() > 0)
+            ConsoleApplication::fail ("The kit is not up to date, run again to resume");
+    }
+
+    void packKit (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (3);
+
+        const File folder (args[1].resolveAsExistingFolder());
+        const File packageFile (args[2].resolveAsFile());
+
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        Array<File> files (folder.findChildFiles (File::findFiles, false, formatManager.getWildcardForAllFormats()));
+        files.sort();
+
+        if (files.isEmpty())
+            ConsoleApplication::fail ("No audio file in " + folder.getFullPathName());
+
+        // a pad the synth does not have would be packed and never played
+        if (files.size() > DrumSynthesiser::getNumPads())
+            ConsoleApplication::fail (String (files.size()) + " audio files in " + folder.getFullPathName() + ", but a kit has "
+                                        + String (DrumSynthesiser::getNumPads()) + " pads");
+
+        // pad i plays on note 36 + i, as the pads of the synth do
+        Array<KitPackage::Pad> pads;
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (files.getReference (i)));
+
+            if (reader == nullptr || reader->sampleRate <= 0.0)
+                ConsoleApplication::fail ("Cannot decode " + files.getReference (i).getFullPathName());
+
+            KitPackage::Pad pad;
+            pad.name = files.getReference (i).getFileNameWithoutExtension();
+            pad.padIndex = i;
+            pad.rootNote = 36 + i;
+            pad.data = SampleBuffer::readFrom (*reader, (int64) (DrumSynthesiser::maxSampleSeconds * reader->sampleRate));
+            pads.add (pad);
+
+            if (pad.data->getLength() < reader->lengthInSamples)
+                std::cerr << files.getReference (i).getFileName() << ": " << String (reader->lengthInSamples / reader->sampleRate, 1)
+                          << " s long, only the first " << (int) DrumSynthesiser::maxSampleSeconds << " s are packed" << std::endl;
+        }
+
+        const Result result (KitPackage::write (packageFile, pads, args.containsOption ("--compress")));
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+
+        std::cout << pads.size() << " pads, " << File::descriptionOfSizeInBytes (packageFile.getSize()) << std::endl;
+    }
+
+    void printKitInfo (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+
+        KitPackage::Ptr package;
+        const Result result (KitPackage::open (args[1].resolveAsExistingFile(), package));
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+
+        for (int i = 0; i < package->getNumPads(); ++i)
+        {
+            const KitPackage::Pad& pad = package->getPad (i);
+
+            std::cout << "pad " << pad.padIndex << "  note " << pad.rootNote << "  " << pad.name
+                      << "  " << (package->isMapped (i) ? "raw " : "deflated ")
+                      << File::descriptionOfSizeInBytes (package->getStoredSize (i))
+                      << (pad.padIndex >= DrumSynthesiser::getNumPads() ? "  (no such pad, not played)" : "") << std::endl;
+        }
+    }
+
+    void sliceLoop (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        const EngineConfig config (loadConfig (args));
+        TransientSlicer::Options options;
+
+        if (args.containsOption ("--slices"))
+            options.maxSlices = args.getValueForOption ("--slices").getIntValue();
+
+        if (args.containsOption ("--threshold"))
+            options.threshold = args.getValueForOption ("--threshold").getFloatValue();
+
+        DrumSynthesiser synth;
+        synth.setSampleProcessing (config.trimSilence, config.normaliseLoudness);
+
+        CustomSamplerSound* loop = dynamic_cast<CustomSamplerSound*> (synth.getSound (0).get());
+
+        if (loop == nullptr)
+            ConsoleApplication::fail ("The synth has no pad to load the loop into");
+
+        loop->setAudioFile (args[1].resolveAsExistingFile());
+        loop->loadSound();
+
+        const double startMs = Time::getMillisecondCounterHiRes();
+        const Result result (synth.sliceToPads (0, options));
+        const double elapsedMs = Time::getMillisecondCounterHiRes() - startMs;
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+
+        const SampleBuffer::Ptr data (loop->getSampleData());
+
+        const double seconds = data->getLength() / data->getSampleRate();
+
+        for (int i = 0; i < synth.getNumSounds(); ++i)
+        {
+            const CustomSamplerSound* sound = dynamic_cast<const CustomSamplerSound*> (synth.getSound (i).get());
+
+            if (sound == nullptr || sound->getSampleData() != data)
+                break;
+
+            std::cout << "pad " << i << "  note " << sound->midiRootNote
+                      << "  " << String (sound->sample_start * seconds, 3) << " s"
+                      << "  " << String ((sound->sample_end - sound->sample_start) * seconds, 3) << " s" << std::endl;
+        }
+
+        std::cout << "Sliced " << String (seconds, 2) << " s in " << String (elapsedMs, 1) << " ms" << std::endl;
+    }
+
+    void renderMidiFile (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (3);
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        EngineConfig config (loadConfig (args));
+
+        if (args.containsOption ("--kit"))
+            config.kit = args.getValueForOption ("--kit").getIntValue();
+
+        OfflineRenderer::Options options;
+
+        if (args.containsOption ("--rate"))
+            options.sampleRate = args.getValueForOption ("--rate").getDoubleValue();
+
+        if (args.containsOption ("--block"))
+            options.blockSize = args.getValueForOption ("--block").getIntValue();
+
+        if (args.containsOption ("--threads"))
+            options.numThreads = args.getValueForOption ("--threads").getIntValue();
+
+        if (args.containsOption ("--tail"))
+            options.tailSeconds = args.getValueForOption ("--tail").getDoubleValue();
+
+        const int bitsPerSample = args.containsOption ("--bits") ? args.getValueForOption ("--bits").getIntValue() : 24;
+
+        MidiFile midiFile;
+        Result result (OfflineRenderer::readMidiFile (args[1].resolveAsExistingFile(), midiFile));
+
+        AudioSampleBuffer audio;
+        OfflineRenderer renderer (config);
+
+        if (result.wasOk())
+            result = renderer.render (midiFile, options, audio);
+
+        if (result.wasOk())
+            result = OfflineRenderer::writeWavFile (audio, options.sampleRate, bitsPerSample, args[2].resolveAsFile());
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+
+        const OfflineRenderer::Stats& stats = renderer.getLastStats();
+
+        std::cout << String (stats.audioSeconds, 2) << " s of audio rendered in " << String (stats.renderSeconds, 3) << " s ("
+                  << String (stats.audioSeconds / jmax (1.0e-6, stats.renderSeconds), 1) << "x real time, "
+                  << stats.numSegments << (stats.numSegments > 1 ? " segments)" : " segment)") << std::endl;
+
+        printRealtimeSummary();
+    }
+
+    void runSamplerBenchmarks (const ArgumentList& args)
+    {
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        const double sampleRate = args.containsOption ("--rate") ? args.getValueForOption ("--rate").getDoubleValue() : 48000.0;
+        const String json (Benchmarks::runSampler (args.getValueForOption ("--filter"), sampleRate));
+
+        if (args.containsOption ("--out"))
+        {
+            const File file (args.getFileForOption ("--out"));
+
+            if (! file.replaceWithText (json))
+                ConsoleApplication::fail ("Cannot write " + file.getFullPathName());
+        }
+        else
+        {
+            std::cout << json << std::flush;
+        }
+    }
+
+    void recordGoldenFiles (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        const Result result (GoldenTests::record (args[1].resolveAsFile(), args.getValueForOption ("--filter")));
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+    }
+
+    void verifyGoldenFiles (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        int numFailed = 0;
+
+        for (auto& outcome : GoldenTests::verify (args[1].resolveAsExistingFolder(), args.getValueForOption ("--filter")))
+        {
+            std::cout << GoldenTests::describe (outcome) << std::endl;
+
+            if (! outcome.passed)
+                ++numFailed;
+        }
+
+        printRealtimeSummary();
+
+        if (numFailed > 0)
+            ConsoleApplication::fail (String (numFailed) + " scenario(s) or check(s) failed");
+
+        // the render of a block must not touch the heap, lock or block (counted with SIMPLE_SAMPLER_RT_CHECK=1 only)
+        const int64 numHeapCalls = RealtimeChecker::getNumViolations (RealtimeChecker::allocation)
+                                     + RealtimeChecker::getNumViolations (RealtimeChecker::deallocation);
+        const int64 numLocks = RealtimeChecker::getNumViolations (RealtimeChecker::lock);
+        const int64 numBlockingCalls = RealtimeChecker::getNumViolations (RealtimeChecker::blockingCall);
+
+        if (numHeapCalls > 0)
+            ConsoleApplication::fail ("The render path used the heap " + String (numHeapCalls) + " time(s)");
+
+        if (numLocks > 0)
+            ConsoleApplication::fail ("The render path took a lock " + String (numLocks) + " time(s)");
+
+        if (numBlockingCalls > 0)
+            ConsoleApplication::fail ("The render path made a blocking call " + String (numBlockingCalls) + " time(s)");
+    }
+
+    void listDevices (const ArgumentList&)
+    {
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+        AudioDeviceManager deviceManager;
+
+        for (auto* type : deviceManager.getAvailableDeviceTypes())
+        {
+            type->scanForDevices();
+            std::cout << type->getTypeName() << std::endl;
+
+            for (auto& name : type->getDeviceNames (false))
+                std::cout << "    " << name << std::endl;
+        }
+
+        std::cout << "MIDI inputs" << std::endl;
+
+        for (auto& device : MidiInput::getAvailableDevices())
+            std::cout << "    " << device.name << std::endl;
+    }
+
+    void writeConfig (const ArgumentList& args)
+    {
+        args.checkMinNumArguments (2);
+
+        const Result result (loadConfig (args).saveToFile (args[1].resolveAsFile()));
+
+        if (result.failed())
+            ConsoleApplication::fail (result.getErrorMessage());
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    ConsoleApplication app;
+
+    app.addHelpCommand ("--help|-h", "Usage: simple_sampler_headless [--config=file.json]", true);
+    app.addVersionCommand ("--version|-v", String (ProjectInfo::projectName) + " " + ProjectInfo::versionString);
+
+    app.addDefaultCommand ({ "--run",
+                             "--run [--config=file.json] [--stats=seconds] [--stats-file=file.jsonl] [--trace=folder]",
+                             "Runs the sampler until SIGINT or SIGTERM (the default).",
+                             "Without --config, " + EngineConfig::getDefaultFile().getFullPathName()
+                                + " is used if it exists, the built-in defaults otherwise.\n"
+                                "--stats prints a line of JSON with the DSP load, xruns and voice counts every\n"
+                                "few seconds; --stats-file appends those lines to a file instead (every 10 s by default).\n"
+                                "--trace writes a Chrome trace of the last events of every thread into the folder after\n"
+                                "each xrun, and on SIGUSR1 (needs a build with SIMPLE_SAMPLER_TRACE=1).",
+                             runEngine });
+
+    app.addCommand ({ "--write-config",
+                      "--write-config file.json [--config=file.json]",
+                      "Writes a complete config file to edit.",
+                      "Starts from the defaults, or from the config given with --config.",
+                      writeConfig });
+
+    app.addCommand ({ "--download-kit",
+                      "--download-kit number [--kit-server=url] [--kit-root=folder] [--parallel=4] [--config=file.json]",
+                      "Syncs a kit with the server: fetches its new, changed and missing samples and loads them.",
+                      "Only the samples whose hash in the server's manifest differs from the last sync move, and\n"
+                      "kits share the samples they have in common. Interrupted downloads resume where they stopped.\n"
+                      "--kit-server points to another copy of the kit folders, e.g. http://127.0.0.1:8000 served\n"
+                      "by python3 -m http.server, or file:///mnt/kits.",
+                      downloadKit });
+
+    app.addCommand ({ "--pack-kit",
+                      "--pack-kit folder out.sskit [--compress]",
+                      "Packs the audio files of a folder, in name order, into a single kit package.",
+                      "Name it kitN.sskit in the kit root and kit N loads from it, its raw pads straight from\n"
+                      "the mapped file. --compress deflates the pads that get smaller, losslessly.",
+                      packKit });
+
+    app.addCommand ({ "--kit-info",
+                      "--kit-info file.sskit",
+                      "Lists the pads of a kit package.",
+                      String(),
+                      printKitInfo });
+
+    app.addCommand ({ "--slice",
+                      "--slice loop.wav [--slices=8] [--threshold=0.1] [--config=file.json]",
+                      "Cuts a loop at its hits into one slice per pad and lists them, with the time taken.",
+                      "Every pad plays the same buffer between its own start and end. There are never more\n"
+                      "slices than pads, 8. A lower --threshold finds softer hits; the trimming and\n"
+                      "normalisation of the config apply.",
+                      sliceLoop });
+
+    app.addCommand ({ "--golden-record",
+                      "--golden-record folder [--filter=name]",
+                      "Renders the regression scenarios into golden WAV files.",
+                      "Run on a reference build, and only when a change of the sound is intended: Golden/record.sh\n"
+                      "builds a reference commit and records from it.",
+                      recordGoldenFiles });
+
+    app.addCommand ({ "--golden-verify",
+                      "--golden-verify folder [--filter=name]",
+                      "Renders the regression scenarios and compares them with the golden files.",
+                      "Prints the largest deviation and the SNR of each scenario, and exits with 1 if one\n"
+                      "of them is outside its tolerance, or, in a build with SIMPLE_SAMPLER_RT_CHECK=1, if\n"
+                      "the render of a block allocated or freed memory, took a lock or made a blocking call.",
+                      verifyGoldenFiles });
+
+    app.addCommand ({ "--render",
+                      "--render in.mid out.wav [--config=file.json] [--kit=n] [--rate=48000] [--block=512] [--threads=n] [--tail=seconds] [--bits=24]",
+                      "Renders a MIDI file to a WAV file as fast as possible.",
+                      "No audio device is opened: the kit is loaded from disk and the whole engine runs offline.\n"
+                      "The output is the same for the same input, config, rate and block size. --threads=0 uses\n"
+                      "every CPU; long files are then cut where everything has gone silent.",
+                      renderMidiFile });
+
+    app.addCommand ({ "--list-devices",
+                      "--list-devices",
+                      "Lists the audio and MIDI devices the config file can name.",
+                      String(),
+                      listDevices });
+
+    app.addCommand ({ "--bench",
+                      "--bench [--filter=group] [--rate=48000] [--out=results.json]",
+                      "Times the sampler hot paths on synthetic samples and prints the results as JSON.",
+                      "The groups are voice_render, synth_render, note_on, start_note, load_sound, slice and reverb.\n"
+                      "The output describes the CPU and build too, to compare runs across commits and machines.",
+                      runSamplerBenchmarks });
+
+    return app.findAndRunCommand (argc, argv);
+}
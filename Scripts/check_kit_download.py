@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+#
+# Checks the retry and reject paths of --download-kit against a local HTTP
+# server that serves kit 1 with a manifest:
+#   - Tranche1 is cut off halfway the first time: it must resume with a Range
+#     request and end up whole;
+#   - Tranche2 never matches its SHA-256: it must be fetched maxAttempts times,
+#     then rejected, with nothing of it left on disk;
+#   - the other samples must sync as usual.
+#
+#   python3 Scripts/check_kit_download.py path/to/simple_sampler_headless
+#
+# Exits with 1 and says what went wrong if a check fails. Takes about 10 s,
+# most of it the retry delays of the corrupt file.
+
+import hashlib
+import http.server
+import io
+import json
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import wave
+
+SAMPLES_PER_KIT = 8
+MAX_ATTEMPTS = 5
+TRUNCATED = "Tranche1.aif"
+CORRUPT = "Tranche2.aif"
+
+
+def make_sample(index):
+    """A short 16-bit WAV; the sampler finds the format from the content, whatever the name."""
+    frames = b"".join(struct.pack("<h", ((i * 37 * index) % 2000) - 1000) for i in range(4410))
+    data = io.BytesIO()
+
+    with wave.open(data, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(44100)
+        w.writeframes(frames)
+
+    return data.getvalue()
+
+
+class KitServer(http.server.ThreadingHTTPServer):
+    def __init__(self, files):
+        super().__init__(("127.0.0.1", 0), KitHandler)
+        self.files = files
+        self.requests = []
+        self.lock = threading.Lock()
+        self.truncated_once = False
+
+
+class KitHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, *args):
+        pass
+
+    def do_GET(self):
+        name = self.path.rsplit("/", 1)[-1]
+        range_header = self.headers.get("Range")
+
+        with self.server.lock:
+            self.server.requests.append((name, range_header))
+            cut_off = name == TRUNCATED and not self.server.truncated_once
+
+            if cut_off:
+                self.server.truncated_once = True
+
+        if not self.path.startswith("/kit1/") or name not in self.server.files:
+            self.send_error(404)
+            return
+
+        body = self.server.files[name]
+
+        if name == CORRUPT:
+            body = body[:-1] + bytes([body[-1] ^ 0xff])
+
+        start = 0
+
+        if range_header is not None and range_header.startswith("bytes="):
+            start = int(range_header[len("bytes="):].split("-")[0])
+
+            if start >= len(body):
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % len(body))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
+            self.send_response(206)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, len(body) - 1, len(body)))
+        else:
+            self.send_response(200)
+
+        self.send_header("Content-Length", str(len(body) - start))
+        self.end_headers()
+
+        if cut_off:
+            # the connection drops halfway through
+            self.wfile.write(body[:len(body) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+
+        self.wfile.write(body[start:])
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: check_kit_download.py path/to/simple_sampler_headless")
+
+    headless = sys.argv[1]
+    samples = {"Tranche%d.aif" % i: make_sample(i) for i in range(1, SAMPLES_PER_KIT + 1)}
+    manifest = {"files": [{"name": name, "size": len(data), "sha256": hashlib.sha256(data).hexdigest()}
+                          for name, data in samples.items()]}
+
+    files = dict(samples)
+    files["manifest.json"] = json.dumps(manifest).encode()
+
+    server = KitServer(files)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    failures = []
+
+    def check(condition, message):
+        if not condition:
+            failures.append(message)
+
+    with tempfile.TemporaryDirectory() as root:
+        run = subprocess.run([headless, "--download-kit", "1",
+                              "--kit-server=http://127.0.0.1:%d" % server.server_address[1],
+                              "--kit-root=" + root, "--parallel=4"],
+                             capture_output=True, text=True, timeout=120)
+        server.shutdown()
+        output = run.stdout + run.stderr
+
+        # the corrupt file leaves the kit incomplete
+        check(run.returncode != 0, "--download-kit succeeded with a corrupt sample")
+        check("checksum mismatch" in output, "the status does not report the checksum mismatch:\n" + output)
+
+        # retry: the cut-off file resumed from where it stopped, and is whole
+        resumed = [r for n, r in server.requests if n == TRUNCATED and r is not None]
+        check(any(r != "bytes=0-" for r in resumed), "%s was not resumed with a Range request" % TRUNCATED)
+
+        target = os.path.join(root, "kit1", "mysample1.aif")
+        check(os.path.isfile(target) and open(target, "rb").read() == samples[TRUNCATED],
+              "%s is missing or differs from the served file after the resume" % TRUNCATED)
+
+        # reject: fetched maxAttempts times, nothing of it kept
+        attempts = [n for n, _ in server.requests if n == CORRUPT]
+        check(len(attempts) == MAX_ATTEMPTS, "%s was fetched %d times instead of %d" % (CORRUPT, len(attempts), MAX_ATTEMPTS))
+        check(not os.path.exists(os.path.join(root, "kit1", "mysample2.aif")), "the corrupt %s was installed" % CORRUPT)
+
+        blobs = os.path.join(root, "blobs")
+        leftovers = os.listdir(blobs) if os.path.isdir(blobs) else []
+        corrupt_hash = hashlib.sha256(samples[CORRUPT]).hexdigest()
+        check(not any(f.startswith(corrupt_hash) for f in leftovers), "the corrupt %s left %s in the store" % (CORRUPT, leftovers))
+
+        # the others went through
+        for i in range(3, SAMPLES_PER_KIT + 1):
+            path = os.path.join(root, "kit1", "mysample%d.aif" % i)
+            check(os.path.isfile(path) and open(path, "rb").read() == samples["Tranche%d.aif" % i],
+                  "mysample%d.aif is missing or wrong" % i)
+
+    for failure in failures:
+        print("FAIL  " + failure)
+
+    if failures:
+        sys.exit(1)
+
+    print("pass  truncated file resumed, corrupt file rejected after %d attempts" % MAX_ATTEMPTS)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    AudioTelemetry.cpp
+    Created: 19 Oct 2026 6:48:30pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AudioTelemetry.h"
+
+namespace
+{
+    // a single thread writes each counter, so no read-modify-write instruction is needed
+    template <typename Type>
+    inline void addTo (std::atomic<Type>& counter, Type amount) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+AudioTelemetry::Snapshot::Snapshot()
+:   sampleRate (0.0),
+    blockSize (0),
+    numCallbacks (0),
+    numSamples (0),
+    busySeconds (0.0),
+    numOverruns (0),
+    numLateCallbacks (0),
+    maxLoadPercent (0.0),
+    activeVoices (0),
+    peakVoices (0),
+    deviceXruns (-1)
+{
+    zeromem (histogram, sizeof (histogram));
+}
+
+AudioTelemetry::Snapshot AudioTelemetry::Snapshot::since (const Snapshot& earlier) const
+{
+    Snapshot period (*this);
+    period.numCallbacks -= earlier.numCallbacks;
+    period.numSamples -= earlier.numSamples;
+    period.busySeconds -= earlier.busySeconds;
+    period.numOverruns -= earlier.numOverruns;
+    period.numLateCallbacks -= earlier.numLateCallbacks;
+
+    if (deviceXruns >= 0 && earlier.deviceXruns >= 0)
+        period.deviceXruns -= earlier.deviceXruns;
+
+    for (int i = 0; i < numBins; ++i)
+        period.histogram[i] -= earlier.histogram[i];
+
+    period.maxLoadPercent = period.numCallbacks > 0 ? period.getLoadPercentile (1.0) : 0.0;
+    return period;
+}
+
+double AudioTelemetry::Snapshot::getLoadPercent() const
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return 0.0;
+
+    return 100.0 * busySeconds * sampleRate / (double) numSamples;
+}
+
+double AudioTelemetry::Snapshot::getLoadPercentile (double fraction) const
+{
+    int64 total = 0;
+
+    for (auto count : histogram)
+        total += count;
+
+    if (total == 0)
+        return 0.0;
+
+    const int64 target = jmax ((int64) 1, (int64) std::ceil (fraction * (double) total));
+    int64 count = 0;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        count += histogram[i];
+
+        if (count >= target)
+            return (double) ((i + 1) * binWidthPercent);
+    }
+
+    return (double) (numBins * binWidthPercent);
+}
+
+var AudioTelemetry::Snapshot::toVar() const
+{
+    DynamicObject::Ptr object (new DynamicObject());
+    object->setProperty ("sampleRate", sampleRate);
+    object->setProperty ("blockSize", blockSize);
+    object->setProperty ("callbacks", numCallbacks);
+    object->setProperty ("loadPercent", getLoadPercent());
+    object->setProperty ("maxLoadPercent", maxLoadPercent);
+    object->setProperty ("p50LoadPercent", getLoadPercentile (0.5));
+    object->setProperty ("p99LoadPercent", getLoadPercentile (0.99));
+    object->setProperty ("p999LoadPercent", getLoadPercentile (0.999));
+    object->setProperty ("overruns", numOverruns);
+    object->setProperty ("lateCallbacks", numLateCallbacks);
+    object->setProperty ("deviceXruns", deviceXruns);
+    object->setProperty ("activeVoices", activeVoices);
+    object->setProperty ("peakVoices", peakVoices);
+
+    // one count per bin of binWidthPercent, without the empty bins at the end
+    int lastUsedBin = numBins;
+
+    while (lastUsedBin > 0 && histogram[lastUsedBin - 1] == 0)
+        --lastUsedBin;
+
+    Array<var> bins;
+
+    for (int i = 0; i < lastUsedBin; ++i)
+        bins.add (histogram[i]);
+
+    object->setProperty ("histogramBinPercent", (int) binWidthPercent);
+    object->setProperty ("histogram", bins);
+
+    return var (object.get());
+}
+
+//==============================================================================
+AudioTelemetry::AudioTelemetry()
+:   ticksPerSecond ((double) Time::getHighResolutionTicksPerSecond()),
+    lastStartTicks (0),
+    sampleRate (0.0),
+    blockSize (0),
+    sequence (0)
+{
+    reset();
+}
+
+void AudioTelemetry::prepare (double newSampleRate, int newBlockSize) noexcept
+{
+    sampleRate = newSampleRate;
+    blockSize = newBlockSize;
+    lastStartTicks = 0;
+}
+
+void AudioTelemetry::reset() noexcept
+{
+    numCallbacks = 0;
+    numSamples = 0;
+    busyTicks = 0;
+    numOverruns = 0;
+    numLateCallbacks = 0;
+    maxLoadPercent = 0.0f;
+    activeVoices = 0;
+    peakVoices = 0;
+
+    for (auto& count : histogram)
+        count = 0;
+}
+
+int64 AudioTelemetry::callbackStarted() noexcept
+{
+    return Time::getHighResolutionTicks();
+}
+
+void AudioTelemetry::callbackFinished (int64 startTicks, int numSamplesDone, int numActiveVoices) noexcept
+{
+    const int64 endTicks = Time::getHighResolutionTicks();
+    const double rate = sampleRate.load (std::memory_order_relaxed);
+
+    if (rate <= 0.0 || numSamplesDone <= 0)
+        return;
+
+    // a seqlock: the reader retries if this moved while it read
+    const uint32 sequenceAtStart = sequence.load (std::memory_order_relaxed);
+    sequence.store (sequenceAtStart + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    const double periodTicks = numSamplesDone * ticksPerSecond / rate;
+    const int64 elapsed = endTicks - startTicks;
+    const float load = (float) (100.0 * (double) elapsed / periodTicks);
+
+    // the device should call back once per period, a longer gap means it missed one
+    if (lastStartTicks != 0 && (double) (startTicks - lastStartTicks) > 1.5 * periodTicks)
+        addTo (numLateCallbacks, (int64) 1);
+
+    lastStartTicks = startTicks;
+
+    if (load > 100.0f)
+        addTo (numOverruns, (int64) 1);
+
+    if (load > maxLoadPercent.load (std::memory_order_relaxed))
+        maxLoadPercent.store (load, std::memory_order_relaxed);
+
+    addTo (histogram[jlimit (0, (int) numBins - 1, (int) (load / (float) binWidthPercent))], (int64) 1);
+    addTo (busyTicks, elapsed);
+    addTo (numSamples, (int64) numSamplesDone);
+
+    activeVoices.store (numActiveVoices, std::memory_order_relaxed);
+
+    if (numActiveVoices > peakVoices.load (std::memory_order_relaxed))
+        peakVoices.store (numActiveVoices, std::memory_order_relaxed);
+
+    addTo (numCallbacks, (int64) 1);
+
+    sequence.store (sequenceAtStart + 2, std::memory_order_release);
+}
+
+AudioTelemetry::Snapshot AudioTelemetry::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+
+    for (;;)
+    {
+        const uint32 before = sequence.load (std::memory_order_acquire);
+
+        if ((before & 1) == 0)
+        {
+            snapshot.sampleRate = sampleRate.load();
+            snapshot.blockSize = blockSize.load();
+            snapshot.numCallbacks = numCallbacks.load (std::memory_order_relaxed);
+            snapshot.numSamples = numSamples.load (std::memory_order_relaxed);
+            snapshot.busySeconds = (double) busyTicks.load (std::memory_order_relaxed) / ticksPerSecond;
+            snapshot.numOverruns = numOverruns.load (std::memory_order_relaxed);
+            snapshot.numLateCallbacks = numLateCallbacks.load (std::memory_order_relaxed);
+            snapshot.maxLoadPercent = maxLoadPercent.load (std::memory_order_relaxed);
+            snapshot.activeVoices = activeVoices.load (std::memory_order_relaxed);
+            snapshot.peakVoices = peakVoices.load (std::memory_order_relaxed);
+
+            for (int i = 0; i < numBins; ++i)
+                snapshot.histogram[i] = histogram[i].load (std::memory_order_relaxed);
+
+            // the loads above may not move past this one
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if (sequence.load (std::memory_order_relaxed) == before)
+                return snapshot;
+        }
+
+        // a callback is writing: it takes microseconds
+        Thread::yield();
+    }
+}
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    AudioTelemetry.h
+    Created: 19 Oct 2026 6:48:30pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef AUDIOTELEMETRY_H_INCLUDED
+#define AUDIOTELEMETRY_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ Timing of every audio callback, to size the polyphony and the buffer size of
+ a device in the field.
+
+ The audio thread brackets each callback with callbackStarted() and
+ callbackFinished(). These only do relaxed atomic stores: counters, a
+ histogram of the load and the voice count, between two steps of a sequence
+ count. Any other thread can pull a Snapshot at any time; it reads again if a
+ callback wrote meanwhile, so the figures of a snapshot always agree. The counters only ever grow, so each reader keeps its
+ previous snapshot and uses since() to get the figures of its own period. The
+ GUI meter and the headless stats dump can run at different rates that way.
+ */
+class AudioTelemetry
+{
+public:
+    enum
+    {
+        numBins = 100,          // histogram of the load of each callback against its deadline
+        binWidthPercent = 2     // so the last bin counts every callback at 198% or more
+    };
+
+    struct Snapshot
+    {
+        Snapshot();
+
+        double sampleRate;
+        int blockSize;
+
+        int64 numCallbacks, numSamples;
+        double busySeconds;
+        int64 numOverruns;          // callbacks that took longer than their own duration
+        int64 numLateCallbacks;     // started more than 1.5 periods after the previous one
+        double maxLoadPercent;      // worst callback
+        int activeVoices, peakVoices;
+        int deviceXruns;            // counted by the device since it opened, -1 if it cannot tell
+        int64 histogram[numBins];
+
+        /** The counters and the histogram between earlier and this snapshot. The
+            worst load then comes from the histogram, to the nearest bin.
+         */
+        Snapshot since (const Snapshot& earlier) const;
+
+        /** Time spent in the callbacks over the duration of the audio they made. */
+        double getLoadPercent() const;
+
+        /** Load that this fraction of the callbacks stays under (upper edge of its bin). */
+        double getLoadPercentile (double fraction) const;
+
+        var toVar() const;
+    };
+
+    AudioTelemetry();
+
+    /** Before the callbacks start. Keeps the totals, which reset() clears. */
+    void prepare (double sampleRate, int blockSize) noexcept;
+
+    /** Clears the counters. Not exact while the audio runs, a callback finishing
+        at the same time may survive it.
+     */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Audio thread, first thing in the callback. Returns the start time to give to callbackFinished(). */
+    int64 callbackStarted() noexcept;
+
+    /** Audio thread, last thing in the callback. */
+    void callbackFinished (int64 startTicks, int numSamples, int numActiveVoices) noexcept;
+
+    //==============================================================================
+    /** Any thread, never the audio one. deviceXruns is left at -1, SamplerEngine fills it in. */
+    Snapshot getSnapshot() const noexcept;
+
+private:
+    const double ticksPerSecond;
+    int64 lastStartTicks;
+
+    std::atomic<double> sampleRate;
+    std::atomic<int> blockSize;
+
+    std::atomic<int64> numCallbacks, numSamples, busyTicks, numOverruns, numLateCallbacks;
+    std::atomic<float> maxLoadPercent;
+    std::atomic<int> activeVoices, peakVoices;
+    std::atomic<int64> histogram[numBins];
+    std::atomic<uint32> sequence;           // odd while callbackFinished() writes
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioTelemetry)
+};
+
+
+#endif  // AUDIOTELEMETRY_H_INCLUDED
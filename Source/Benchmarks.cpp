@@ -0,0 +1,511 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Created: 19 Oct 2026 11:40:27am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+#include "ConvolutionReverb.h"
+#include "DrumSynthesiser.h"
+#include "TransientSlicer.h"
+
+namespace
+{
+    struct Timing
+    {
+        double median, best;    // seconds per call
+    };
+
+    Timing summarise (Array<double>& runs)
+    {
+        runs.sort();
+        return { runs[runs.size() / 2], runs.getFirst() };
+    }
+
+    /** Calls function callsPerRun times per run, after one run to warm the caches up. */
+    template <typename Function>
+    Timing measure (int callsPerRun, int numRuns, Function&& function)
+    {
+        Array<double> runs;
+
+        for (int run = -1; run < numRuns; ++run)
+        {
+            const int64 start = Time::getHighResolutionTicks();
+
+            for (int i = 0; i < callsPerRun; ++i)
+                function();
+
+            if (run >= 0)
+                runs.add (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) / callsPerRun);
+        }
+
+        return summarise (runs);
+    }
+
+    //==============================================================================
+    void loadSamples (DrumSynthesiser& synth, double sampleRate)
+    {
+        for (int i = 0; i < synth.getNumSounds(); ++i)
+            if (CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (synth.getSound (i).get()))
+                sound->setSampleData (SampleBuffer::createSynthetic (sampleRate, 4.0, i + 1));
+    }
+
+    /** Starts notes on every pad and channel in turn until numVoices are playing. */
+    void fillVoices (DrumSynthesiser& synth, int numVoices, int& nextNote)
+    {
+        auto countActive = [&synth]
+        {
+            int n = 0;
+
+            for (int v = 0; v < synth.getNumVoices(); ++v)
+                if (synth.getVoice (v)->isVoiceActive())
+                    ++n;
+
+            return n;
+        };
+
+        for (int n = countActive(); n < numVoices; ++n)
+        {
+            synth.noteOn (1 + (nextNote / synth.nb_samples) % 16, 36 + nextNote % synth.nb_samples, 0.8f);
+            nextNote = (nextNote + 1) % (16 * synth.nb_samples);
+        }
+    }
+
+    //==============================================================================
+    DynamicObject::Ptr makeResult (const String& group, const String& unit, Timing timing, double scale)
+    {
+        DynamicObject::Ptr result (new DynamicObject());
+        result->setProperty ("group", group);
+        result->setProperty ("params", var (new DynamicObject()));
+        result->setProperty ("unit", unit);
+        result->setProperty ("median", timing.median * scale);
+        result->setProperty ("best", timing.best * scale);
+        return result;
+    }
+
+    void setParam (DynamicObject::Ptr result, const Identifier& name, const var& value)
+    {
+        result->getProperty ("params").getDynamicObject()->setProperty (name, value);
+    }
+
+    var describeMachine()
+    {
+        DynamicObject::Ptr machine (new DynamicObject());
+        machine->setProperty ("os", SystemStats::getOperatingSystemName());
+        machine->setProperty ("cpu", SystemStats::getCpuModel());
+        machine->setProperty ("cpuVendor", SystemStats::getCpuVendor());
+        machine->setProperty ("cpuMHz", SystemStats::getCpuSpeedInMegahertz());
+        machine->setProperty ("numCpus", SystemStats::getNumCpus());
+
+       #if JUCE_ARM
+        String arch ("arm");
+       #elif JUCE_INTEL
+        String arch ("x86");
+       #else
+        String arch ("unknown");
+       #endif
+       #if JUCE_64BIT
+        machine->setProperty ("arch", arch + "64");
+       #else
+        machine->setProperty ("arch", arch + "32");
+       #endif
+
+       #if defined (__clang__)
+        machine->setProperty ("compiler", "clang " __clang_version__);
+       #elif defined (__GNUC__)
+        machine->setProperty ("compiler", "gcc " __VERSION__);
+       #elif defined (_MSC_VER)
+        machine->setProperty ("compiler", "msvc " + String (_MSC_VER));
+       #endif
+
+       #if JUCE_DEBUG
+        machine->setProperty ("build", "debug");
+       #else
+        machine->setProperty ("build", "release");
+       #endif
+
+        machine->setProperty ("juce", SystemStats::getJUCEVersion());
+        machine->setProperty ("version", ProjectInfo::versionString);
+        return var (machine.get());
+    }
+}
+
+//==============================================================================
+String Benchmarks::runSampler (const String& filter, double sampleRate)
+{
+    const ScopedNoDenormals noDenormals;
+    const int numRuns = 7;
+    Array<var> results;
+
+    auto wants = [&filter] (const String& group)    { return filter.isEmpty() || group.contains (filter); };
+    auto add = [&results] (DynamicObject::Ptr result)  { results.add (var (result.get())); };
+
+    BigInteger allNotes;
+    allNotes.setRange (0, 128, true);
+
+    //==============================================================================
+    // one voice alone, one second of output per run
+    if (wants ("voice_render"))
+    {
+        Synthesiser synth;
+        CustomSamplerVoice* voice = new CustomSamplerVoice();
+        synth.addVoice (voice);
+
+        CustomSamplerSound* sound = new CustomSamplerSound ("bench", allNotes, 60, 0.01, 0.02, 60.0);
+        sound->filter_active = 1;
+        sound->setSampleData (SampleBuffer::createSynthetic (sampleRate, 4.0, 1));
+        synth.addSound (sound);
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+
+        const int semitones[] = { -12, 0, 7, 12, 19 };
+        const int blockSizes[] = { 16, 64, 256, 1024 };
+
+        for (int semitone : semitones)
+        {
+            for (int blockSize : blockSizes)
+            {
+                AudioSampleBuffer output (2, blockSize);
+                output.clear();
+                const int numBlocks = (int) sampleRate / blockSize;
+
+                const Timing timing = measure (1, numRuns, [&]
+                {
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        if (! voice->isVoiceActive())
+                            synth.noteOn (1, 60 + semitone, 0.8f);
+
+                        voice->renderNextBlock (output, 0, blockSize);
+                    }
+                });
+
+                DynamicObject::Ptr result (makeResult ("voice_render", "ns/sample", timing, 1.0e9 / (numBlocks * blockSize)));
+                setParam (result, "pitchRatio", std::pow (2.0, semitone / 12.0));
+                setParam (result, "blockSize", blockSize);
+                add (result);
+            }
+        }
+    }
+
+    //==============================================================================
+    // the whole synth, as called by the engine, with 1 to all of its voices playing
+    if (wants ("synth_render"))
+    {
+        DrumSynthesiser synth;
+        synth.getFreezeCache().setEnabled (false);
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+        loadSamples (synth, sampleRate);
+
+        const int blockSizes[] = { 64, 256 };
+        const MidiBuffer noMidi;
+        int nextNote = 0;
+
+        for (int blockSize : blockSizes)
+        {
+            AudioSampleBuffer output (2, blockSize);
+            const int numBlocks = (int) sampleRate / blockSize;
+
+            for (int numVoices = 1; numVoices <= synth.getNumVoices(); ++numVoices)
+            {
+                synth.allNotesOff (0, false);
+
+                const Timing timing = measure (1, numRuns, [&]
+                {
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        fillVoices (synth, numVoices, nextNote);
+                        output.clear();
+                        synth.renderNextBlock (output, noMidi, 0, blockSize);
+                    }
+                });
+
+                DynamicObject::Ptr result (makeResult ("synth_render", "ns/block", timing, 1.0e9 / numBlocks));
+                setParam (result, "voices", numVoices);
+                setParam (result, "blockSize", blockSize);
+                result->setProperty ("dspLoadPercent", 100.0 * timing.median / numBlocks * sampleRate / blockSize);
+                add (result);
+            }
+        }
+    }
+
+    //==============================================================================
+    // Synthesiser::noteOn(): finding the sound and a voice, then startNote()
+    if (wants ("note_on"))
+    {
+        DrumSynthesiser synth;
+        synth.getFreezeCache().setEnabled (false);
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+        loadSamples (synth, sampleRate);
+
+        const int numVoices = synth.getNumVoices();
+        const int numRounds = 200;
+
+        for (int stealing = 0; stealing < 2; ++stealing)
+        {
+            Array<double> runs;
+            int nextNote = 0;
+
+            for (int run = -1; run < numRuns; ++run)
+            {
+                double total = 0.0;
+
+                for (int round = 0; round < numRounds; ++round)
+                {
+                    // with stealing, every voice is busy before each timed note-on
+                    if (stealing != 0)
+                        fillVoices (synth, numVoices, nextNote);
+
+                    for (int v = 0; v < numVoices; ++v)
+                    {
+                        const int channel = 1 + (nextNote / synth.nb_samples) % 16;
+                        const int note = 36 + nextNote % synth.nb_samples;
+                        nextNote = (nextNote + 1) % (16 * synth.nb_samples);
+
+                        const int64 start = Time::getHighResolutionTicks();
+                        synth.noteOn (channel, note, 0.8f);
+                        total += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+                    }
+
+                    if (stealing == 0)
+                        synth.allNotesOff (0, false);
+                }
+
+                if (run >= 0)
+                    runs.add (total / (numRounds * numVoices));
+            }
+
+            DynamicObject::Ptr result (makeResult ("note_on", "ns/call", summarise (runs), 1.0e9));
+            setParam (result, "voices", numVoices);
+            setParam (result, "stealing", stealing != 0);
+            add (result);
+
+            synth.allNotesOff (0, false);
+        }
+    }
+
+    //==============================================================================
+    // CustomSamplerVoice::startNote() alone, most of it is the filter setup
+    if (wants ("start_note"))
+    {
+        CustomSamplerVoice voice;
+        voice.setCurrentPlaybackSampleRate (sampleRate);
+
+        SynthesiserSound::Ptr soundHolder (new CustomSamplerSound ("bench", allNotes, 60, 0.01, 0.02, 60.0));
+        CustomSamplerSound* sound = static_cast<CustomSamplerSound*> (soundHolder.get());
+        sound->setSampleData (SampleBuffer::createSynthetic (sampleRate, 1.0, 1));
+
+        const char* const filterNames[] = { "off", "lowpass", "highpass", "bandpass" };
+
+        for (int filterType = 0; filterType < 4; ++filterType)
+        {
+            sound->filter_active = filterType > 0 ? 1 : 0;
+            sound->filter_type = jmax (1, filterType);
+            int note = 0;
+
+            const Timing startNote = measure (10000, numRuns, [&]
+            {
+                voice.startNote (48 + (note++ & 15), 0.8f, sound, 8192);
+            });
+
+            const Timing coefficients = measure (10000, numRuns, [&]
+            {
+                const IIRCoefficients c (CustomSamplerSound::makeFilterCoefficients (sound->filter_type, sound->filter_active != 0,
+                                                                                     (float) (200 + (note++ & 1023)), sampleRate));
+                ignoreUnused (c);
+            });
+
+            DynamicObject::Ptr result (makeResult ("start_note", "ns/call", startNote, 1.0e9));
+            setParam (result, "filter", filterNames[filterType]);
+            result->setProperty ("filterCoefficientsNs", coefficients.median * 1.0e9);
+            add (result);
+        }
+
+        voice.stopNote (0.0f, false);
+    }
+
+    //==============================================================================
+    // CustomSamplerSound::loadSound() on AIFF (and FLAC) files just written, so from the OS cache
+    if (wants ("load_sound"))
+    {
+        const File folder (File::getSpecialLocation (File::tempDirectory).getChildFile ("simple_sampler_benchmark"));
+        folder.createDirectory();
+
+        const double durations[] = { 1.0, 10.0 };
+        const int bitDepths[] = { 16, 24 };
+
+        AudioFormatManager formats;
+        formats.registerFormat (new AiffAudioFormat(), false);
+       #if JUCE_USE_FLAC
+        formats.registerFormat (new FlacAudioFormat(), false);
+       #endif
+
+        for (double seconds : durations)
+        {
+            const SampleBuffer::Ptr sample (SampleBuffer::createSynthetic (sampleRate, seconds, 1));
+
+            for (auto* format : formats)
+            {
+                for (int bits : bitDepths)
+                {
+                    const File file (folder.getChildFile (String (seconds, 0) + "s_" + String (bits) + "bit" + format->getFileExtensions()[0]));
+                    file.deleteFile();
+
+                    {
+                        std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+                        std::unique_ptr<AudioFormatWriter> writer (stream != nullptr ? format->createWriterFor (stream.get(), sampleRate, 2, bits, StringPairArray(), 0)
+                                                                                     : nullptr);
+
+                        if (writer == nullptr)
+                            continue;
+
+                        stream.release();
+                        writer->writeFromAudioSampleBuffer (sample->getBuffer(), 0, sample->getLength());
+                    }
+
+                    SynthesiserSound::Ptr soundHolder (new CustomSamplerSound ("bench", allNotes, 60, 0.01, 0.02, 60.0));
+                    CustomSamplerSound* sound = static_cast<CustomSamplerSound*> (soundHolder.get());
+                    sound->setAudioFile (file);
+
+                    const Timing timing = measure (1, 5, [sound] { sound->loadSound(); });
+
+                    DynamicObject::Ptr result (makeResult ("load_sound", "ms/file", timing, 1.0e3));
+                    setParam (result, "seconds", seconds);
+                    setParam (result, "bits", bits);
+                    setParam (result, "format", format->getFormatName());
+                    result->setProperty ("megabytesPerSecond", (double) file.getSize() / timing.median * 1.0e-6);
+                    result->setProperty ("realtimeFactor", seconds / timing.median);
+                    add (result);
+                }
+            }
+        }
+
+        folder.deleteRecursively();
+    }
+
+    //==============================================================================
+    // TransientSlicer::findSlices() on 4 bars of quarter notes at 120 bpm, which must stay well under a second on a Pi
+    if (wants ("slice"))
+    {
+        const double beatSeconds = 0.5;
+        const int beatLength = (int) (beatSeconds * sampleRate);
+        const SampleBuffer::Ptr loop (new SampleBuffer (2, 16 * beatLength, sampleRate));
+
+        for (int beat = 0; beat < 16; ++beat)
+        {
+            const SampleBuffer::Ptr hit (SampleBuffer::createSynthetic (sampleRate, 0.3, beat + 1));
+
+            for (int ch = 0; ch < 2; ++ch)
+                FloatVectorOperations::copy (loop->getBuffer().getWritePointer (ch, beat * beatLength),
+                                             hit->getBuffer().getReadPointer (ch), hit->getLength());
+        }
+
+        // one slice per beat, more than a kit has pads: findSlices() is not bound to them
+        TransientSlicer::Options options;
+        options.maxSlices = 16;
+        int numSlices = 0;
+
+        const Timing timing = measure (1, 5, [&] { numSlices = TransientSlicer::findSlices (*loop, options).size(); });
+
+        DynamicObject::Ptr result (makeResult ("slice", "ms/loop", timing, 1.0e3));
+        setParam (result, "seconds", 16 * beatSeconds);
+        result->setProperty ("numSlices", numSlices);
+        add (result);
+    }
+
+    //==============================================================================
+    // ConvolutionReverb::process() on 64 sample blocks, for a range of IR lengths and partition sizes
+    if (wants ("reverb"))
+    {
+        const double irLengths[] = { 0.25, 0.5, 1.0, 2.0, 4.0, 8.0 };
+        const int partitionSizes[] = { 128, 256, 512 };
+        const int blockSize = 64;
+        const double secondsToRender = 10.0;
+        const double secondsToRenderWithWorker = 2.0;
+        const double blockSeconds = blockSize / sampleRate;
+
+        Random random (1234);
+        AudioSampleBuffer input (2, blockSize);
+        AudioSampleBuffer block (2, blockSize);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+        for (double irSeconds : irLengths)
+        {
+            // exponentially decaying noise, stereo, like a real room
+            const int irLength = (int) (irSeconds * sampleRate);
+            AudioSampleBuffer ir (2, irLength);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < irLength; ++i)
+                    ir.setSample (ch, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-6.9f * (float) i / (float) irLength));
+
+            for (int partitionSize : partitionSizes)
+            {
+                for (int useWorker = 0; useWorker < 2; ++useWorker)
+                {
+                    ConvolutionReverb reverb;
+                    reverb.setPartitionSize (partitionSize);
+                    reverb.setSendLevel (0.5f);
+                    reverb.prepare (sampleRate, blockSize);
+                    reverb.setImpulseResponse (ir, sampleRate, false);
+                    reverb.setUseWorkerThread (useWorker != 0);
+
+                    // the worker only helps if there is idle time between blocks,
+                    // so those runs are paced like a real device
+                    const int numBlocks = (int) ((useWorker != 0 ? secondsToRenderWithWorker : secondsToRender) / blockSeconds);
+                    Array<double> blocks;
+                    blocks.ensureStorageAllocated (numBlocks);
+                    double total = 0.0;
+                    double deadline = Time::getMillisecondCounterHiRes();
+
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        block.makeCopyOf (input, true);
+
+                        const int64 start = Time::getHighResolutionTicks();
+                        reverb.process (block, 0, blockSize);
+                        const double elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+
+                        blocks.add (elapsed);
+                        total += elapsed;
+
+                        if (useWorker != 0)
+                        {
+                            deadline += blockSeconds * 1000.0;
+                            const int msToWait = (int) (deadline - Time::getMillisecondCounterHiRes());
+
+                            if (msToWait > 0)
+                                Thread::sleep (msToWait);
+                        }
+                    }
+
+                    const Timing timing = summarise (blocks);
+
+                    DynamicObject::Ptr result (makeResult ("reverb", "cpu_percent", timing, 100.0 / blockSeconds));
+                    setParam (result, "irSeconds", irSeconds);
+                    setParam (result, "partition", partitionSize);
+                    setParam (result, "blockSize", blockSize);
+                    setParam (result, "worker", useWorker != 0);
+                    result->setProperty ("meanPercent", 100.0 * total / (numBlocks * blockSeconds));
+                    result->setProperty ("worstBlockPercent", 100.0 * blocks.getLast() / blockSeconds);
+                    add (result);
+                }
+            }
+        }
+    }
+
+    DynamicObject::Ptr report (new DynamicObject());
+    report->setProperty ("benchmark", "sampler");
+    report->setProperty ("sampleRate", sampleRate);
+    report->setProperty ("machine", describeMachine());
+    report->setProperty ("results", results);
+
+    return JSON::toString (var (report.get())) + "\n";
+}
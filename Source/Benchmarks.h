@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created: 19 Oct 2026 11:40:27am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef BENCHMARKS_H_INCLUDED
+#define BENCHMARKS_H_INCLUDED
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ Offline CPU measurements of the audio engine, run with --bench.
+
+ Everything renders synthetic signals, so no audio device or sample file is
+ needed and the numbers are comparable between machines.
+ */
+struct Benchmarks
+{
+    /** Timings of the sampler hot paths: one voice at several pitch ratios and
+        block sizes, the whole synth with 1 to all of its voices, note-on
+        dispatch, note setup with each filter type, sample decoding, the
+        slicing of a loop, and the convolution reverb for a range of IR lengths
+        and partition sizes, as a percentage of one core in real time.
+
+        Returns JSON with a description of the machine and build, one entry per
+        case with its parameters, so runs can be diffed between commits and
+        CPUs. Only the groups whose name contains filter are run.
+     */
+    static String runSampler (const String& filter = String(), double sampleRate = 48000.0);
+};
+
+
+#endif  // BENCHMARKS_H_INCLUDED
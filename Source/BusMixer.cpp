@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    BusMixer.cpp
+    Created: 19 Oct 2026 3:05:41pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BusMixer.h"
+
+namespace
+{
+    void publishPeak (std::atomic<float>& meter, float value) noexcept
+    {
+        float current = meter.load();
+
+        while (value > current && ! meter.compare_exchange_weak (current, value))
+        {}
+    }
+}
+
+//==============================================================================
+BusMixer::BusSettings::BusSettings()
+:   output (mainMixOutput),
+    mono (false),
+    gainDb (0.0f),
+    reverbSend (1.0f)
+{
+}
+
+BusMixer::Routing::Routing()
+{
+    for (int pad = 0; pad < maxPads; ++pad)
+        padBus[pad] = pad % maxBuses;
+}
+
+//==============================================================================
+BusMixer::BusMixer()
+:   maxBlockSize (0),
+    lastProcessingTime (0.0),
+    maxProcessingTime (0.0)
+{
+    for (int bus = 0; bus < maxBuses; ++bus)
+    {
+        inserts[bus].setTimed (false);
+        busGain[bus] = 1.0f;
+        peaks[bus][0] = 0.0f;
+        peaks[bus][1] = 0.0f;
+    }
+}
+
+BusMixer::~BusMixer()
+{
+}
+
+void BusMixer::prepare (double sampleRate, int maximumBlockSize)
+{
+    maxBlockSize = jmax (1, maximumBlockSize);
+
+    for (int bus = 0; bus < maxBuses; ++bus)
+    {
+        buses[bus].setSize (2, maxBlockSize);
+        inserts[bus].prepare (sampleRate, maxBlockSize);
+    }
+
+    mainMix.setSize (2, maxBlockSize);
+    reverbSend.setSize (1, maxBlockSize);
+
+    pendingRouting.update();
+    applyRouting (currentRouting);
+    reset();
+}
+
+void BusMixer::reset() noexcept
+{
+    for (int bus = 0; bus < maxBuses; ++bus)
+    {
+        buses[bus].clear();
+        inserts[bus].reset();
+        busGain[bus] = Decibels::decibelsToGain (routing.buses[bus].gainDb);
+    }
+
+    mainMix.clear();
+    reverbSend.clear();
+}
+
+void BusMixer::setRouting (const Routing& newRouting)
+{
+    currentRouting = newRouting;
+    pendingRouting.write (newRouting);
+}
+
+void BusMixer::applyRouting (const Routing& r) noexcept
+{
+    routing = r;
+
+    for (int pad = 0; pad < maxPads; ++pad)
+        routing.padBus[pad] = jlimit (0, (int) maxBuses - 1, r.padBus[pad]);
+}
+
+float BusMixer::getAndResetPeak (int bus, int channel) noexcept
+{
+    if (! isPositiveAndBelow (bus, (int) maxBuses) || ! isPositiveAndBelow (channel, 2))
+        return 0.0f;
+
+    return peaks[bus][channel].exchange (0.0f);
+}
+
+//==============================================================================
+AudioSampleBuffer& BusMixer::beginBlock (int numSamples) noexcept
+{
+    if (pendingRouting.update())
+        applyRouting (pendingRouting.read());
+
+    jassert (numSamples <= maxBlockSize);
+
+    for (int bus = 0; bus < maxBuses; ++bus)
+        buses[bus].clear (0, numSamples);
+
+    mainMix.clear (0, numSamples);
+    reverbSend.clear (0, numSamples);
+
+    return mainMix;
+}
+
+AudioSampleBuffer* BusMixer::getBufferForPad (int pad) noexcept
+{
+    if (maxBlockSize == 0 || ! isPositiveAndBelow (pad, (int) maxPads))
+        return nullptr;
+
+    return &buses[routing.padBus[pad]];
+}
+
+void BusMixer::mixBuses (AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) noexcept
+{
+    const int64 startTicks = Time::getHighResolutionTicks();
+
+    for (int bus = 0; bus < maxBuses; ++bus)
+        routeBus (bus, deviceOutputs, startSample, numSamples);
+
+    const double elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+    lastProcessingTime = elapsed;
+
+    if (elapsed > maxProcessingTime.load())
+        maxProcessingTime = elapsed;
+}
+
+void BusMixer::routeBus (int bus, AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) noexcept
+{
+    AudioSampleBuffer& buffer = buses[bus];
+    const BusSettings& settings = routing.buses[bus];
+
+    inserts[bus].processBlock (buffer, 0, numSamples);
+
+    const float gain = Decibels::decibelsToGain (settings.gainDb);
+    buffer.applyGainRamp (0, numSamples, busGain[bus], gain);
+    busGain[bus] = gain;
+
+    for (int ch = 0; ch < 2; ++ch)
+        publishPeak (peaks[bus][ch], buffer.getMagnitude (ch, 0, numSamples));
+
+    if (settings.reverbSend > 0.0f)
+        for (int ch = 0; ch < 2; ++ch)
+            reverbSend.addFrom (0, 0, buffer, ch, 0, numSamples, 0.5f * settings.reverbSend);
+
+    const int numOutputs = deviceOutputs.getNumChannels();
+    const int output = settings.output;
+
+    // a route to a channel the current device does not have falls back to the main mix
+    if (output == mainMixOutput || ! isPositiveAndBelow (output, numOutputs))
+    {
+        mainMix.addFrom (0, 0, buffer, 0, 0, numSamples);
+        mainMix.addFrom (1, 0, buffer, 1, 0, numSamples);
+    }
+    else if (settings.mono || output + 1 >= numOutputs)
+    {
+        deviceOutputs.addFrom (output, startSample, buffer, 0, 0, numSamples, 0.5f);
+        deviceOutputs.addFrom (output, startSample, buffer, 1, 0, numSamples, 0.5f);
+    }
+    else
+    {
+        deviceOutputs.addFrom (output, startSample, buffer, 0, 0, numSamples);
+        deviceOutputs.addFrom (output + 1, startSample, buffer, 1, 0, numSamples);
+    }
+}
+
+void BusMixer::writeMainMix (AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) const noexcept
+{
+    const int numOutputs = deviceOutputs.getNumChannels();
+
+    if (numOutputs == 1)
+    {
+        deviceOutputs.addFrom (0, startSample, mainMix, 0, 0, numSamples, 0.5f);
+        deviceOutputs.addFrom (0, startSample, mainMix, 1, 0, numSamples, 0.5f);
+        return;
+    }
+
+    for (int ch = 0; ch < jmin (2, numOutputs); ++ch)
+        deviceOutputs.addFrom (ch, startSample, mainMix, ch, 0, numSamples);
+}
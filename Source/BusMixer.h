@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    BusMixer.h
+    Created: 19 Oct 2026 3:05:41pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef BUSMIXER_H_INCLUDED
+#define BUSMIXER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "FXChain.h"
+#include "TripleBuffer.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ Stereo buses the pads are rendered into, and their routing to the device.
+
+ Each pad is assigned to a bus (one bus per pad by default, several pads can
+ share one to make a group). The voices add their output straight into the
+ buffer of their bus, so there is no extra copy per voice. Each bus then goes
+ through its own insert chain and fader, is metered, feeds the reverb send and
+ ends up either in the main mix (which gets the master processing) or on its
+ own pair of device outputs.
+
+ The buffers are allocated once in prepare() and reused on every block. The
+ routing is changed from the message thread with setRouting(), and the audio
+ thread picks it up at the start of the next block.
+ */
+class BusMixer
+{
+public:
+    enum
+    {
+        maxBuses = 8,
+        maxPads = 32,
+        maxOutputChannels = 16,
+        mainMixOutput = -1
+    };
+
+    struct BusSettings
+    {
+        BusSettings();
+
+        int output;         // first device channel, or mainMixOutput
+        bool mono;          // sends (L + R) / 2 to a single output channel
+        float gainDb;
+        float reverbSend;
+    };
+
+    struct Routing
+    {
+        Routing();
+
+        BusSettings buses[maxBuses];
+        int padBus[maxPads];
+    };
+
+    BusMixer();
+    ~BusMixer();
+
+    /** Call while the audio device is stopped. */
+    void prepare (double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    int getMaximumBlockSize() const noexcept                { return maxBlockSize; }
+
+    //==============================================================================
+    /** Message thread only. */
+    void setRouting (const Routing& newRouting);
+    const Routing& getRouting() const noexcept              { return currentRouting; }
+
+    /** The insert chain of a bus. Its settings can be changed from the message thread. */
+    FXChain& getInsert (int bus) noexcept                   { return inserts[jlimit (0, (int) maxBuses - 1, bus)]; }
+
+    /** Peak level of one channel of a bus since the last call. For the GUI. */
+    float getAndResetPeak (int bus, int channel) noexcept;
+
+    //==============================================================================
+    /** Audio thread: applies pending routing changes, clears the buses and the
+        main mix, and returns the main mix. numSamples must not exceed the size
+        given to prepare().
+     */
+    AudioSampleBuffer& beginBlock (int numSamples) noexcept;
+
+    /** Audio thread: the buffer a voice playing the given pad should render into. */
+    AudioSampleBuffer* getBufferForPad (int pad) noexcept;
+
+    /** Audio thread: runs the inserts and faders, fills the reverb send, sums the
+        buses into the main mix and adds the directly routed ones to the device outputs.
+     */
+    void mixBuses (AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) noexcept;
+
+    /** Time mixBuses() took, all buses and inserts together: the inserts are not
+        timed one by one, which would read the clock 16 times a block.
+     */
+    double getLastProcessingTimeMicros() const noexcept     { return lastProcessingTime.load(); }
+    double getMaxProcessingTimeMicros() const noexcept      { return maxProcessingTime.load(); }
+    void resetProcessingTime() noexcept                     { maxProcessingTime = 0.0; }
+
+    /** Audio thread: adds the processed main mix to the first two device outputs. */
+    void writeMainMix (AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) const noexcept;
+
+    const AudioSampleBuffer& getMainMix() const noexcept    { return mainMix; }
+    const float* getReverbSend() const noexcept             { return reverbSend.getReadPointer (0); }
+
+private:
+    void applyRouting (const Routing&) noexcept;
+    void routeBus (int bus, AudioSampleBuffer& deviceOutputs, int startSample, int numSamples) noexcept;
+
+    int maxBlockSize;
+
+    AudioSampleBuffer buses[maxBuses];
+    AudioSampleBuffer mainMix, reverbSend;
+    FXChain inserts[maxBuses];
+
+    Routing routing;
+    float busGain[maxBuses];
+
+    Routing currentRouting;
+    TripleBuffer<Routing> pendingRouting;
+
+    std::atomic<float> peaks[maxBuses][2];
+    std::atomic<double> lastProcessingTime, maxProcessingTime;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BusMixer)
+};
+
+
+#endif  // BUSMIXER_H_INCLUDED
@@ -0,0 +1,712 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 19 Oct 2026 10:14:52am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ConvolutionReverb.h"
+#include "Trace.h"
+
+#if JUCE_LINUX
+ #include <semaphore.h>
+ #include <cerrno>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
+
+namespace
+{
+    // jobAbandoned: still running, but the audio thread has gone on without it
+    enum { jobIdle = 0, jobPending, jobRunning, jobDone, jobAbandoned };
+
+    const double maxImpulseResponseSeconds = 10.0;
+    const double levelRampSeconds = 0.02;
+
+    void multiplyAccumulate (float* accRe, float* accIm,
+                             const float* xRe, const float* xIm,
+                             const float* hRe, const float* hIm, int numBins) noexcept
+    {
+        for (int i = 0; i < numBins; ++i)
+        {
+            accRe[i] += xRe[i] * hRe[i] - xIm[i] * hIm[i];
+            accIm[i] += xRe[i] * hIm[i] + xIm[i] * hRe[i];
+        }
+    }
+}
+
+//==============================================================================
+/*  Everything the audio thread needs for one impulse response. Built and freed
+    away from the audio thread; the audio thread only ever swaps the pointer.
+
+    The IR is split into a direct-form head (taps 0..P-1) and K FFT partitions
+    (taps P + kP .. P + (k+1)P - 1), transformed with a 2P point FFT.
+ */
+struct ConvolutionReverb::State
+{
+    State (int partitionSize, int numFFTPartitions, int numIRChannels)
+    :   P (partitionSize),
+        K (numFFTPartitions),
+        numBins (partitionSize + 1),
+        numChannels (numIRChannels),
+        fft (roundToInt (std::log2 (2.0 * partitionSize))),
+        head (numIRChannels, partitionSize),
+        tailOut (numIRChannels, partitionSize),
+        wet (numIRChannels, partitionSize),
+        newest (0),
+        position (0)
+    {
+        const size_t spectrumSize = (size_t) (jmax (1, K) * numBins);
+
+        tailRe.calloc (spectrumSize * (size_t) numChannels);
+        tailIm.calloc (spectrumSize * (size_t) numChannels);
+        fdlRe.calloc (spectrumSize);
+        fdlIm.calloc (spectrumSize);
+        olderRe.calloc ((size_t) (numBins * numChannels));
+        olderIm.calloc ((size_t) (numBins * numChannels));
+        localRe.calloc ((size_t) (numBins * numChannels));
+        localIm.calloc ((size_t) (numBins * numChannels));
+        segment.calloc ((size_t) (2 * P));
+        fftBuffer.calloc ((size_t) (4 * P));
+
+        head.clear();
+        tailOut.clear();
+        wet.clear();
+    }
+
+    float* tailSpectrumRe (int channel, int k) const noexcept    { return tailRe + (channel * jmax (1, K) + k) * numBins; }
+    float* tailSpectrumIm (int channel, int k) const noexcept    { return tailIm + (channel * jmax (1, K) + k) * numBins; }
+    float* fdlSpectrumRe (int k) const noexcept                  { return fdlRe + k * numBins; }
+    float* fdlSpectrumIm (int k) const noexcept                  { return fdlIm + k * numBins; }
+
+    void reset() noexcept
+    {
+        zeromem (fdlRe, sizeof (float) * (size_t) (jmax (1, K) * numBins));
+        zeromem (fdlIm, sizeof (float) * (size_t) (jmax (1, K) * numBins));
+        zeromem (segment, sizeof (float) * (size_t) (2 * P));
+        tailOut.clear();
+        newest = 0;
+        position = 0;
+    }
+
+    const int P, K, numBins, numChannels;
+    dsp::FFT fft;
+
+    AudioSampleBuffer head, tailOut, wet;
+    HeapBlock<float> tailRe, tailIm;    // [channel][partition][bin]
+    HeapBlock<float> fdlRe, fdlIm;      // [partition][bin], input spectra
+    HeapBlock<float> olderRe, olderIm;  // [channel][bin], partitions 1..K-1 for the next boundary, by the worker
+    HeapBlock<float> localRe, localIm;  // the same, by the audio thread when the worker has not finished
+    HeapBlock<float> segment, fftBuffer;
+
+    int newest, position;
+
+    JUCE_DECLARE_NON_COPYABLE (State)
+};
+
+//==============================================================================
+class ConvolutionReverb::Worker  : public Thread
+{
+public:
+    Worker (ConvolutionReverb& o)
+    :   Thread ("Reverb FFT worker"),
+        owner (o)
+    {
+       #if JUCE_LINUX
+        sem_init (&semaphore, 0, 0);
+       #elif JUCE_MAC || JUCE_IOS
+        semaphore = dispatch_semaphore_create (0);
+       #elif JUCE_WINDOWS
+        semaphore = CreateSemaphore (nullptr, 0, 0x7fffffff, nullptr);
+       #endif
+    }
+
+    ~Worker()
+    {
+        stop();
+
+       #if JUCE_LINUX
+        sem_destroy (&semaphore);
+       #elif JUCE_MAC || JUCE_IOS
+        dispatch_release (semaphore);
+       #elif JUCE_WINDOWS
+        CloseHandle (semaphore);
+       #endif
+    }
+
+    /** Called by the audio thread once a job is pending. Thread::notify() would
+        lock the mutex of a WaitableEvent; posting a semaphore takes no lock and
+        never blocks.
+     */
+    void wakeUp() noexcept
+    {
+       #if JUCE_LINUX
+        sem_post (&semaphore);
+       #elif JUCE_MAC || JUCE_IOS
+        dispatch_semaphore_signal (semaphore);
+       #elif JUCE_WINDOWS
+        ReleaseSemaphore (semaphore, 1, nullptr);
+       #endif
+    }
+
+    void stop()
+    {
+        signalThreadShouldExit();
+        wakeUp();
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+        TRACE_THREAD_NAME ("reverb worker");
+
+        while (! threadShouldExit())
+        {
+            int expected = jobPending;
+
+            if (owner.jobState.compare_exchange_strong (expected, jobRunning))
+            {
+                // the audio thread never swaps the state while a job is in flight
+                TRACE_SCOPE ("reverb partitions");
+                State& s = *owner.currentState;
+                owner.accumulateOlderPartitions (s, s.olderRe, s.olderIm);
+
+                // too late if the boundary has gone by meanwhile: nobody waits for this result
+                expected = jobRunning;
+
+                if (! owner.jobState.compare_exchange_strong (expected, jobDone))
+                    owner.jobState = jobIdle;
+            }
+            else
+            {
+                waitForJob();
+            }
+        }
+    }
+
+private:
+    /** Sleeps until wakeUp(). A post made while a job ran leaves a count behind,
+        which only makes the loop look at jobState once more.
+     */
+    void waitForJob()
+    {
+       #if JUCE_LINUX
+        while (sem_wait (&semaphore) != 0 && errno == EINTR) {}
+       #elif JUCE_MAC || JUCE_IOS
+        dispatch_semaphore_wait (semaphore, DISPATCH_TIME_FOREVER);
+       #elif JUCE_WINDOWS
+        WaitForSingleObject (semaphore, INFINITE);
+       #else
+        wait (1);
+       #endif
+    }
+
+    ConvolutionReverb& owner;
+
+   #if JUCE_LINUX
+    sem_t semaphore;
+   #elif JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_WINDOWS
+    HANDLE semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb()
+:   sampleRate (44100.0),
+    maxBlockSize (512),
+    partitionSize (256),
+    sourceSampleRate (44100.0),
+    currentState (nullptr),
+    pendingState (nullptr),
+    retiredState (nullptr),
+    irLengthSeconds (0.0),
+    jobState (jobIdle),
+    sendLevel (0.0f),
+    returnLevel (1.0f),
+    loaderPool (1)
+{
+    sendBuffer.setSize (1, maxBlockSize);
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    loaderPool.removeAllJobs (true, 5000);
+    setUseWorkerThread (false);
+
+    collectGarbage();
+    delete pendingState.exchange (nullptr);
+    delete currentState;
+}
+
+void ConvolutionReverb::setPartitionSize (int newPartitionSize)
+{
+    jassert (isPowerOfTwo (newPartitionSize));
+    partitionSize = jlimit (32, 8192, nextPowerOfTwo (newPartitionSize));
+}
+
+void ConvolutionReverb::prepare (double newSampleRate, int maximumBlockSize)
+{
+    bool needsRebuild;
+
+    {
+        const ScopedLock sl (sourceLock);
+        needsRebuild = (newSampleRate != sampleRate) && sourceIR.getNumSamples() > 0;
+        sampleRate = newSampleRate;
+        maxBlockSize = jmax (1, maximumBlockSize);
+    }
+
+    sendBuffer.setSize (1, maxBlockSize);
+
+    sendGain.reset (newSampleRate, levelRampSeconds);
+    returnGain.reset (newSampleRate, levelRampSeconds);
+    sendGain.setCurrentAndTargetValue (sendLevel.load());
+    returnGain.setCurrentAndTargetValue (returnLevel.load());
+
+    // the device is stopped, so the audio side can be touched from here
+    while (jobState.load() == jobRunning || jobState.load() == jobAbandoned)
+        Thread::sleep (1);
+
+    jobState = jobIdle;
+    swapPendingState();
+    collectGarbage();
+    reset();
+
+    if (needsRebuild)
+        loaderPool.addJob ([this]
+        {
+            TRACE_THREAD_NAME ("reverb loader");
+            TRACE_SCOPE ("reverb rebuild");
+            rebuild (true);
+        });
+}
+
+void ConvolutionReverb::reset() noexcept
+{
+    if (currentState != nullptr)
+        currentState->reset();
+}
+
+void ConvolutionReverb::loadImpulseResponse (const File& file)
+{
+    loaderPool.addJob ([this, file]
+    {
+        TRACE_THREAD_NAME ("reverb loader");
+        TRACE_SCOPE ("load impulse response");
+
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+        if (reader == nullptr || reader->sampleRate <= 0)
+        {
+            Logger::outputDebugString ("Cannot read impulse response " + file.getFullPathName());
+            return;
+        }
+
+        const int length = (int) jmin (reader->lengthInSamples, (int64) (maxImpulseResponseSeconds * reader->sampleRate));
+        AudioSampleBuffer ir (jmin (2, (int) reader->numChannels), length);
+        reader->read (&ir, 0, length, 0, true, true);
+
+        {
+            const ScopedLock sl (sourceLock);
+            sourceIR.makeCopyOf (ir);
+            sourceSampleRate = reader->sampleRate;
+        }
+
+        rebuild (true);
+    });
+}
+
+void ConvolutionReverb::setImpulseResponse (const AudioSampleBuffer& ir, double irSampleRate, bool loadInBackground)
+{
+    {
+        const ScopedLock sl (sourceLock);
+        sourceIR.makeCopyOf (ir);
+        sourceSampleRate = irSampleRate;
+    }
+
+    if (loadInBackground)
+        loaderPool.addJob ([this]
+        {
+            TRACE_THREAD_NAME ("reverb loader");
+            TRACE_SCOPE ("reverb rebuild");
+            rebuild (true);
+        });
+    else
+        rebuild (false);
+}
+
+void ConvolutionReverb::setUseWorkerThread (bool shouldUseWorker)
+{
+    if (shouldUseWorker == (worker != nullptr))
+        return;
+
+    if (shouldUseWorker)
+    {
+        worker.reset (new Worker (*this));
+        worker->startThread (8);
+    }
+    else
+    {
+        // a job still pending is picked up by the audio thread at the next boundary
+        worker->stop();
+        worker = nullptr;
+    }
+}
+
+//==============================================================================
+void ConvolutionReverb::rebuild (bool waitForAudioThread)
+{
+    AudioSampleBuffer ir;
+    double targetRate;
+
+    {
+        const ScopedLock sl (sourceLock);
+
+        if (sourceIR.getNumSamples() == 0)
+            return;
+
+        targetRate = sampleRate;
+        const double ratio = sourceSampleRate / targetRate;
+        const int length = jmax (1, (int) (sourceIR.getNumSamples() / ratio));
+
+        ir.setSize (sourceIR.getNumChannels(), length);
+
+        if (ratio == 1.0)
+        {
+            ir.makeCopyOf (sourceIR);
+        }
+        else
+        {
+            // pad the source so the interpolator can read past the last sample
+            AudioSampleBuffer padded (sourceIR.getNumChannels(), sourceIR.getNumSamples() + 8);
+            padded.clear();
+
+            for (int ch = 0; ch < sourceIR.getNumChannels(); ++ch)
+            {
+                padded.copyFrom (ch, 0, sourceIR, ch, 0, sourceIR.getNumSamples());
+
+                LagrangeInterpolator interpolator;
+                interpolator.process (ratio, padded.getReadPointer (ch), ir.getWritePointer (ch), length);
+            }
+        }
+    }
+
+    // unit energy on the loudest channel, the return level does the rest
+    float maxEnergy = 0.0f;
+
+    for (int ch = 0; ch < ir.getNumChannels(); ++ch)
+    {
+        const float rms = ir.getRMSLevel (ch, 0, ir.getNumSamples());
+        maxEnergy = jmax (maxEnergy, rms * rms * (float) ir.getNumSamples());
+    }
+
+    if (maxEnergy > 0.0f)
+        ir.applyGain (1.0f / std::sqrt (maxEnergy));
+
+    const int P = partitionSize;
+    const int length = ir.getNumSamples();
+    const int K = length > P ? (length - P + P - 1) / P : 0;
+
+    std::unique_ptr<State> s (new State (P, K, ir.getNumChannels()));
+
+    for (int ch = 0; ch < s->numChannels; ++ch)
+    {
+        s->head.copyFrom (ch, 0, ir, ch, 0, jmin (P, length));
+
+        for (int k = 0; k < K; ++k)
+        {
+            const int offset = P + k * P;
+            const int num = jmin (P, length - offset);
+
+            zeromem (s->fftBuffer, sizeof (float) * (size_t) (4 * P));
+            FloatVectorOperations::copy (s->fftBuffer, ir.getReadPointer (ch, offset), num);
+            s->fft.performRealOnlyForwardTransform (s->fftBuffer, true);
+
+            float* re = s->tailSpectrumRe (ch, k);
+            float* im = s->tailSpectrumIm (ch, k);
+
+            for (int bin = 0; bin < s->numBins; ++bin)
+            {
+                re[bin] = s->fftBuffer[2 * bin];
+                im[bin] = s->fftBuffer[2 * bin + 1];
+            }
+        }
+    }
+
+    irLengthSeconds = length / targetRate;
+    publish (s.release(), waitForAudioThread);
+}
+
+void ConvolutionReverb::publish (State* newState, bool waitForAudioThread)
+{
+    collectGarbage();
+    delete pendingState.exchange (newState);
+
+    // give the audio thread a moment to take it, so the old one can be freed here
+    if (waitForAudioThread)
+    {
+        for (int i = 0; i < 200 && pendingState.load() == newState; ++i)
+            Thread::sleep (5);
+
+        collectGarbage();
+    }
+}
+
+void ConvolutionReverb::collectGarbage()
+{
+    delete retiredState.exchange (nullptr);
+}
+
+void ConvolutionReverb::swapPendingState() noexcept
+{
+    if (pendingState.load() == nullptr || retiredState.load() != nullptr)
+        return;
+
+    // never pull the state away from under the worker
+    int expected = jobPending;
+
+    if (! jobState.compare_exchange_strong (expected, jobIdle))
+    {
+        // picked up at a later block, once the worker has let go of it
+        if (expected == jobRunning || expected == jobAbandoned)
+            return;
+
+        jobState = jobIdle;
+    }
+
+    if (State* next = pendingState.exchange (nullptr))
+    {
+        retiredState = currentState;
+        currentState = next;
+    }
+}
+
+//==============================================================================
+void ConvolutionReverb::process (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    const int numOutputs = jmin (2, buffer.getNumChannels());
+
+    if (numOutputs == 0)
+        return;
+
+    const float send = numOutputs > 1 ? 0.5f : 1.0f;
+
+    while (numSamples > 0)
+    {
+        const int numThisTime = jmin (numSamples, sendBuffer.getNumSamples());
+        float* sendData = sendBuffer.getWritePointer (0);
+
+        if (numThisTime <= 0)
+            return;
+
+        FloatVectorOperations::copyWithMultiply (sendData, buffer.getReadPointer (0, startSample), send, numThisTime);
+
+        if (numOutputs > 1)
+            FloatVectorOperations::addWithMultiply (sendData, buffer.getReadPointer (1, startSample), send, numThisTime);
+
+        processSend (sendData, buffer, startSample, numThisTime);
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void ConvolutionReverb::process (const float* sendInput, AudioSampleBuffer& output, int startSample, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int numThisTime = jmin (numSamples, sendBuffer.getNumSamples());
+
+        if (numThisTime <= 0)
+            return;
+
+        FloatVectorOperations::copy (sendBuffer.getWritePointer (0), sendInput, numThisTime);
+        processSend (sendBuffer.getWritePointer (0), output, startSample, numThisTime);
+
+        sendInput += numThisTime;
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void ConvolutionReverb::processSend (float* sendData, AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    swapPendingState();
+
+    State* s = currentState;
+    const int numOutputs = jmin (2, buffer.getNumChannels());
+
+    if (s == nullptr || numOutputs == 0)
+        return;
+
+    sendGain.setTargetValue (sendLevel.load());
+    returnGain.setTargetValue (returnLevel.load());
+
+    if (sendGain.isSmoothing())
+    {
+        for (int i = 0; i < numSamples; ++i)
+            sendData[i] *= sendGain.getNextValue();
+    }
+    else
+    {
+        FloatVectorOperations::multiply (sendData, sendGain.getTargetValue(), numSamples);
+    }
+
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        const int num = jmin (numSamples - done, s->P - s->position);
+        processPartition (sendData + done, num, numOutputs);
+
+        const float startGain = returnGain.getCurrentValue();
+        const float endGain = returnGain.isSmoothing() ? returnGain.skip (num) : startGain;
+
+        for (int ch = 0; ch < numOutputs; ++ch)
+            buffer.addFromWithRamp (ch, startSample + done, s->wet.getReadPointer (jmin (ch, s->numChannels - 1)),
+                                    num, startGain, endGain);
+
+        done += num;
+
+        if (s->position == s->P)
+            finishPartition();
+    }
+}
+
+void ConvolutionReverb::processPartition (const float* send, int numSamples, int /*numOutputs*/) noexcept
+{
+    State& s = *currentState;
+    float* seg = s.segment + s.P + s.position;
+
+    FloatVectorOperations::copy (seg, send, numSamples);
+
+    for (int ch = 0; ch < s.numChannels; ++ch)
+    {
+        float* wet = s.wet.getWritePointer (ch);
+        const float* h = s.head.getReadPointer (ch);
+
+        FloatVectorOperations::copy (wet, s.tailOut.getReadPointer (ch, s.position), numSamples);
+
+        // direct-form head: wet[n] += sum h[j] x[n - j], one vector op per tap
+        for (int j = 0; j < s.P; ++j)
+            FloatVectorOperations::addWithMultiply (wet, seg - j, h[j], numSamples);
+    }
+
+    s.position += numSamples;
+}
+
+void ConvolutionReverb::finishPartition() noexcept
+{
+    State& s = *currentState;
+    const int P = s.P;
+
+    // 1. partitions 1..K-1 for this boundary: done by the worker if it has
+    // finished, else here, without waiting for a job it has started
+    int expected = jobPending;
+    jobState.compare_exchange_strong (expected, jobIdle);
+
+    if (expected == jobRunning)
+        jobState.compare_exchange_strong (expected, jobAbandoned);
+
+    const bool workerFinished = (expected == jobDone);
+
+    if (workerFinished)
+        jobState = jobIdle;
+    else
+        accumulateOlderPartitions (s, s.localRe, s.localIm);
+
+    float* const olderRe = workerFinished ? s.olderRe.get() : s.localRe.get();
+    float* const olderIm = workerFinished ? s.olderIm.get() : s.localIm.get();
+
+    // 2. spectrum of the last 2P input samples goes to the front of the delay line
+    if (s.K > 0)
+    {
+        FloatVectorOperations::copy (s.fftBuffer, s.segment, 2 * P);
+        FloatVectorOperations::clear (s.fftBuffer + 2 * P, 2 * P);
+        s.fft.performRealOnlyForwardTransform (s.fftBuffer, true);
+
+        s.newest = (s.newest + 1) % s.K;
+        float* xRe = s.fdlSpectrumRe (s.newest);
+        float* xIm = s.fdlSpectrumIm (s.newest);
+
+        for (int bin = 0; bin < s.numBins; ++bin)
+        {
+            xRe[bin] = s.fftBuffer[2 * bin];
+            xIm[bin] = s.fftBuffer[2 * bin + 1];
+        }
+
+        // 3. add partition 0 and go back to the time domain (overlap-save: keep the last P)
+        for (int ch = 0; ch < s.numChannels; ++ch)
+        {
+            float* accRe = olderRe + ch * s.numBins;
+            float* accIm = olderIm + ch * s.numBins;
+
+            multiplyAccumulate (accRe, accIm, xRe, xIm, s.tailSpectrumRe (ch, 0), s.tailSpectrumIm (ch, 0), s.numBins);
+
+            float* d = s.fftBuffer;
+
+            for (int bin = 0; bin < s.numBins; ++bin)
+            {
+                d[2 * bin] = accRe[bin];
+                d[2 * bin + 1] = accIm[bin];
+            }
+
+            for (int bin = s.numBins; bin < 2 * P; ++bin)
+            {
+                d[2 * bin] = accRe[2 * P - bin];
+                d[2 * bin + 1] = -accIm[2 * P - bin];
+            }
+
+            s.fft.performRealOnlyInverseTransform (d);
+            FloatVectorOperations::copy (s.tailOut.getWritePointer (ch), d + P, P);
+        }
+    }
+
+    FloatVectorOperations::copy (s.segment, s.segment + P, P);
+    s.position = 0;
+
+    // 4. let the worker prepare the next boundary while the next partition plays,
+    // unless it is still busy with an abandoned job
+    if (worker != nullptr && s.K > 1)
+    {
+        expected = jobIdle;
+
+        if (jobState.compare_exchange_strong (expected, jobPending))
+            worker->wakeUp();
+    }
+}
+
+void ConvolutionReverb::accumulateOlderPartitions (State& s, float* accRe, float* accIm) const noexcept
+{
+    FloatVectorOperations::clear (accRe, s.numBins * s.numChannels);
+    FloatVectorOperations::clear (accIm, s.numBins * s.numChannels);
+
+    // for the next boundary, partition k meets the input spectrum that is k - 1 blocks old now;
+    // the slot the audio thread writes next is the one partition K would read, so never read here
+    const int newest = s.newest;
+
+    for (int k = 1; k < s.K; ++k)
+    {
+        const int slot = (newest - (k - 1) + s.K) % s.K;
+
+        for (int ch = 0; ch < s.numChannels; ++ch)
+            multiplyAccumulate (accRe + ch * s.numBins, accIm + ch * s.numBins,
+                                s.fdlSpectrumRe (slot), s.fdlSpectrumIm (slot),
+                                s.tailSpectrumRe (ch, k), s.tailSpectrumIm (ch, k), s.numBins);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 19 Oct 2026 10:14:52am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef CONVOLUTIONREVERB_H_INCLUDED
+#define CONVOLUTIONREVERB_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ Reverb send bus built on a uniformly partitioned convolution.
+
+ The first partition of the impulse response is applied in direct form, the
+ rest of it with overlap-save FFT partitions (frequency-domain delay line).
+ Because the FFT part only ever needs input that is at least one partition
+ old, the whole thing adds no latency.
+
+ Impulse responses are resampled, normalised and transformed on a background
+ thread, then handed to the audio thread with an atomic pointer swap. The
+ spectral multiply-accumulate of the older partitions can optionally be done
+ ahead of time by a worker thread, which leaves a single FFT/IFFT pair per
+ partition on the audio thread.
+ */
+class ConvolutionReverb
+{
+public:
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    /** Partition size used for the IRs loaded afterwards (power of two). */
+    void setPartitionSize (int newPartitionSize);
+    int getPartitionSize() const noexcept                       { return partitionSize; }
+
+    /** Call while the audio device is stopped. */
+    void prepare (double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    /** Loads and pre-transforms an IR file on the loader thread. */
+    void loadImpulseResponse (const File& file);
+
+    /** Same as loadImpulseResponse() for an IR that is already in memory.
+        With loadInBackground = false the IR is transformed on the calling thread
+        (used by the benchmark and offline tools).
+     */
+    void setImpulseResponse (const AudioSampleBuffer& ir, double irSampleRate, bool loadInBackground = true);
+
+    bool hasImpulseResponse() const noexcept                    { return currentState != nullptr || pendingState.load() != nullptr; }
+    double getImpulseResponseLengthSeconds() const noexcept     { return irLengthSeconds.load(); }
+
+    /** Moves the spectral accumulation of the older partitions to a worker thread,
+        woken up by the audio thread at each partition boundary. Not from the audio thread.
+     */
+    void setUseWorkerThread (bool shouldUseWorker);
+    bool isUsingWorkerThread() const noexcept                   { return worker != nullptr; }
+
+    /** Both levels are ramped over 20 ms on the audio thread. */
+    void setSendLevel (float newLevel) noexcept                 { sendLevel = newLevel; }
+    void setReturnLevel (float newLevel) noexcept               { returnLevel = newLevel; }
+    float getSendLevel() const noexcept                         { return sendLevel.load(); }
+    float getReturnLevel() const noexcept                       { return returnLevel.load(); }
+
+    /** Feeds the first two channels of the buffer to the send and adds the
+        reverb return back onto them.
+     */
+    void process (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept;
+
+    /** Feeds a mono send bus (numSamples values, from sendInput[0]) to the reverb
+        and adds the return onto the first two channels of the output.
+     */
+    void process (const float* sendInput, AudioSampleBuffer& output, int startSample, int numSamples) noexcept;
+
+private:
+    struct State;
+    class Worker;
+
+    void rebuild (bool waitForAudioThread);
+    void publish (State*, bool waitForAudioThread);
+    void collectGarbage();
+    void swapPendingState() noexcept;
+    void processSend (float* sendData, AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    void processPartition (const float* send, int numSamples, int numOutputs) noexcept;
+    void finishPartition() noexcept;
+    void accumulateOlderPartitions (State&, float* accRe, float* accIm) const noexcept;
+
+    double sampleRate;
+    int maxBlockSize, partitionSize;
+
+    CriticalSection sourceLock;
+    AudioSampleBuffer sourceIR;
+    double sourceSampleRate;
+
+    State* currentState;
+    std::atomic<State*> pendingState, retiredState;
+    std::atomic<double> irLengthSeconds;
+
+    std::atomic<int> jobState;
+    std::unique_ptr<Worker> worker;
+
+    AudioSampleBuffer sendBuffer, wetBuffer;
+    std::atomic<float> sendLevel, returnLevel;
+    LinearSmoothedValue<float> sendGain, returnGain;    // audio thread
+
+    ThreadPool loaderPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionReverb)
+};
+
+
+#endif  // CONVOLUTIONREVERB_H_INCLUDED
@@ -1,293 +1,489 @@
-#include "CustomSampler.h"
-
-CustomSamplerSound::CustomSamplerSound (const String& soundName,
-                            const BigInteger& notes,
-                            const int midiNoteForNormalPitch,
-                            const double attackTimeSecs,
-                            const double releaseTimeSecs,
-                            const double maxSampleLengthSeconds)
-: detune(0),
-thumbnailCache (5),                            // [4]
-thumbnail (512, formatManager, thumbnailCache), // [5]
-midiRootNote (midiNoteForNormalPitch),
-name (soundName),
-midiNotes (notes),
-attackTimeSecs (attackTimeSecs),
-releaseTimeSecs(releaseTimeSecs),
-maxSampleLengthSeconds (maxSampleLengthSeconds)
-{
-    filter_active=0;
-    filter_type=1;
-    filter_cutoff=1000.0;
-    sample_start=0.;
-    sample_end=1.;
-    sourceSampleRate=44100;
-    sample_length=1;
-    formatManager.registerBasicFormats();
-    data = new AudioSampleBuffer (2, sample_length);
-    thumbnail.reset (2, sourceSampleRate,sample_length) ;
-    thumbnail.setSource(nullptr);
-}
-
-
-CustomSamplerSound::~CustomSamplerSound()
-{
-}
-
-void CustomSamplerSound::loadSound()
-{
-    AiffAudioFormat AIFF_file;
-    
-    
-    if (!audioFile.existsAsFile())
-    {
-        Logger::outputDebugString(String("does not exist")+audioFile.getFileName());
-    }
-    
-    AudioFormatReader* source = AIFF_file.createReaderFor(audioFile.createInputStream().get(),false);
- 
-    sourceSampleRate = source->sampleRate;
-    sample_length=source->lengthInSamples;
-    
-    if (sourceSampleRate <= 0 || sample_length <= 0)
-    {
-        length = 0;
-        attackSamples = 0;
-        releaseSamples = 0;
-    }
-    else
-    {
-        length = jmin ((int) source->lengthInSamples,(int) (maxSampleLengthSeconds * sourceSampleRate));
-        data = new AudioSampleBuffer (jmin (2, (int) source->numChannels), length + 4);
-        source->read (data, 0, length + 4, 0, true, true);
-        attackSamples = roundToInt (attackTimeSecs * sourceSampleRate);
-        releaseSamples = roundToInt (releaseTimeSecs * sourceSampleRate);
-    }
-    triggerAsyncUpdate();
-    
-}
-
-void CustomSamplerSound::handleAsyncUpdate()
-{
-    String filename=String::formatted("Async sample" +audioFile.getFullPathName());
-    Logger::outputDebugString(filename);
-    thumbnail.clear();
-    thumbnail.setSource(new FileInputSource (audioFile));
-}
-
-
-bool CustomSamplerSound::appliesToNote (int midiNoteNumber)
-{
-    return midiNotes[midiNoteNumber];
-}
-
-bool CustomSamplerSound::appliesToChannel (int /*midiChannel*/)
-{
-    return true;
-}
-
-
-
-//==============================================================================
-CustomSamplerVoice::CustomSamplerVoice()
-:sourceSamplePosition (0.0),
-pitchRatio (0.0),
-lgain (0.0f), rgain (0.0f),
-attackReleaseLevel (0), attackDelta (0), releaseDelta (0),
-isInAttack (false), isInRelease (false)
-{
-
-    
-}
-
-CustomSamplerVoice::~CustomSamplerVoice()
-{
-}
-
-bool CustomSamplerVoice::canPlaySound (SynthesiserSound* sound)
-{
-    return dynamic_cast<const CustomSamplerSound*> (sound) != nullptr;
-}
-
-void CustomSamplerVoice::startNote (const int midiNoteNumber,
-                              const float velocity,
-                              SynthesiserSound* s,
-                              const int /*currentPitchWheelPosition*/)
-{
-    
-
-    
-    
-    if (CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (s))
-    {
-        
-        IIRCoefficients coef;
-        switch (sound->filter_type)
-        {
-            case 1:
-                coef=IIRCoefficients::makeLowPass(sound->sourceSampleRate,sound->filter_cutoff);
-                break;
-            case 2:
-                coef=IIRCoefficients::makeHighPass(sound->sourceSampleRate,sound->filter_cutoff);
-                break;
-            case 3:
-                coef=IIRCoefficients::makeBandPass(sound->sourceSampleRate,sound->filter_cutoff);
-                break;
-        }
-        
-        if (sound->filter_active==0)
-        {
-            coef=IIRCoefficients(1,0,0,1,0,0);
-        }
-        
-        filterR.setCoefficients(coef);
-        filterL.setCoefficients(coef);
-        filterR.reset();
-        filterL.reset();
-
-        
-        pitchRatio = pow (2.0, (midiNoteNumber - sound->midiRootNote + sound->detune) / 12.0) * sound->sourceSampleRate / getSampleRate();
-        
-
-        sourceSamplePosition = sound->sample_start * sound->sample_length;
-        sourceSampleLength= sound->sample_end * sound->sample_length;
-        
-        lgain = velocity;
-        rgain = velocity;
-        
-        isInAttack = (sound->attackSamples > 0);
-        isInRelease = false;
-   
-       
-        if (isInAttack)
-        {
-            attackReleaseLevel = 0.0f;
-            attackDelta = (float) (pitchRatio / sound->attackSamples);
-        }
-        else
-        {
-            attackReleaseLevel = 1.0f;
-            attackDelta = 0.0f;
-        }
-        
-        if (sound->releaseSamples > 0)
-            releaseDelta = (float) (-pitchRatio / sound->releaseSamples);
-        else
-            releaseDelta = -1.0f;
-    }
-    else
-    {
-        jassertfalse; // this object can only play CustomSamplerSounds!
-    }
-}
-
-void CustomSamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
-{
-    
- 
-    if (allowTailOff)
-    {
-        //Logger::outputDebugString("Coucou1");
-        isInAttack = false;
-        isInRelease = true;
-      
-    }
-    else
-    {
-        clearCurrentNote();
-    }
-
-}
-
-
-
-void CustomSamplerVoice::pitchWheelMoved (const int /*newValue*/)
-{
-}
-
-void CustomSamplerVoice::controllerMoved (const int /*controllerNumber*/,
-                                    const int /*newValue*/)
-{
-}
-
-//==============================================================================
-void CustomSamplerVoice::renderNextBlock (AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
-{
-
-    
-    if (const CustomSamplerSound* const playingSound = static_cast<CustomSamplerSound*> (getCurrentlyPlayingSound().get()))
-    {
-
-        const float* const inL = playingSound->data->getReadPointer (0);
-        const float* const inR = playingSound->data->getNumChannels() > 1 ? playingSound->data->getReadPointer (1) : nullptr;
-        
-        float* outL = outputBuffer.getWritePointer (0, startSample);
-        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
-        
-        while (--numSamples >= 0)
-        {
-            const int pos = (int) sourceSamplePosition;
-            const float alpha = (float) (sourceSamplePosition - pos);
-            const float invAlpha = 1.0f - alpha;
-            
-            // just using a very simple linear interpolation here..
-            float l = (inL [pos] * invAlpha + inL [pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR [pos] * invAlpha + inR [pos + 1] * alpha): l;
-            
-            l *= lgain;
-            r *= rgain;
-            
-            if (isInAttack)
-            {
-                l *= attackReleaseLevel;
-                r *= attackReleaseLevel;
-                
-                attackReleaseLevel += attackDelta;
-                
-                if (attackReleaseLevel >= 1.0f)
-                {
-                    attackReleaseLevel = 1.0f;
-                    isInAttack = false;
-                }
-            }
-            else if (isInRelease)
-            {
-                l *= attackReleaseLevel;
-                r *= attackReleaseLevel;
-                
-                attackReleaseLevel += releaseDelta;
-
-                if (attackReleaseLevel <= 0.0f)
-                {
-                    stopNote (0.0f, false);
-                    break;
-                }
-            }
-            
-            //Perform filtering
-            
-            if (outR != nullptr)
-            {
-                *outL++ += filterL.processSingleSampleRaw(l);
-
-                *outR++ += filterR.processSingleSampleRaw(r);
-            }
-            else
-            {
-                *outL++ += filterL.processSingleSampleRaw((l + r) * 0.5f);
-            }
-            sourceSamplePosition += pitchRatio;
-            
-            if (sourceSamplePosition > sourceSampleLength)
-            {
-                stopNote (0.0f,false);
-                break;
-            }
-        }
-    }
-    
-   
-}
-
-
-
+#include "CustomSampler.h"
+#include "FreezeCache.h"
+#include "WaveformCache.h"
+#include "Trace.h"
+
+CustomSamplerSound::CustomSamplerSound (const String& soundName,
+                            const BigInteger& notes,
+                            const int midiNoteForNormalPitch,
+                            const double attackTimeSecs,
+                            const double releaseTimeSecs,
+                            const double maxSampleLengthSeconds)
+: detune(0),
+midiRootNote (midiNoteForNormalPitch),
+name (soundName),
+data (nullptr),
+paramsVersion (0),
+shouldTrim (false),
+normalisationTarget (0.0f),
+gain (1.0f),
+midiNotes (notes),
+attackTimeSecs (attackTimeSecs),
+releaseTimeSecs(releaseTimeSecs),
+maxSampleLengthSeconds (maxSampleLengthSeconds)
+{
+    filter_active=0;
+    filter_type=1;
+    filter_cutoff=1000.0;
+    sample_start=0.;
+    sample_end=1.;
+    sourceSampleRate=44100;
+    sample_length=1;
+    sample_index=0;
+    pad_index=0;
+    waveformCache=nullptr;
+    formatManager.registerBasicFormats();
+    dataHolder = new SampleBuffer (2, 0, sourceSampleRate);
+    releasePool->add (dataHolder.get());
+    data = dataHolder.get();
+    waveform = new WaveformPyramid (dataHolder);
+}
+
+
+CustomSamplerSound::~CustomSamplerSound()
+{
+}
+
+void CustomSamplerSound::loadSound()
+{
+    TRACE_SCOPE ("load sound");
+    
+    const File file (getAudioFile());
+    
+    // the format comes from the content, so a blob or a FLAC file named .aif loads all the same
+    std::unique_ptr<AudioFormatReader> source (formatManager.createReaderFor (file.createInputStream()));
+ 
+    SampleBuffer::Ptr newData;
+    WaveformPyramid::Ptr newWaveform;
+    SampleAnalysis newAnalysis;
+    
+    if (source == nullptr || source->sampleRate <= 0 || source->lengthInSamples <= 0)
+    {
+        Logger::outputDebugString ("Cannot decode " + file.getFullPathName());
+        newData = new SampleBuffer (2, 0, 44100.0);
+    }
+    else
+    {
+        newData = SampleBuffer::readFrom (*source, (int64) (maxSampleLengthSeconds * source->sampleRate));
+        
+        if (newData->getLength() < source->lengthInSamples)
+            Logger::outputDebugString (file.getFullPathName() + ": only the first " + String (maxSampleLengthSeconds, 1)
+                                        + " s of " + String (source->lengthInSamples / source->sampleRate, 1) + " s are loaded");
+        newAnalysis = waveformCache != nullptr ? waveformCache->getAnalysis (file, *newData)
+                                               : SampleAnalysis::analyse (*newData);
+        
+        // trimmed before the waveform is looked up, which is then that of the trimmed sample
+        trimSilence (newData, newAnalysis);
+        
+        // drawn from the decoded data, the file is not read again for the waveform
+        if (waveformCache != nullptr)
+            newWaveform = waveformCache->getWaveform (file, newData);
+    }
+    
+    setSampleData (newData, newWaveform, &newAnalysis);
+}
+
+void CustomSamplerSound::setSampleData (SampleBuffer::Ptr newData, WaveformPyramid::Ptr newWaveform,
+                                        const SampleAnalysis* newAnalysis)
+{
+    jassert (newData != nullptr);
+    jassert (newAnalysis == nullptr || newAnalysis->length == newData->getLength());
+    
+    SampleAnalysis sampleAnalysis (newAnalysis != nullptr ? *newAnalysis : SampleAnalysis::analyse (*newData));
+    trimSilence (newData, sampleAnalysis);
+    
+    if (newWaveform == nullptr || &newWaveform->getSource() != newData.get())
+        newWaveform = new WaveformPyramid (newData);
+    
+    {
+        const ScopedLock sl (loadLock);
+        
+        sourceSampleRate = newData->getSampleRate();
+        sample_length = newData->getLength();
+        
+        // the old buffer stays in the pool until the voices playing it are done
+        releasePool->add (newData.get());
+        dataHolder = newData;
+        data = newData.get();
+        waveform = newWaveform;
+        analysis = sampleAnalysis;
+        updateGain();
+        paramsChanged();
+    }
+    
+    sendChangeMessage();
+}
+
+File CustomSamplerSound::getAudioFile() const
+{
+    const ScopedLock sl (loadLock);
+    return audioFile;
+}
+
+void CustomSamplerSound::setAudioFile (const File& newFile)
+{
+    const ScopedLock sl (loadLock);
+    audioFile = newFile;
+}
+
+SampleAnalysis CustomSamplerSound::getAnalysis() const
+{
+    const ScopedLock sl (loadLock);
+    return analysis;
+}
+
+void CustomSamplerSound::setSampleProcessing (bool shouldTrimSilence, float targetLufs)
+{
+    shouldTrim = shouldTrimSilence;
+    normalisationTarget = targetLufs;
+    
+    const ScopedLock sl (loadLock);
+    updateGain();
+}
+
+void CustomSamplerSound::trimSilence (SampleBuffer::Ptr& sample, SampleAnalysis& sampleAnalysis) const
+{
+    // an analysis that was trimmed already spans the whole sample
+    if (shouldTrim && (sampleAnalysis.onset > 0 || sampleAnalysis.tailEnd < sampleAnalysis.length))
+    {
+        sample = sample->createRange (sampleAnalysis.onset, sampleAnalysis.tailEnd);
+        sampleAnalysis = sampleAnalysis.trimmed();
+    }
+}
+
+void CustomSamplerSound::updateGain()
+{
+    const float target = normalisationTarget.load();
+    gain = target != 0.0f ? analysis.getNormalisationGain (target) : 1.0f;
+}
+
+WaveformPyramid::Ptr CustomSamplerSound::getWaveform() const
+{
+    const ScopedLock sl (loadLock);
+    return waveform;
+}
+
+
+IIRCoefficients CustomSamplerSound::makeFilterCoefficients (int filterType, bool filterActive, float cutoff, double sampleRate)
+{
+    if (! filterActive)
+        return IIRCoefficients (1,0,0,1,0,0);
+    
+    switch (filterType)
+    {
+        case 2:
+            return IIRCoefficients::makeHighPass (sampleRate, cutoff);
+        case 3:
+            return IIRCoefficients::makeBandPass (sampleRate, cutoff);
+        case 1:
+        default:
+            return IIRCoefficients::makeLowPass (sampleRate, cutoff);
+    }
+}
+
+bool CustomSamplerSound::appliesToNote (int midiNoteNumber)
+{
+    return midiNotes[midiNoteNumber];
+}
+
+bool CustomSamplerSound::appliesToChannel (int /*midiChannel*/)
+{
+    return true;
+}
+
+
+
+//==============================================================================
+CustomSamplerVoice::CustomSamplerVoice()
+:sourceSamplePosition (0.0),
+freezeCache (nullptr),
+frozenPosition (0),
+startPosition (0.0),
+pitchRatio (0.0),
+lgain (0.0f), rgain (0.0f),
+attackReleaseLevel (0), attackDelta (0), releaseDelta (0), peakLevel (0),
+isInAttack (false), isInRelease (false)
+{
+
+    
+}
+
+CustomSamplerVoice::~CustomSamplerVoice()
+{
+}
+
+bool CustomSamplerVoice::canPlaySound (SynthesiserSound* sound)
+{
+    return dynamic_cast<const CustomSamplerSound*> (sound) != nullptr;
+}
+
+void CustomSamplerVoice::startNote (const int midiNoteNumber,
+                              const float velocity,
+                              SynthesiserSound* s,
+                              const int /*currentPitchWheelPosition*/)
+{
+    TRACE_SCOPE ("start note");
+    
+
+    
+    
+    if (CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (s))
+    {
+        source = sound->getSampleData();
+        const double sourceRate = source->getSampleRate();
+        
+        const IIRCoefficients coef = CustomSamplerSound::makeFilterCoefficients (sound->filter_type, sound->filter_active != 0, sound->filter_cutoff, sourceRate);
+        filterR.setCoefficients(coef);
+        filterL.setCoefficients(coef);
+        filterR.reset();
+        filterL.reset();
+
+        
+        pitchRatio = pow (2.0, (midiNoteNumber - sound->midiRootNote + sound->detune) / 12.0) * sourceRate / getSampleRate();
+        
+
+        startPosition = sound->sample_start * source->getLength();
+        sourceSamplePosition = startPosition;
+        sourceSampleLength= sound->sample_end * source->getLength();
+        
+        // the frozen renders leave the gain to the voice as well
+        lgain = velocity * sound->getGain();
+        rgain = lgain;
+        
+        const int attackSamples = roundToInt (sound->getAttackTime() * sourceRate);
+        const int releaseSamples = roundToInt (sound->getReleaseTime() * sourceRate);
+        
+        isInAttack = (attackSamples > 0);
+        isInRelease = false;
+   
+       
+        if (isInAttack)
+        {
+            attackReleaseLevel = 0.0f;
+            attackDelta = (float) (pitchRatio / attackSamples);
+        }
+        else
+        {
+            attackReleaseLevel = 1.0f;
+            attackDelta = 0.0f;
+        }
+        
+        if (releaseSamples > 0)
+            releaseDelta = (float) (-pitchRatio / releaseSamples);
+        else
+            releaseDelta = -1.0f;
+        
+        // a frozen render already has the pitch, filter, trim and attack applied
+        frozen = nullptr;
+        frozenPosition = 0;
+        
+        if (freezeCache != nullptr && midiNoteNumber == sound->midiRootNote)
+        {
+            frozen = freezeCache->getFrozen (*sound, getSampleRate());
+            
+            if (frozen != nullptr)
+            {
+                isInAttack = false;
+                attackReleaseLevel = 1.0f;
+            }
+        }
+    }
+    else
+    {
+        jassertfalse; // this object can only play CustomSamplerSounds!
+    }
+}
+
+void CustomSamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
+{
+    
+ 
+    if (allowTailOff)
+    {
+        //Logger::outputDebugString("Coucou1");
+        isInAttack = false;
+        isInRelease = true;
+      
+    }
+    else
+    {
+        clearCurrentNote();
+        
+        // the release pool holds a reference too, so this never frees memory here
+        source = nullptr;
+        frozen = nullptr;
+    }
+
+}
+
+
+
+void CustomSamplerVoice::pitchWheelMoved (const int /*newValue*/)
+{
+}
+
+void CustomSamplerVoice::controllerMoved (const int /*controllerNumber*/,
+                                    const int /*newValue*/)
+{
+}
+
+//==============================================================================
+void CustomSamplerVoice::renderNextBlock (AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
+{
+
+    
+    if (frozen != nullptr)
+    {
+        renderFrozen (outputBuffer, startSample, numSamples);
+    }
+    else if (source != nullptr && getCurrentlyPlayingSound() != nullptr)
+    {
+
+        const float* const inL = source->getBuffer().getReadPointer (0);
+        const float* const inR = source->getNumChannels() > 1 ? source->getBuffer().getReadPointer (1) : nullptr;
+        
+        float* outL = outputBuffer.getWritePointer (0, startSample);
+        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+        float blockPeak = peakLevel;
+        
+        while (--numSamples >= 0)
+        {
+            const int pos = (int) sourceSamplePosition;
+            const float alpha = (float) (sourceSamplePosition - pos);
+            const float invAlpha = 1.0f - alpha;
+            
+            // just using a very simple linear interpolation here..
+            float l = (inL [pos] * invAlpha + inL [pos + 1] * alpha);
+            float r = (inR != nullptr) ? (inR [pos] * invAlpha + inR [pos + 1] * alpha): l;
+            
+            l *= lgain;
+            r *= rgain;
+            
+            if (isInAttack)
+            {
+                l *= attackReleaseLevel;
+                r *= attackReleaseLevel;
+                
+                attackReleaseLevel += attackDelta;
+                
+                if (attackReleaseLevel >= 1.0f)
+                {
+                    attackReleaseLevel = 1.0f;
+                    isInAttack = false;
+                }
+            }
+            else if (isInRelease)
+            {
+                l *= attackReleaseLevel;
+                r *= attackReleaseLevel;
+                
+                attackReleaseLevel += releaseDelta;
+
+                if (attackReleaseLevel <= 0.0f)
+                {
+                    stopNote (0.0f, false);
+                    break;
+                }
+            }
+            
+            //Perform filtering
+            
+            if (outR != nullptr)
+            {
+                const float filteredL = filterL.processSingleSampleRaw(l);
+                const float filteredR = filterR.processSingleSampleRaw(r);
+                *outL++ += filteredL;
+                *outR++ += filteredR;
+                blockPeak = jmax (blockPeak, std::abs (filteredL), std::abs (filteredR));
+            }
+            else
+            {
+                const float filtered = filterL.processSingleSampleRaw((l + r) * 0.5f);
+                *outL++ += filtered;
+                blockPeak = jmax (blockPeak, std::abs (filtered));
+            }
+            sourceSamplePosition += pitchRatio;
+            
+            if (sourceSamplePosition > sourceSampleLength)
+            {
+                stopNote (0.0f,false);
+                break;
+            }
+        }
+        
+        peakLevel = blockPeak;
+    }
+    
+   
+}
+
+void CustomSamplerVoice::renderFrozen (AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
+{
+    const float* const inL = frozen->getBuffer().getReadPointer (0) + frozenPosition;
+    const float* const inR = frozen->getNumChannels() > 1 ? frozen->getBuffer().getReadPointer (1) + frozenPosition : inL;
+    
+    float* outL = outputBuffer.getWritePointer (0, startSample);
+    float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+    
+    const int num = jmin (numSamples, frozen->getLength() - frozenPosition);
+    
+    if (! isInRelease)
+    {
+        // plain copy with the velocity gain
+        if (outR != nullptr)
+        {
+            FloatVectorOperations::addWithMultiply (outL, inL, lgain, num);
+            FloatVectorOperations::addWithMultiply (outR, inR, rgain, num);
+        }
+        else
+        {
+            FloatVectorOperations::addWithMultiply (outL, inL, lgain * 0.5f, num);
+            FloatVectorOperations::addWithMultiply (outL, inR, rgain * 0.5f, num);
+        }
+        
+        if (num > 0)
+        {
+            const Range<float> rangeL (FloatVectorOperations::findMinAndMax (inL, num));
+            const Range<float> rangeR (FloatVectorOperations::findMinAndMax (inR, num));
+            peakLevel = jmax (peakLevel, lgain * jmax (-rangeL.getStart(), rangeL.getEnd()),
+                                         rgain * jmax (-rangeR.getStart(), rangeR.getEnd()));
+        }
+        
+        frozenPosition += num;
+    }
+    else
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            const float l = inL[i] * lgain * attackReleaseLevel;
+            const float r = inR[i] * rgain * attackReleaseLevel;
+            
+            attackReleaseLevel += releaseDelta;
+            
+            if (attackReleaseLevel <= 0.0f)
+            {
+                stopNote (0.0f, false);
+                return;
+            }
+            
+            if (outR != nullptr)
+            {
+                outL[i] += l;
+                outR[i] += r;
+            }
+            else
+            {
+                outL[i] += (l + r) * 0.5f;
+            }
+            
+            peakLevel = jmax (peakLevel, std::abs (l), std::abs (r));
+        }
+        
+        frozenPosition += num;
+    }
+    
+    sourceSamplePosition = startPosition + frozenPosition * pitchRatio;
+    
+    if (frozenPosition >= frozen->getLength())
+        stopNote (0.0f, false);
+}
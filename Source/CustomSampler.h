@@ -1,125 +1,213 @@
-#include "../JuceLibraryCode/JuceHeader.h"
-
-#ifndef CUSTOMSAMPLER_H_INCLUDED
-#define CUSTOMSAMPLER_H_INCLUDED
-
-
-//==============================================================================
-/**
- A subclass of SynthesiserSound that represents a sampled audio clip.
- 
- This is a pretty basic sampler, and just attempts to load the whole audio stream
- into memory.
- 
- To use it, create a Synthesiser, add some CustomSamplerVoice objects to it, then
- give it some SampledSound objects to play.
- 
- @see CustomSamplerVoice, Synthesiser, SynthesiserSound
- */
-class CustomSamplerSound    : public SynthesiserSound, AsyncUpdater
-{
-public:
-
-    CustomSamplerSound (const String& name,
-                  const BigInteger& midiNotes,
-                  int midiNoteNumber,
-                  double attackTimeSecs,
-                  double releaseTimeSecs,
-                  double maxSampleLengthSeconds);
-    
-    /** Destructor. */
-    ~CustomSamplerSound();
-    
-    //==============================================================================
-    /** Returns the sample's name */
-    const String& getName() const noexcept                  { return name; }
-    
-    /** Returns the audio sample data.
-     This could return nullptr if there was a problem loading the data.
-     */
-    AudioSampleBuffer* getAudioData() const noexcept        { return data; }
-    
-    void loadSound();
-    void loadThumbnail();
-    
-    //==============================================================================
-    bool appliesToNote (int midiNoteNumber) override;
-    bool appliesToChannel (int midiChannel) override;
-    void handleAsyncUpdate() override;
-    
-    void setFilter();
-    int detune;
-    int filter_type;
-    float filter_cutoff;
-    int filter_active;
-    double sample_length;
-    float sample_start,sample_end;
-    int sample_index;
-    File audioFile;
-    
-    AudioFormatManager formatManager; 
-    AudioThumbnailCache thumbnailCache;
-    AudioThumbnail thumbnail;
-    int midiRootNote;
-
-private:
-    //==============================================================================
-    friend class CustomSamplerVoice;
-    
-    String name;
-    ScopedPointer<AudioSampleBuffer> data;
-    double sourceSampleRate;
-    BigInteger midiNotes;
-    int length, attackSamples, releaseSamples;
-    
-    double attackTimeSecs, releaseTimeSecs, maxSampleLengthSeconds;
-    
-    JUCE_LEAK_DETECTOR (CustomSamplerSound)
-};
-
-
-//==============================================================================
-/**
- A subclass of SynthesiserVoice that can play a CustomSamplerSound.
- 
- To use it, create a Synthesiser, add some CustomSamplerVoice objects to it, then
- give it some SampledSound objects to play.
- 
- @see CustomSamplerSound, Synthesiser, SynthesiserVoice
- */
-class CustomSamplerVoice    : public SynthesiserVoice
-{
-public:
-    //==============================================================================
-    /** Creates a CustomSamplerVoice. */
-    CustomSamplerVoice();
-    
-    /** Destructor. */
-    ~CustomSamplerVoice();
-    
-    //==============================================================================
-    bool canPlaySound (SynthesiserSound*) override;
-    
-    void startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int pitchWheel) override;
-    void stopNote (float velocity, bool allowTailOff) override;
-    void pitchWheelMoved (int newValue) override;
-    void controllerMoved (int controllerNumber, int newValue) override;
-    void renderNextBlock (AudioSampleBuffer&, int startSample, int numSamples) override;
-  
-    double sourceSamplePosition,sourceSampleLength;
-    
-private:
-    //==============================================================================
-    double pitchRatio;
-    float lgain, rgain, attackReleaseLevel, attackDelta, releaseDelta;
-    bool isInAttack, isInRelease;
-
-    IIRFilter filterL;
-    IIRFilter filterR;
-
-
-    JUCE_LEAK_DETECTOR (CustomSamplerVoice)
-};
-
-
-#endif   // CUSTOMSAMPLER_H_INCLUDED
+#include <JuceHeader.h>
+
+#ifndef CUSTOMSAMPLER_H_INCLUDED
+#define CUSTOMSAMPLER_H_INCLUDED
+
+#include "SampleBuffer.h"
+#include "SampleAnalysis.h"
+#include "WaveformPyramid.h"
+#include <atomic>
+
+class FreezeCache;
+class WaveformCache;
+
+
+//==============================================================================
+/**
+ A subclass of SynthesiserSound that represents a sampled audio clip.
+ 
+ This is a pretty basic sampler, and just attempts to load the whole audio stream
+ into memory.
+ 
+ To use it, create a Synthesiser, add some CustomSamplerVoice objects to it, then
+ give it some SampledSound objects to play.
+ 
+ A change message is sent every time a new sample has been loaded, so that
+ editors can refresh their waveform.
+ 
+ @see CustomSamplerVoice, Synthesiser, SynthesiserSound
+ */
+class CustomSamplerSound    : public SynthesiserSound,
+                              public ChangeBroadcaster
+{
+public:
+
+    CustomSamplerSound (const String& name,
+                  const BigInteger& midiNotes,
+                  int midiNoteNumber,
+                  double attackTimeSecs,
+                  double releaseTimeSecs,
+                  double maxSampleLengthSeconds);
+    
+    /** Destructor. */
+    ~CustomSamplerSound();
+    
+    //==============================================================================
+    /** Returns the sample's name */
+    const String& getName() const noexcept                  { return name; }
+    
+    /** Returns the audio sample data. Safe to call from the audio thread, the
+     returned buffer stays valid for as long as the pointer is kept.
+     */
+    SampleBuffer::Ptr getSampleData() const noexcept        { return data.load(); }
+    
+    /** Call after changing the pitch, filter or start/end, so that frozen renders of
+     the old settings stop being used.
+     */
+    void paramsChanged() noexcept                           { ++paramsVersion; }
+    int getParamsVersion() const noexcept                   { return paramsVersion.load(); }
+    
+    static IIRCoefficients makeFilterCoefficients (int filterType, bool filterActive, float cutoff, double sampleRate);
+    
+    double getAttackTime() const noexcept                   { return attackTimeSecs; }
+    double getReleaseTime() const noexcept                  { return releaseTimeSecs; }
+    
+    /** Decodes getAudioFile() into the sample. Any thread but the audio one. */
+    void loadSound();
+    
+    /** The file loadSound() reads. Any thread: a loader may set it while the GUI shows it. */
+    File getAudioFile() const;
+    void setAudioFile (const File& newFile);
+    
+    /** Replaces the sample with audio already decoded, e.g. generated or read from
+     memory. Not to be called from the audio thread. The waveform and the analysis
+     are made from the data when not given; a given analysis must be that of newData.
+     */
+    void setSampleData (SampleBuffer::Ptr newData, WaveformPyramid::Ptr newWaveform = nullptr,
+                        const SampleAnalysis* newAnalysis = nullptr);
+    
+    /** What was measured on the current sample, after any trimming. Not for the audio thread. */
+    SampleAnalysis getAnalysis() const;
+    
+    /** Cuts the silence before the onset and after the tail of the samples loaded
+     from now on, and brings each one to targetLufs (0 leaves the level alone).
+     The start/end of the pad then apply to the trimmed sample.
+     */
+    void setSampleProcessing (bool shouldTrimSilence, float targetLufs);
+    
+    /** Level at which the voices play the sample, from the normalisation. Audio thread. */
+    float getGain() const noexcept                          { return gain.load(); }
+    
+    /** loadSound() then takes the waveform of the file from this cache. */
+    void setWaveformCache (WaveformCache* cache) noexcept   { waveformCache = cache; }
+    
+    /** Summary of the current sample for drawing it, built along with it. Not for the audio thread. */
+    WaveformPyramid::Ptr getWaveform() const;
+    
+    //==============================================================================
+    bool appliesToNote (int midiNoteNumber) override;
+    bool appliesToChannel (int midiChannel) override;
+    
+    void setFilter();
+    int detune;
+    int filter_type;
+    float filter_cutoff;
+    int filter_active;
+    double sample_length;
+    float sample_start,sample_end;
+    int sample_index;
+    int pad_index;
+    
+    AudioFormatManager formatManager; 
+    int midiRootNote;
+
+private:
+    //==============================================================================
+    friend class CustomSamplerVoice;
+    
+    void trimSilence (SampleBuffer::Ptr& sample, SampleAnalysis& sampleAnalysis) const;
+    void updateGain();
+    
+    String name;
+    File audioFile;
+    std::atomic<SampleBuffer*> data;
+    SampleBuffer::Ptr dataHolder;
+    WaveformPyramid::Ptr waveform;
+    SampleAnalysis analysis;
+    SharedResourcePointer<ReleasePool> releasePool;
+    WaveformCache* waveformCache;
+    CriticalSection loadLock;
+    std::atomic<int> paramsVersion;
+    std::atomic<bool> shouldTrim;
+    std::atomic<float> normalisationTarget, gain;
+    double sourceSampleRate;
+    BigInteger midiNotes;
+    
+    double attackTimeSecs, releaseTimeSecs, maxSampleLengthSeconds;
+    
+    JUCE_LEAK_DETECTOR (CustomSamplerSound)
+};
+
+
+//==============================================================================
+/**
+ A subclass of SynthesiserVoice that can play a CustomSamplerSound.
+ 
+ To use it, create a Synthesiser, add some CustomSamplerVoice objects to it, then
+ give it some SampledSound objects to play.
+ 
+ @see CustomSamplerSound, Synthesiser, SynthesiserVoice
+ */
+class CustomSamplerVoice    : public SynthesiserVoice
+{
+public:
+    //==============================================================================
+    /** Creates a CustomSamplerVoice. */
+    CustomSamplerVoice();
+    
+    /** Destructor. */
+    ~CustomSamplerVoice();
+    
+    //==============================================================================
+    bool canPlaySound (SynthesiserSound*) override;
+    
+    void startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int pitchWheel) override;
+    void stopNote (float velocity, bool allowTailOff) override;
+    void pitchWheelMoved (int newValue) override;
+    void controllerMoved (int controllerNumber, int newValue) override;
+    void renderNextBlock (AudioSampleBuffer&, int startSample, int numSamples) override;
+    
+    /** Hits on pads frozen by this cache play the pre-rendered buffer. */
+    void setFreezeCache (FreezeCache* cache) noexcept       { freezeCache = cache; }
+  
+    double sourceSamplePosition,sourceSampleLength;
+    
+    //==============================================================================
+    /** Where the voice is in its sample, in seconds at the sample's own rate. Audio thread. */
+    double getPlayPositionSeconds() const noexcept
+    {
+        return source != nullptr ? sourceSamplePosition / source->getSampleRate() : 0.0;
+    }
+    
+    /** Attack/release level, 1 while the note is held. Audio thread. */
+    float getEnvelopeLevel() const noexcept                  { return attackReleaseLevel; }
+    
+    /** Largest sample the voice has added to its output since the last call. Audio thread. */
+    float getAndResetPeak() noexcept
+    {
+        const float peak = peakLevel;
+        peakLevel = 0.0f;
+        return peak;
+    }
+    
+private:
+    //==============================================================================
+    void renderFrozen (AudioSampleBuffer&, int startSample, int numSamples);
+    
+    FreezeCache* freezeCache;
+    SampleBuffer::Ptr source, frozen;
+    int frozenPosition;
+    double startPosition;
+    double pitchRatio;
+    float lgain, rgain, attackReleaseLevel, attackDelta, releaseDelta, peakLevel;
+    bool isInAttack, isInRelease;
+
+    IIRFilter filterL;
+    IIRFilter filterR;
+
+
+    JUCE_LEAK_DETECTOR (CustomSamplerVoice)
+};
+
+
+#endif   // CUSTOMSAMPLER_H_INCLUDED
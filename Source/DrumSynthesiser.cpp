@@ -1,97 +1,397 @@
-/*
-  ==============================================================================
-
-    DrumSynthesiser.cpp
-    Created: 27 Feb 2017 8:14:35am
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "DrumSynthesiser.h"
-#include "CustomSampler.h"
-
-#define NB_SOUNDS_MAX 32
-
-//==============================================================================
-DrumSynthesiser::DrumSynthesiser():   Synthesiser(),sampleRate (0),
-            lastNoteOnCounter (0),
-            minimumSubBlockSize (32),
-            subBlockSubdivisionIsStrict (false),
-            shouldStealNotes (false)
-            
-{
-    num_kit=0;
-    int i;
-    int base_note=36;
-
-    nb_samples=BinaryData::namedResourceListSize;
-    
-    midiNoteNumber_playing=0;
-    
-    for (i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
-        {
-        lastPitchWheelValues[i] = 0x2000;  
-        }
-        
-    for (i = 0; i < 10; ++i)
-        {
-        addVoice (new CustomSamplerVoice());
-        }
-    
-    clearSounds();
-    
-    for (i = 0; i < nb_samples; i++)
-        {
-        BigInteger Notes;
-        Notes.setBit(i+base_note);
-        addSound(new CustomSamplerSound(String(i),Notes,base_note+i,0.01,0.02,10.0));
-        }
- 
-}
-
-DrumSynthesiser::~DrumSynthesiser()
-{
-    
-}
-
-
-void DrumSynthesiser::loadKit()
-{
-    Logger::outputDebugString("DrumSynth_loadsound");
-    for (int i = 0; i < nb_samples; i++)
-    {
-        SynthesiserSound::Ptr synthSound = getSound(i);
-        CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synthSound.get()) };
-        File audioFile = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile (String::formatted("kit%d/mysample%d.aif",num_kit,i+1));
-        Logger::outputDebugString(audioFile.getFullPathName());
-        sound->sample_index=i;
-        sound->audioFile=audioFile;
-        sound->loadSound();
-    }
-
-}
-
-
-
-
-
-float DrumSynthesiser::getCurrentPosition(int midiRootNote)
-{
-    float audioPosition=0;
-    
-    for (int i = voices.size(); --i >= 0;)
-    {
-        if (voices.getUnchecked (i)->getCurrentlyPlayingNote() == midiRootNote)
-        {
-            CustomSamplerVoice* voice = dynamic_cast<CustomSamplerVoice*> (voices.getUnchecked (i));
-            audioPosition=(voice->sourceSamplePosition)/voice->getSampleRate();
-        }
-
-    }
-    return audioPosition;
-}
-
+/*
+  ==============================================================================
+
+    DrumSynthesiser.cpp
+    Created: 27 Feb 2017 8:14:35am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+
+
+#include <JuceHeader.h>
+#include "DrumSynthesiser.h"
+#include "CustomSampler.h"
+#include "Trace.h"
+#include "RealtimeChecker.h"
+
+#define NB_SOUNDS_MAX 32
+
+//==============================================================================
+DrumSynthesiser::DrumSynthesiser():   Synthesiser(),busMixer (nullptr),
+            freezeCache (*this),
+            loaderPool (jlimit (1, 8, SystemStats::getNumCpus())),
+            sampleRate (0),
+            lastNoteOnCounter (0),
+            minimumSubBlockSize (32),
+            subBlockSubdivisionIsStrict (false),
+            shouldStealNotes (false)
+            
+{
+    num_kit=0;
+    int i;
+    int base_note=36;
+
+    nb_samples=getNumPads();
+    
+    midiNoteNumber_playing=0;
+    setKitRoot (File::getSpecialLocation (File::userApplicationDataDirectory));
+    zeromem (padPeakHolds, sizeof (padPeakHolds));
+    
+    for (i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
+        {
+        lastPitchWheelValues[i] = 0x2000;  
+        }
+        
+    for (i = 0; i < 10; ++i)
+        {
+        CustomSamplerVoice* voice = new CustomSamplerVoice();
+        voice->setFreezeCache (&freezeCache);
+        addVoice (voice);
+        }
+    
+    clearSounds();
+    
+    for (i = 0; i < nb_samples; i++)
+        {
+        BigInteger Notes;
+        Notes.setBit(i+base_note);
+        CustomSamplerSound* sound = new CustomSamplerSound(String(i),Notes,base_note+i,0.01,0.02,maxSampleSeconds);
+        sound->sample_index=i;
+        sound->pad_index=i;
+        sound->setWaveformCache (&waveformCache);
+        addSound(sound);
+        }
+
+    // Synthesiser::renderNextBlock() takes this lock around every block. The
+    // other threads only hold it to add or remove sounds and voices, which never
+    // wait on anything, so the audio thread is not kept waiting for long
+    RealtimeChecker::addAllowedLock (&getLock());
+}
+
+DrumSynthesiser::~DrumSynthesiser()
+{
+    RealtimeChecker::removeAllowedLock (&getLock());
+}
+
+
+Result DrumSynthesiser::loadKit()
+{
+    TRACE_SCOPE ("load kit");
+    Logger::outputDebugString("DrumSynth_loadsound");
+    
+    const File packageFile = getKitPackageFile();
+    String packageError;
+    
+    if (packageFile.existsAsFile())
+    {
+        const Result result = loadPackage (packageFile);
+        
+        if (result.wasOk())
+            return result;
+        
+        packageError = result.getErrorMessage() + ", and ";
+        Logger::outputDebugString (result.getErrorMessage());
+    }
+    
+    // each pad decodes its file and gets its waveform on a loader thread
+    runOnLoaders (nb_samples, [this] (int i) { loadSample (i+1); });
+    
+    for (int i = 1; i <= nb_samples; ++i)
+        if (! getSampleFile (i).existsAsFile())
+            return Result::fail (packageError + "missing sample " + getSampleFile (i).getFullPathName());
+    
+    return Result::ok();
+}
+
+
+void DrumSynthesiser::copyPadsFrom (const DrumSynthesiser& other)
+{
+    for (int i = 0; i < jmin (getNumSounds(), other.getNumSounds()); ++i)
+    {
+        CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (getSound (i).get());
+        const CustomSamplerSound* source = dynamic_cast<const CustomSamplerSound*> (other.getSound (i).get());
+        
+        if (sound == nullptr || source == nullptr)
+            continue;
+        
+        sound->midiRootNote = source->midiRootNote;
+        sound->detune = source->detune;
+        sound->filter_type = source->filter_type;
+        sound->filter_active = source->filter_active;
+        sound->filter_cutoff = source->filter_cutoff;
+        sound->sample_start = source->sample_start;
+        sound->sample_end = source->sample_end;
+        sound->sample_index = source->sample_index;
+        sound->setAudioFile (source->getAudioFile());
+        
+        // already trimmed, so the buffer is taken as it is
+        const SampleAnalysis analysis (source->getAnalysis());
+        sound->setSampleData (source->getSampleData(), source->getWaveform(), &analysis);
+    }
+}
+
+
+Result DrumSynthesiser::loadPackage (const File& packageFile)
+{
+    TRACE_SCOPE ("load kit package");
+    KitPackage::Ptr package;
+    Result result = KitPackage::open (packageFile, package);
+    
+    if (result.failed())
+        return result;
+    
+    CriticalSection resultLock;
+    StringArray dropped;
+    
+    runOnLoaders (package->getNumPads(), [&] (int i)
+    {
+        const KitPackage::Pad& pad = package->getPad (i);
+        CustomSamplerSound* sound = nullptr;
+        
+        for (int j = 0; j < getNumSounds() && sound == nullptr; ++j)
+            if (CustomSamplerSound* candidate = dynamic_cast<CustomSamplerSound*> (getSound (j).get()))
+                if (candidate->pad_index == pad.padIndex)
+                    sound = candidate;
+        
+        if (sound == nullptr)
+        {
+            const ScopedLock sl (resultLock);
+            dropped.add (String (pad.padIndex) + " (" + pad.name + ")");
+            return;
+        }
+        
+        SampleBuffer::Ptr data;
+        const Result padResult = package->getSample (i, data);
+        
+        if (padResult.failed())
+        {
+            const ScopedLock sl (resultLock);
+            result = padResult;
+            return;
+        }
+        
+        sound->midiRootNote = pad.rootNote;
+        sound->detune = pad.detune;
+        sound->filter_type = pad.filterType;
+        sound->filter_active = pad.filterActive;
+        sound->filter_cutoff = pad.filterCutoff;
+        sound->sample_start = pad.sampleStart;
+        sound->sample_end = pad.sampleEnd;
+        sound->setAudioFile (packageFile);
+        sound->setSampleData (data);
+    });
+    
+    if (! dropped.isEmpty())
+        Logger::outputDebugString (packageFile.getFullPathName() + ": no pad " + dropped.joinIntoString (", ")
+                                    + " in the synth, which has " + String (getNumSounds()) + ", they are not played");
+    
+    return result;
+}
+
+
+File DrumSynthesiser::getKitPackageFile() const
+{
+    return kitRoot.getChildFile (String::formatted ("kit%d.sskit", num_kit));
+}
+
+
+void DrumSynthesiser::runOnLoaders (int numJobs, const std::function<void (int)>& job)
+{
+    std::atomic<int> numPending (numJobs);
+    WaitableEvent allDone;
+    
+    for (int i = 0; i < numJobs; i++)
+    {
+        loaderPool.addJob ([i, &job, &numPending, &allDone]
+        {
+            TRACE_THREAD_NAME ("kit loader");
+            job (i);
+            
+            if (--numPending == 0)
+                allDone.signal();
+        });
+    }
+    
+    if (numJobs > 0)
+        allDone.wait();
+}
+
+
+void DrumSynthesiser::loadSample (int sampleNumber)
+{
+    SynthesiserSound::Ptr synthSound = getSound(sampleNumber-1);
+    CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synthSound.get()) };
+    
+    if (sound == nullptr)
+        return;
+    
+    File audioFile = getSampleFile (sampleNumber);
+    Logger::outputDebugString(audioFile.getFullPathName());
+    sound->sample_index=sampleNumber-1;
+    sound->setAudioFile (audioFile);
+    sound->loadSound();
+}
+
+
+void DrumSynthesiser::setKitRoot (const File& newRoot)
+{
+    kitRoot = newRoot;
+    waveformCache.setFolder (kitRoot.getChildFile ("waveforms"));
+}
+
+
+Result DrumSynthesiser::sliceToPads (int sourcePad, const TransientSlicer::Options& options)
+{
+    TRACE_SCOPE ("slice to pads");
+    CustomSamplerSound* source = dynamic_cast<CustomSamplerSound*> (getSound (sourcePad).get());
+    
+    if (source == nullptr || source->getSampleData()->getLength() == 0)
+        return Result::fail ("Pad " + String (sourcePad + 1) + " has no sample to slice");
+    
+    // set again first, so that any trimming is done once and every pad gets the very same buffer
+    {
+        const SampleAnalysis current (source->getAnalysis());
+        source->setSampleData (source->getSampleData(), source->getWaveform(), &current);
+    }
+    
+    const SampleBuffer::Ptr data (source->getSampleData());
+    const WaveformPyramid::Ptr waveform (source->getWaveform());
+    const SampleAnalysis analysis (source->getAnalysis());
+    
+    // no more slices than pads to take them: the strongest hits that fit are kept, and the last pad plays to the end
+    TransientSlicer::Options fitting (options);
+    fitting.maxSlices = jmin (options.maxSlices, getNumSounds() - sourcePad);
+    
+    const Array<int> slices (TransientSlicer::findSlices (*data, fitting));
+    const float length = (float) data->getLength();
+    
+    for (int i = 0; i < slices.size(); ++i)
+    {
+        CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (getSound (sourcePad + i).get());
+        jassert (sound != nullptr);
+        
+        sound->setAudioFile (source->getAudioFile());
+        sound->sample_index = source->sample_index;
+        sound->sample_start = slices.getUnchecked (i) / length;
+        sound->sample_end = i + 1 < slices.size() ? slices.getUnchecked (i + 1) / length : 1.0f;
+        sound->setSampleData (data, waveform, &analysis);
+    }
+    
+    return Result::ok();
+}
+
+
+void DrumSynthesiser::sliceToPadsAsync (int sourcePad, const TransientSlicer::Options& options)
+{
+    loaderPool.addJob ([this, sourcePad, options]
+    {
+        TRACE_THREAD_NAME ("kit loader");
+        const Result result (sliceToPads (sourcePad, options));
+        
+        if (result.failed())
+            Logger::outputDebugString (result.getErrorMessage());
+    });
+}
+
+
+void DrumSynthesiser::setSampleProcessing (bool shouldTrimSilence, float targetLufs)
+{
+    for (int i = 0; i < getNumSounds(); ++i)
+        if (CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (getSound (i).get()))
+            sound->setSampleProcessing (shouldTrimSilence, targetLufs);
+}
+
+
+File DrumSynthesiser::getSampleFile (int sampleNumber) const
+{
+    return kitRoot.getChildFile (String::formatted ("kit%d/mysample%d.aif", num_kit, sampleNumber));
+}
+
+
+int DrumSynthesiser::getNumActiveVoices() const noexcept
+{
+    int numActive = 0;
+
+    for (auto* voice : voices)
+        if (voice->isVoiceActive())
+            ++numActive;
+
+    return numActive;
+}
+
+
+void DrumSynthesiser::noteOn (int midiChannel, int midiNoteNumber, float velocity)
+{
+    TRACE_SCOPE ("note on");
+    Synthesiser::noteOn (midiChannel, midiNoteNumber, velocity);
+}
+
+
+void DrumSynthesiser::renderVoices (AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    VoiceStateChannel::Snapshot states;
+    CustomSamplerVoice* latestVoices[VoiceStateChannel::maxPads] = {};
+
+    // each voice adds straight into the buffer of its pad's bus, the bus buffers
+    // are as long as the whole block so the sub-block offsets stay valid
+    for (int i = voices.size(); --i >= 0;)
+    {
+        CustomSamplerVoice* voice = static_cast<CustomSamplerVoice*> (voices.getUnchecked (i));
+
+        if (! voice->isVoiceActive())
+            continue;
+
+        const CustomSamplerSound* sound = static_cast<const CustomSamplerSound*> (voice->getCurrentlyPlayingSound().get());
+        AudioSampleBuffer* target = &outputAudio;
+
+        if (busMixer != nullptr && sound != nullptr)
+            if (AudioSampleBuffer* busBuffer = busMixer->getBufferForPad (sound->pad_index))
+                target = busBuffer;
+
+        {
+            TRACE_SCOPE ("voice");
+            voice->renderNextBlock (*target, startSample, numSamples);
+        }
+
+        if (sound != nullptr && isPositiveAndBelow (sound->pad_index, (int) VoiceStateChannel::maxPads))
+        {
+            VoiceStateChannel::PadState& pad = states.pads[sound->pad_index];
+            pad.peakLevel = jmax (pad.peakLevel, voice->getAndResetPeak());
+
+            // a voice that ended in this block only leaves its peak
+            if (voice->isVoiceActive())
+            {
+                CustomSamplerVoice*& latest = latestVoices[sound->pad_index];
+                ++pad.numVoices;
+
+                if (latest == nullptr || latest->wasStartedBefore (*voice))
+                    latest = voice;
+            }
+        }
+    }
+
+    publishVoiceStates (states, latestVoices, numSamples);
+}
+
+void DrumSynthesiser::publishVoiceStates (VoiceStateChannel::Snapshot& states, CustomSamplerVoice* const* latestVoices, int numSamples) noexcept
+{
+    // held peaks fall by half every 0.3 s, so a reader polling slower than the blocks still sees the hits
+    const float decay = getSampleRate() > 0.0 ? (float) std::exp2 (-numSamples / (0.3 * getSampleRate())) : 0.0f;
+
+    for (int pad = 0; pad < VoiceStateChannel::maxPads; ++pad)
+    {
+        VoiceStateChannel::PadState& state = states.pads[pad];
+        padPeakHolds[pad] = jmax (state.peakLevel, padPeakHolds[pad] * decay);
+        state.peakLevel = padPeakHolds[pad];
+
+        if (const CustomSamplerVoice* voice = latestVoices[pad])
+        {
+            state.positionSeconds = (float) voice->getPlayPositionSeconds();
+            state.envelopeLevel = voice->getEnvelopeLevel();
+        }
+    }
+
+    voiceStates.publish (states);
+}
@@ -1,49 +1,136 @@
-/*
-  ==============================================================================
-
-    DrumSynthesiser.h
-    Created: 27 Feb 2017 8:14:35am
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-#ifndef DRUMSYNTHESISER_H_INCLUDED
-#define DRUMSYNTHESISER_H_INCLUDED
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "CustomSampler.h"
-
-
-//==============================================================================
-/*
-*/
-class DrumSynthesiser    : public Synthesiser
-{
-public:
-    DrumSynthesiser();
-    ~DrumSynthesiser();
-    
-    float getCurrentPosition(int midiRootNote);
-    int midiNoteNumber_playing;
-    void loadKit();
-    int current_sound;
-    int num_kit;
-    int nb_samples;
-
-private:
-
-    double sampleRate;
-    uint32 lastNoteOnCounter;
-    int minimumSubBlockSize;
-    bool subBlockSubdivisionIsStrict;
-    bool shouldStealNotes;
-    BigInteger sustainPedalsDown;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DrumSynthesiser)
-};
-
-
-
-
-#endif  // DRUMSYNTHESISER_H_INCLUDED
+/*
+  ==============================================================================
+
+    DrumSynthesiser.h
+    Created: 27 Feb 2017 8:14:35am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef DRUMSYNTHESISER_H_INCLUDED
+#define DRUMSYNTHESISER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "CustomSampler.h"
+#include "BusMixer.h"
+#include "FreezeCache.h"
+#include "VoiceStateChannel.h"
+#include "WaveformCache.h"
+#include "KitPackage.h"
+#include "TransientSlicer.h"
+
+
+//==============================================================================
+/*
+*/
+class DrumSynthesiser    : public Synthesiser
+{
+public:
+    DrumSynthesiser();
+    ~DrumSynthesiser();
+    
+    /** The longest sample a pad holds, long enough for a slow 4-bar loop. Anything
+        after it is left out, by loading as by packing a kit.
+     */
+    enum { maxSampleSeconds = 32 };
+
+    /** The pads of every synth, one per embedded sample: what getNumSounds() gives. */
+    static int getNumPads() noexcept                    { return BinaryData::namedResourceListSize; }
+    
+    int midiNoteNumber_playing;
+
+    /** Loads kit num_kit, from its package when there is one, else by decoding its
+        samples, the pads in parallel. Returns once all are loaded, with an error
+        if the package failed and sample files are missing too.
+     */
+    Result loadKit();
+
+    /** Gives every pad the sample and settings of the same pad of other, sharing
+        its buffers: nothing is read or decoded. other must not be loading meanwhile.
+     */
+    void copyPadsFrom (const DrumSynthesiser& other);
+
+    /** Sets each pad found in the package to its audio and settings. The audio of
+        raw pads stays in the mapped file, that of compressed ones is inflated.
+        Pads of the package that the synth does not have are logged and left out.
+     */
+    Result loadPackage (const File& packageFile);
+
+    /** The package of kit num_kit, kitN.sskit in the kit root. It may not exist. */
+    File getKitPackageFile() const;
+
+    /** Decodes sample file sampleNumber (from 1) of kit num_kit into its pad. Any thread but the audio one. */
+    void loadSample (int sampleNumber);
+
+    /** Folder holding the kitN/ folders and the waveforms/ cache, the user application data folder by default. */
+    void setKitRoot (const File& newRoot);
+    const File& getKitRoot() const noexcept             { return kitRoot; }
+
+    /** Cuts the sample of pad sourcePad at its hits and gives one slice to each pad
+        from sourcePad on. There are never more slices than pads left, whatever
+        options.maxSlices says, so the last slice always runs to the end of the sample.
+        The pads all play the same buffer, between their own sample_start and
+        sample_end, so the slices take no memory of their own. Any thread but the
+        audio one; it takes a while on a long loop.
+     */
+    Result sliceToPads (int sourcePad, const TransientSlicer::Options& options);
+
+    /** sliceToPads() on a loader thread. The pads send their change messages when it is done. */
+    void sliceToPadsAsync (int sourcePad, const TransientSlicer::Options& options);
+
+    /** Trimming and loudness normalisation of every pad, see CustomSamplerSound::setSampleProcessing().
+        The trimming applies from the next load on.
+     */
+    void setSampleProcessing (bool shouldTrimSilence, float targetLufs);
+
+    /** Sample file number sampleNumber (from 1) of the current kit. */
+    File getSampleFile (int sampleNumber) const;
+
+    int current_sound;
+    int num_kit;
+    int nb_samples;
+
+    /** Voices are rendered into the bus of the pad they play. Set before the audio starts. */
+    void setBusMixer (BusMixer* newMixer) noexcept      { busMixer = newMixer; }
+
+    FreezeCache& getFreezeCache() noexcept              { return freezeCache; }
+    WaveformCache& getWaveformCache() noexcept          { return waveformCache; }
+
+    /** Voices playing right now, cheap enough to call from the audio thread. */
+    int getNumActiveVoices() const noexcept;
+
+    /** Playhead, voices, envelope and level of each pad, as of the last block. Any thread. */
+    VoiceStateChannel::Snapshot getVoiceStates() const noexcept     { return voiceStates.read(); }
+
+    void noteOn (int midiChannel, int midiNoteNumber, float velocity) override;
+
+protected:
+    using Synthesiser::renderVoices;
+    void renderVoices (AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+private:
+    void runOnLoaders (int numJobs, const std::function<void (int)>& job);
+    void publishVoiceStates (VoiceStateChannel::Snapshot& states, CustomSamplerVoice* const* latestVoices, int numSamples) noexcept;
+
+    BusMixer* busMixer;
+    FreezeCache freezeCache;
+    WaveformCache waveformCache;
+    ThreadPool loaderPool;
+    VoiceStateChannel voiceStates;
+    float padPeakHolds[VoiceStateChannel::maxPads];
+    File kitRoot;
+    double sampleRate;
+    uint32 lastNoteOnCounter;
+    int minimumSubBlockSize;
+    bool subBlockSubdivisionIsStrict;
+    bool shouldStealNotes;
+    BigInteger sustainPedalsDown;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DrumSynthesiser)
+};
+
+
+
+
+#endif  // DRUMSYNTHESISER_H_INCLUDED
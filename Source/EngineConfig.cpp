@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    EngineConfig.cpp
+    Created: 19 Oct 2026 2:37:08pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "EngineConfig.h"
+
+namespace
+{
+    template <typename Type>
+    void readProperty (const var& json, const Identifier& name, Type& value)
+    {
+        if (json.hasProperty (name))
+            value = static_cast<Type> (json[name]);
+    }
+
+    void readProperty (const var& json, const Identifier& name, String& value)
+    {
+        if (json.hasProperty (name))
+            value = json[name].toString();
+    }
+
+    void readProperty (const var& json, const Identifier& name, File& value)
+    {
+        if (json.hasProperty (name))
+        {
+            const String path (json[name].toString());
+            value = path.isEmpty() ? File() : File::getCurrentWorkingDirectory().getChildFile (path);
+        }
+    }
+
+    String getPath (const File& file)
+    {
+        return file == File() ? String() : file.getFullPathName();
+    }
+}
+
+//==============================================================================
+EngineConfig::EngineConfig()
+:   sampleRate (0.0),
+    bufferSize (0),
+    numOutputChannels (BusMixer::maxOutputChannels),
+    kit (1),
+    kitRoot (File::getSpecialLocation (File::userApplicationDataDirectory)),
+    downloadMissingSamples (true),
+    maxParallelDownloads (4),
+    trimSilence (false),
+    normaliseLoudness (0.0f),
+    reverbSend (0.0f),
+    reverbReturn (1.0f),
+    reverbWorkerThread (false)
+{
+}
+
+File EngineConfig::getDefaultFile()
+{
+    return File::getSpecialLocation (File::userApplicationDataDirectory).getChildFile ("simple_sampler.json");
+}
+
+Result EngineConfig::loadFromFile (const File& file)
+{
+    if (! file.existsAsFile())
+        return Result::fail ("Cannot find " + file.getFullPathName());
+
+    var json;
+    const Result result (JSON::parse (file.loadFileAsString(), json));
+
+    if (result.failed())
+        return Result::fail (file.getFileName() + ": " + result.getErrorMessage());
+
+    if (! json.isObject())
+        return Result::fail (file.getFileName() + ": expected a JSON object");
+
+    fromVar (json);
+    return Result::ok();
+}
+
+Result EngineConfig::saveToFile (const File& file) const
+{
+    if (! file.getParentDirectory().createDirectory())
+        return Result::fail ("Cannot create " + file.getParentDirectory().getFullPathName());
+
+    if (! file.replaceWithText (JSON::toString (toVar())))
+        return Result::fail ("Cannot write " + file.getFullPathName());
+
+    return Result::ok();
+}
+
+//==============================================================================
+var EngineConfig::toVar() const
+{
+    DynamicObject::Ptr audio (new DynamicObject());
+    audio->setProperty ("type", audioDeviceType);
+    audio->setProperty ("device", audioDeviceName);
+    audio->setProperty ("sampleRate", sampleRate);
+    audio->setProperty ("bufferSize", bufferSize);
+    audio->setProperty ("outputChannels", numOutputChannels);
+
+    Array<var> midi;
+
+    for (auto& name : midiInputs)
+        midi.add (name);
+
+    DynamicObject::Ptr reverb (new DynamicObject());
+    reverb->setProperty ("impulseResponse", getPath (impulseResponse));
+    reverb->setProperty ("send", reverbSend);
+    reverb->setProperty ("return", reverbReturn);
+    reverb->setProperty ("workerThread", reverbWorkerThread);
+
+    Array<var> buses;
+
+    for (auto& bus : routing.buses)
+    {
+        DynamicObject::Ptr b (new DynamicObject());
+        b->setProperty ("output", bus.output);
+        b->setProperty ("mono", bus.mono);
+        b->setProperty ("gainDb", bus.gainDb);
+        b->setProperty ("reverbSend", bus.reverbSend);
+        buses.add (var (b.get()));
+    }
+
+    Array<var> pads;
+
+    for (auto bus : routing.padBus)
+        pads.add (bus);
+
+    DynamicObject::Ptr lim (new DynamicObject());
+    lim->setProperty ("enabled", limiter.enabled);
+    lim->setProperty ("thresholdDb", limiter.thresholdDb);
+    lim->setProperty ("ratio", limiter.ratio);
+    lim->setProperty ("lookaheadMs", limiter.lookaheadMs);
+    lim->setProperty ("releaseMs", limiter.releaseMs);
+    lim->setProperty ("rmsDetector", limiter.useRmsDetector);
+    lim->setProperty ("rmsWindowMs", limiter.rmsWindowMs);
+    lim->setProperty ("makeUpDb", limiter.makeUpDb);
+
+    DynamicObject::Ptr rt (new DynamicObject());
+    rt->setProperty ("enabled", realtime.enabled);
+    rt->setProperty ("priority", realtime.priority);
+    rt->setProperty ("audioCpu", realtime.audioCpu);
+    rt->setProperty ("lockMemory", realtime.lockMemory);
+
+    DynamicObject::Ptr root (new DynamicObject());
+    root->setProperty ("audio", var (audio.get()));
+    root->setProperty ("midiInputs", midi);
+    root->setProperty ("kit", kit);
+    root->setProperty ("kitRoot", getPath (kitRoot));
+    root->setProperty ("downloadMissingSamples", downloadMissingSamples);
+    root->setProperty ("kitServer", kitServer);
+    root->setProperty ("maxParallelDownloads", maxParallelDownloads);
+    root->setProperty ("trimSilence", trimSilence);
+    root->setProperty ("normaliseLoudness", normaliseLoudness);
+    root->setProperty ("reverb", var (reverb.get()));
+    root->setProperty ("buses", buses);
+    root->setProperty ("padBuses", pads);
+    root->setProperty ("limiter", var (lim.get()));
+    root->setProperty ("realtime", var (rt.get()));
+
+    return var (root.get());
+}
+
+void EngineConfig::fromVar (const var& json)
+{
+    const var audio (json["audio"]);
+    readProperty (audio, "type", audioDeviceType);
+    readProperty (audio, "device", audioDeviceName);
+    readProperty (audio, "sampleRate", sampleRate);
+    readProperty (audio, "bufferSize", bufferSize);
+    readProperty (audio, "outputChannels", numOutputChannels);
+    numOutputChannels = jlimit (1, (int) BusMixer::maxOutputChannels, numOutputChannels);
+
+    if (const Array<var>* midi = json["midiInputs"].getArray())
+    {
+        midiInputs.clear();
+
+        for (auto& name : *midi)
+            midiInputs.add (name.toString());
+    }
+
+    readProperty (json, "kit", kit);
+    readProperty (json, "kitRoot", kitRoot);
+    readProperty (json, "downloadMissingSamples", downloadMissingSamples);
+    readProperty (json, "kitServer", kitServer);
+    readProperty (json, "maxParallelDownloads", maxParallelDownloads);
+    readProperty (json, "trimSilence", trimSilence);
+    readProperty (json, "normaliseLoudness", normaliseLoudness);
+
+    const var reverb (json["reverb"]);
+    readProperty (reverb, "impulseResponse", impulseResponse);
+    readProperty (reverb, "send", reverbSend);
+    readProperty (reverb, "return", reverbReturn);
+    readProperty (reverb, "workerThread", reverbWorkerThread);
+
+    if (const Array<var>* buses = json["buses"].getArray())
+    {
+        for (int i = 0; i < jmin (buses->size(), (int) BusMixer::maxBuses); ++i)
+        {
+            const var& b = buses->getReference (i);
+            BusMixer::BusSettings& bus = routing.buses[i];
+            readProperty (b, "output", bus.output);
+            readProperty (b, "mono", bus.mono);
+            readProperty (b, "gainDb", bus.gainDb);
+            readProperty (b, "reverbSend", bus.reverbSend);
+        }
+    }
+
+    if (const Array<var>* pads = json["padBuses"].getArray())
+        for (int i = 0; i < jmin (pads->size(), (int) BusMixer::maxPads); ++i)
+            routing.padBus[i] = jlimit (0, BusMixer::maxBuses - 1, (int) pads->getReference (i));
+
+    const var lim (json["limiter"]);
+    readProperty (lim, "enabled", limiter.enabled);
+    readProperty (lim, "thresholdDb", limiter.thresholdDb);
+    readProperty (lim, "ratio", limiter.ratio);
+    readProperty (lim, "lookaheadMs", limiter.lookaheadMs);
+    readProperty (lim, "releaseMs", limiter.releaseMs);
+    readProperty (lim, "rmsDetector", limiter.useRmsDetector);
+    readProperty (lim, "rmsWindowMs", limiter.rmsWindowMs);
+    readProperty (lim, "makeUpDb", limiter.makeUpDb);
+
+    const var rt (json["realtime"]);
+    readProperty (rt, "enabled", realtime.enabled);
+    readProperty (rt, "priority", realtime.priority);
+    readProperty (rt, "audioCpu", realtime.audioCpu);
+    readProperty (rt, "lockMemory", realtime.lockMemory);
+}
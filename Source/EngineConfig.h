@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    EngineConfig.h
+    Created: 19 Oct 2026 2:37:08pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef ENGINECONFIG_H_INCLUDED
+#define ENGINECONFIG_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "BusMixer.h"
+#include "MasterDynamics.h"
+#include "RealtimeTuning.h"
+
+//==============================================================================
+/**
+ Everything the engine needs to come up without anybody touching it: audio and
+ MIDI devices, the kit to load, the IR of the reverb, the bus routing, the
+ master limiter and the scheduling of the audio thread.
+
+ Stored as a JSON file. Missing properties keep their default value, so a
+ config file only needs to name what differs from the defaults.
+ */
+struct EngineConfig
+{
+    EngineConfig();
+
+    /** Reads the properties found in the file over the current values. */
+    Result loadFromFile (const File& file);
+    Result saveToFile (const File& file) const;
+
+    var toVar() const;
+    void fromVar (const var& json);
+
+    /** userApplicationDataDirectory/simple_sampler.json, shared by both builds. */
+    static File getDefaultFile();
+
+    //==============================================================================
+    String audioDeviceType;         // empty: the platform default
+    String audioDeviceName;         // empty: the default output of the type
+    double sampleRate;              // 0: whatever the device prefers
+    int bufferSize;                 // 0: whatever the device prefers
+    int numOutputChannels;
+
+    StringArray midiInputs;         // empty: every MIDI input found at start-up
+
+    int kit;                        // 0: do not load a kit
+    File kitRoot;                   // where the kitN/ folders live
+    bool downloadMissingSamples;
+    String kitServer;               // empty: the project's server; e.g. http://127.0.0.1:8000 for a local copy
+    int maxParallelDownloads;
+
+    bool trimSilence;               // cut the samples to their onset and tail, see SampleAnalysis
+    float normaliseLoudness;        // LUFS every sample is brought to, 0: left as recorded
+
+    File impulseResponse;
+    float reverbSend, reverbReturn;
+    bool reverbWorkerThread;        // the older partitions on a thread of their own, see ConvolutionReverb
+
+    BusMixer::Routing routing;
+    MasterDynamics::Settings limiter;
+    RealtimeTuning::Settings realtime;
+};
+
+
+#endif  // ENGINECONFIG_H_INCLUDED
@@ -1,41 +1,328 @@
-/*
-  ==============================================================================
-
-    FXChain.cpp
-    Created: 2 Mar 2017 9:41:35pm
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "FXChain.h"
-
-//==============================================================================
-FXChain::FXChain()
-{
-    // In your constructor, you should add any child components, and
-    // initialise any special settings that your component needs.
-
-
-    
-}
-
-FXChain::~FXChain()
-{
-}
-
-
-FXChain::init()
-{
-    filterL.reset();
-    filterR.reset();
-}
-
-FXChain:processSamples (float *samplesL,float *samplesR,int numSamples)
-{
-    
-    filterL.processSamples (float *samplesL, int numSamples);
-    filterR.processSamples (float *samplesR, int numSamples);
-       
-}
+/*
+  ==============================================================================
+
+    FXChain.cpp
+    Created: 2 Mar 2017 9:41:35pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "FXChain.h"
+
+//==============================================================================
+BiquadCascade::BiquadCascade()
+:   numStages (0),
+    maxBlockSize (0),
+    interleaved (nullptr)
+{
+    for (int s = 0; s < maxStages; ++s)
+        setCoefficients (s, IIRCoefficients (1, 0, 0, 1, 0, 0));
+
+    reset();
+}
+
+void BiquadCascade::prepare (int maximumBlockSize)
+{
+    maxBlockSize = maximumBlockSize;
+
+    // one extra register so the interleaved data can start on a SIMD boundary
+    interleavedMemory.calloc ((size_t) ((maxBlockSize + 1) * numLanes));
+    interleaved = Vec::getNextSIMDAlignedPtr (interleavedMemory.get());
+
+    reset();
+}
+
+void BiquadCascade::reset() noexcept
+{
+    zeromem (state, sizeof (state));
+}
+
+void BiquadCascade::setNumStages (int newNumStages) noexcept
+{
+    jassert (newNumStages >= 0 && newNumStages <= maxStages);
+    numStages = jlimit (0, (int) maxStages, newNumStages);
+}
+
+void BiquadCascade::setCoefficients (int stage, const IIRCoefficients& c) noexcept
+{
+    jassert (isPositiveAndBelow (stage, (int) maxStages));
+
+    for (int i = 0; i < 5; ++i)
+        coefs[stage][i] = c.coefficients[i];
+}
+
+void BiquadCascade::process (AudioSampleBuffer& buffer, int startSample, int numSamples, int numChannels) noexcept
+{
+    numChannels = jmin (numChannels, buffer.getNumChannels(), (int) numLanes);
+
+    jassert (numSamples <= maxBlockSize);
+
+    if (numStages == 0 || numChannels == 0 || interleaved == nullptr)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* src = buffer.getReadPointer (ch, startSample);
+
+        for (int i = 0; i < numSamples; ++i)
+            interleaved[i * numLanes + ch] = src[i];
+    }
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        const Vec b0 = Vec::expand (coefs[s][0]);
+        const Vec b1 = Vec::expand (coefs[s][1]);
+        const Vec b2 = Vec::expand (coefs[s][2]);
+        const Vec a1 = Vec::expand (coefs[s][3]);
+        const Vec a2 = Vec::expand (coefs[s][4]);
+
+        Vec z1 = Vec::expand (0.0f);
+        Vec z2 = Vec::expand (0.0f);
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            z1.set (lane, state[s][0][lane]);
+            z2.set (lane, state[s][1][lane]);
+        }
+
+        float* data = interleaved;
+
+        for (int i = 0; i < numSamples; ++i, data += numLanes)
+        {
+            const Vec x = Vec::fromRawArray (data);
+            const Vec y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            y.copyToRawArray (data);
+        }
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            state[s][0][lane] = z1.get (lane);
+            state[s][1][lane] = z2.get (lane);
+        }
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* dest = buffer.getWritePointer (ch, startSample);
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = interleaved[i * numLanes + ch];
+    }
+}
+
+
+//==============================================================================
+FXChain::Settings::Settings()
+:   numBands (0),
+    driveDb (0.0f),
+    outputGainDb (0.0f)
+{
+    for (int i = 0; i < numStageTypes; ++i)
+    {
+        order[i] = i;
+        enabled[i] = (i == gainStage);
+    }
+
+    for (int i = 0; i < BiquadCascade::maxStages; ++i)
+    {
+        bands[i].type = peak;
+        bands[i].frequency = 1000.0f;
+        bands[i].q = 0.707f;
+        bands[i].gainDb = 0.0f;
+    }
+}
+
+//==============================================================================
+FXChain::FXChain()
+:   sampleRate (44100.0),
+    maxBlockSize (0),
+    drive (1.0f),
+    makeUp (1.0f),
+    lastProcessingTime (0.0),
+    maxProcessingTime (0.0),
+    timed (true)
+{
+    applySettings (currentSettings);
+}
+
+FXChain::~FXChain()
+{
+}
+
+void FXChain::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = jmax (1, maximumBlockSize);
+
+    eq.prepare (maxBlockSize);
+    outputGain.reset (sampleRate, 0.02);
+
+    // the snapshot processBlock() reads: currentSettings belongs to the message thread
+    pendingSettings.update();
+    const Settings& settings = pendingSettings.read();
+    applySettings (settings);
+    outputGain.setCurrentAndTargetValue (Decibels::decibelsToGain (settings.outputGainDb));
+    reset();
+}
+
+void FXChain::reset() noexcept
+{
+    eq.reset();
+}
+
+void FXChain::setSettings (const Settings& newSettings)
+{
+    currentSettings = newSettings;
+    pendingSettings.write (newSettings);
+}
+
+void FXChain::applySettings (const Settings& s) noexcept
+{
+    bool used[numStageTypes] = {};
+
+    for (int i = 0; i < numStageTypes; ++i)
+    {
+        // an order that names the same stage twice falls back to the default one
+        const int stage = s.order[i];
+
+        if (! isPositiveAndBelow (stage, (int) numStageTypes) || used[stage])
+        {
+            for (int j = 0; j < numStageTypes; ++j)
+                order[j] = j;
+            break;
+        }
+
+        used[stage] = true;
+        order[i] = stage;
+    }
+
+    for (int i = 0; i < numStageTypes; ++i)
+        enabled[i] = s.enabled[i];
+
+    const int numBands = jlimit (0, (int) BiquadCascade::maxStages, s.numBands);
+    const float nyquistLimit = (float) (sampleRate * 0.45);
+
+    for (int i = 0; i < numBands; ++i)
+    {
+        const Band& band = s.bands[i];
+        const double frequency = jlimit (10.0f, nyquistLimit, band.frequency);
+        const double q = jmax (0.1f, band.q);
+        const float gain = Decibels::decibelsToGain (band.gainDb);
+
+        IIRCoefficients coef;
+
+        switch (band.type)
+        {
+            case lowPass:   coef = IIRCoefficients::makeLowPass (sampleRate, frequency, q); break;
+            case highPass:  coef = IIRCoefficients::makeHighPass (sampleRate, frequency, q); break;
+            case bandPass:  coef = IIRCoefficients::makeBandPass (sampleRate, frequency, q); break;
+            case lowShelf:  coef = IIRCoefficients::makeLowShelf (sampleRate, frequency, q, gain); break;
+            case highShelf: coef = IIRCoefficients::makeHighShelf (sampleRate, frequency, q, gain); break;
+            case peak:
+            default:        coef = IIRCoefficients::makePeakFilter (sampleRate, frequency, q, gain); break;
+        }
+
+        eq.setCoefficients (i, coef);
+    }
+
+    eq.setNumStages (numBands);
+
+    drive = Decibels::decibelsToGain (s.driveDb);
+    makeUp = 1.0f / drive;
+
+    outputGain.setTargetValue (Decibels::decibelsToGain (s.outputGainDb));
+}
+
+void FXChain::processBlock (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    const int64 startTicks = timed ? Time::getHighResolutionTicks() : 0;
+
+    if (pendingSettings.update())
+        applySettings (pendingSettings.read());
+
+    // the device may hand us more than it announced, so never go past the scratch size
+    while (numSamples > 0)
+    {
+        const int numThisTime = jmin (numSamples, maxBlockSize);
+        processChunk (buffer, startSample, numThisTime);
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+
+    if (! timed)
+        return;
+
+    const double elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+    lastProcessingTime = elapsed;
+
+    if (elapsed > maxProcessingTime.load())
+        maxProcessingTime = elapsed;
+}
+
+void FXChain::processChunk (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    for (int i = 0; i < numStageTypes; ++i)
+    {
+        const int stage = order[i];
+
+        if (! enabled[stage])
+            continue;
+
+        switch (stage)
+        {
+            case eqStage:           eq.process (buffer, startSample, numSamples, 2); break;
+            case saturatorStage:    processSaturator (buffer, startSample, numSamples); break;
+            case gainStage:         processGain (buffer, startSample, numSamples); break;
+            default:                break;
+        }
+    }
+}
+
+void FXChain::processSaturator (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    const int numChannels = jmin (2, buffer.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = buffer.getWritePointer (ch, startSample);
+
+        FloatVectorOperations::multiply (data, drive, numSamples);
+        FloatVectorOperations::clip (data, data, -3.0f, 3.0f, numSamples);
+
+        // rational tanh approximation, reaches +/-1 at +/-3 with a zero slope
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = data[i];
+            const float x2 = x * x;
+            data[i] = x * (27.0f + x2) / (27.0f + 9.0f * x2);
+        }
+
+        FloatVectorOperations::multiply (data, makeUp, numSamples);
+    }
+}
+
+void FXChain::processGain (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    const int numChannels = jmin (2, buffer.getNumChannels());
+
+    if (outputGain.isSmoothing())
+    {
+        const float startGain = outputGain.getCurrentValue();
+        const float endGain = outputGain.skip (numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.applyGainRamp (ch, startSample, numSamples, startGain, endGain);
+    }
+    else
+    {
+        const float gain = outputGain.getTargetValue();
+
+        if (gain != 1.0f)
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.applyGain (ch, startSample, numSamples, gain);
+    }
+}
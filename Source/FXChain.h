@@ -1,38 +1,161 @@
-/*
-  ==============================================================================
-
-    FXChain.h
-    Created: 2 Mar 2017 9:41:35pm
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-#ifndef FXCHAIN_H_INCLUDED
-#define FXCHAIN_H_INCLUDED
-
-#include "../JuceLibraryCode/JuceHeader.h"
-
-//==============================================================================
-/*
-*/
-class FXChain    : public Component
-{
-public:
-    FXChain();
-    ~FXChain();
-    
-    init();
-    processSamples (float *samplesL,float *samplesR,int numSamples);
-
- 
-private:
-    IIRFilter filterL, filterR;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FXChain)
-};
-
-
-
-
-#endif  // FXCHAIN_H_INCLUDED
+/*
+  ==============================================================================
+
+    FXChain.h
+    Created: 2 Mar 2017 9:41:35pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef FXCHAIN_H_INCLUDED
+#define FXCHAIN_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ A cascade of biquads running the left and right channels side by side in the
+ lanes of one SIMD register (transposed direct form II).
+
+ All the state lives in fixed-size arrays, so nothing is allocated after
+ prepare().
+ */
+class BiquadCascade
+{
+public:
+    enum { maxStages = 4 };
+
+    BiquadCascade();
+
+    void prepare (int maximumBlockSize);
+    void reset() noexcept;
+
+    void setNumStages (int newNumStages) noexcept;
+    int getNumStages() const noexcept                       { return numStages; }
+    void setCoefficients (int stage, const IIRCoefficients& coefficients) noexcept;
+
+    /** Filters the first numChannels channels of the buffer in place (at most getMaxChannels()). */
+    void process (AudioSampleBuffer& buffer, int startSample, int numSamples, int numChannels) noexcept;
+
+    static int getMaxChannels() noexcept                    { return (int) dsp::SIMDRegister<float>::SIMDNumElements; }
+
+private:
+    typedef dsp::SIMDRegister<float> Vec;
+    enum { numLanes = Vec::SIMDNumElements };
+
+    float coefs[maxStages][5];
+    float state[maxStages][2][numLanes];
+    int numStages, maxBlockSize;
+
+    HeapBlock<float> interleavedMemory;
+    float* interleaved;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadCascade)
+};
+
+
+//==============================================================================
+/**
+ Master-bus processor run by the audio callback after the synth has rendered.
+
+ The chain is made of an EQ (BiquadCascade), a soft saturator and an output
+ gain. Every stage is allocated up-front and can be re-ordered or bypassed from
+ the message thread with setSettings(); the audio thread picks the new settings
+ up at the start of its next block without taking any lock.
+
+ The time spent in processBlock() is measured on every call, see
+ getLastProcessingTimeMicros() and getMaxProcessingTimeMicros(), unless
+ setTimed (false) was called: BusMixer times all its inserts at once instead.
+ */
+class FXChain
+{
+public:
+    enum StageType
+    {
+        eqStage = 0,
+        saturatorStage,
+        gainStage,
+        numStageTypes
+    };
+
+    enum BandType
+    {
+        lowPass = 1,
+        highPass,
+        bandPass,
+        peak,
+        lowShelf,
+        highShelf
+    };
+
+    struct Band
+    {
+        int type;
+        float frequency, q, gainDb;
+    };
+
+    struct Settings
+    {
+        Settings();
+
+        int order[numStageTypes];
+        bool enabled[numStageTypes];
+
+        Band bands[BiquadCascade::maxStages];
+        int numBands;
+
+        float driveDb;
+        float outputGainDb;
+    };
+
+    FXChain();
+    ~FXChain();
+
+    /** Allocates everything the chain needs. Call while the audio device is stopped. */
+    void prepare (double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    void processBlock (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept;
+
+    /** Message thread only. The new settings are applied at the start of the next block. */
+    void setSettings (const Settings& newSettings);
+    const Settings& getSettings() const noexcept            { return currentSettings; }
+
+    double getLastProcessingTimeMicros() const noexcept     { return lastProcessingTime.load(); }
+    double getMaxProcessingTimeMicros() const noexcept      { return maxProcessingTime.load(); }
+    void resetProcessingTime() noexcept                     { maxProcessingTime = 0.0; }
+
+    /** Call while the audio device is stopped. */
+    void setTimed (bool shouldBeTimed) noexcept             { timed = shouldBeTimed; }
+
+private:
+    void applySettings (const Settings&) noexcept;
+    void processChunk (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    void processSaturator (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    void processGain (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+
+    double sampleRate;
+    int maxBlockSize;
+
+    BiquadCascade eq;
+    float drive, makeUp;
+    LinearSmoothedValue<float> outputGain;
+    int order[numStageTypes];
+    bool enabled[numStageTypes];
+
+    Settings currentSettings;
+    TripleBuffer<Settings> pendingSettings;
+
+    std::atomic<double> lastProcessingTime, maxProcessingTime;
+    bool timed;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FXChain)
+};
+
+
+
+
+#endif  // FXCHAIN_H_INCLUDED
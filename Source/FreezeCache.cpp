@@ -0,0 +1,371 @@
+/*
+  ==============================================================================
+
+    FreezeCache.cpp
+    Created: 19 Oct 2026 4:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "FreezeCache.h"
+#include "Trace.h"
+
+//==============================================================================
+FreezeCache::Slot::Slot()
+:   frozen (nullptr),
+    triggers (0),
+    version (-1),
+    outputSampleRate (0.0),
+    changedAt (0),
+    queued (false),
+    rejected (false)
+{
+}
+
+//==============================================================================
+FreezeCache::FreezeCache (Synthesiser& synthToWatch)
+:   Thread ("Freeze renderer"),
+    synth (synthToWatch),
+    enabled (true),
+    memoryLimit (64 * 1024 * 1024),
+    bytesUsed (0),
+    stableTime (2000),
+    numRenders (0),
+    numEvictions (0),
+    tickCount (0),
+    hits (0),
+    misses (0)
+{
+    startThread (3);
+    startTimer (250);
+}
+
+FreezeCache::~FreezeCache()
+{
+    stopTimer();
+    stopThread (4000);
+}
+
+void FreezeCache::setEnabled (bool shouldBeEnabled)
+{
+    const ScopedLock sl (lock);
+    enabled = shouldBeEnabled;
+
+    if (! enabled)
+        for (int i = 0; i < maxPads; ++i)
+            drop (slots[i]);
+}
+
+void FreezeCache::setMemoryLimit (size_t numBytes)
+{
+    const ScopedLock sl (lock);
+    memoryLimit = numBytes;
+
+    for (int i = 0; i < maxPads && bytesUsed > memoryLimit; ++i)
+        if (slots[i].holder != nullptr)
+        {
+            drop (slots[i]);
+            ++numEvictions;
+        }
+}
+
+void FreezeCache::setStableTime (int milliseconds)
+{
+    const ScopedLock sl (lock);
+    stableTime = jmax (0, milliseconds);
+}
+
+//==============================================================================
+SampleBuffer::Ptr FreezeCache::getFrozen (const CustomSamplerSound& sound, double outputSampleRate) noexcept
+{
+    if (! isPositiveAndBelow (sound.pad_index, (int) maxPads))
+        return nullptr;
+
+    Slot& slot = slots[sound.pad_index];
+    ++slot.triggers;
+
+    SampleBuffer* frozen = slot.frozen.load();
+
+    if (frozen != nullptr
+         && frozen->getVersion() == sound.getParamsVersion()
+         && frozen->getSampleRate() == outputSampleRate)
+    {
+        ++hits;
+        return frozen;
+    }
+
+    ++misses;
+    return nullptr;
+}
+
+FreezeCache::Stats FreezeCache::getStats() const
+{
+    const ScopedLock sl (lock);
+
+    Stats stats;
+    stats.hits = hits.load();
+    stats.misses = misses.load();
+    stats.numFrozen = 0;
+    stats.numRenders = numRenders;
+    stats.numEvictions = numEvictions;
+    stats.bytesUsed = bytesUsed;
+    stats.memoryLimit = memoryLimit;
+
+    for (int i = 0; i < maxPads; ++i)
+        if (slots[i].holder != nullptr)
+            ++stats.numFrozen;
+
+    return stats;
+}
+
+String FreezeCache::getStatusText() const
+{
+    const Stats stats (getStats());
+    const int64 total = stats.hits + stats.misses;
+
+    return String::formatted ("Freeze: %d pads, %.1f / %.0f MB, hit rate %d%% (%d / %d), %d evicted",
+                              stats.numFrozen,
+                              stats.bytesUsed / (1024.0 * 1024.0),
+                              stats.memoryLimit / (1024.0 * 1024.0),
+                              total > 0 ? (int) (100 * stats.hits / total) : 0,
+                              (int) stats.hits, (int) total,
+                              stats.numEvictions);
+}
+
+//==============================================================================
+void FreezeCache::timerCallback()
+{
+    const uint32 now = Time::getMillisecondCounter();
+    const double outputSampleRate = synth.getSampleRate();
+    bool hasWork = false;
+
+    const ScopedLock sl (lock);
+
+    // the play counts decay by half every second or so, for the eviction order
+    const bool decay = (++tickCount % 4) == 0;
+
+    for (int i = 0; i < synth.getNumSounds(); ++i)
+    {
+        CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (synth.getSound (i).get());
+
+        if (sound == nullptr || ! isPositiveAndBelow (sound->pad_index, (int) maxPads))
+            continue;
+
+        Slot& slot = slots[sound->pad_index];
+
+        if (decay)
+            slot.triggers = slot.triggers.load() / 2;
+
+        const int version = sound->getParamsVersion();
+
+        if (version != slot.version || outputSampleRate != slot.outputSampleRate)
+        {
+            drop (slot);
+            slot.version = version;
+            slot.outputSampleRate = outputSampleRate;
+            slot.changedAt = now;
+            slot.rejected = false;
+            continue;
+        }
+
+        if (! enabled || outputSampleRate <= 0 || slot.holder != nullptr || slot.queued || slot.rejected
+             || now - slot.changedAt < (uint32) stableTime)
+            continue;
+
+        Job& job = slot.job;
+        job.source = sound->getSampleData();
+        job.outputSampleRate = outputSampleRate;
+        job.version = version;
+        job.detune = sound->detune;
+        job.filterType = sound->filter_type;
+        job.filterActive = sound->filter_active != 0;
+        job.filterCutoff = sound->filter_cutoff;
+        job.sampleStart = sound->sample_start;
+        job.sampleEnd = sound->sample_end;
+        job.attackTime = sound->getAttackTime();
+
+        slot.queued = true;
+        hasWork = true;
+    }
+
+    if (hasWork)
+        notify();
+}
+
+void FreezeCache::run()
+{
+    TRACE_THREAD_NAME ("freeze renderer");
+
+    while (! threadShouldExit())
+    {
+        int slotIndex = -1;
+        Job job;
+
+        {
+            const ScopedLock sl (lock);
+
+            for (int i = 0; i < maxPads && slotIndex < 0; ++i)
+                if (slots[i].queued)
+                {
+                    slotIndex = i;
+                    job = slots[i].job;
+                }
+        }
+
+        if (slotIndex < 0)
+        {
+            wait (-1);
+            continue;
+        }
+
+        SampleBuffer::Ptr rendered;
+
+        {
+            TRACE_SCOPE ("freeze render");
+            rendered = render (job);
+        }
+
+        const ScopedLock sl (lock);
+        Slot& slot = slots[slotIndex];
+        slot.queued = false;
+        slot.job.source = nullptr;
+
+        // the settings may have moved on while we were rendering
+        if (rendered == nullptr || ! enabled || slot.version != job.version || slot.outputSampleRate != job.outputSampleRate)
+            continue;
+
+        if (! makeRoom (slotIndex, rendered->getSizeInBytes()))
+        {
+            slot.rejected = true;
+            continue;
+        }
+
+        releasePool->add (rendered.get());
+        slot.holder = rendered;
+        slot.frozen = rendered.get();
+        bytesUsed += rendered->getSizeInBytes();
+        ++numRenders;
+    }
+}
+
+void FreezeCache::drop (Slot& slot)
+{
+    if (slot.holder == nullptr)
+        return;
+
+    // the voices still playing it keep it alive, the release pool frees it later
+    slot.frozen = nullptr;
+    bytesUsed -= slot.holder->getSizeInBytes();
+    slot.holder = nullptr;
+}
+
+bool FreezeCache::makeRoom (int slotIndex, size_t numBytes)
+{
+    if (numBytes > memoryLimit)
+        return false;
+
+    while (bytesUsed + numBytes > memoryLimit)
+    {
+        int victim = -1;
+
+        for (int i = 0; i < maxPads; ++i)
+            if (i != slotIndex && slots[i].holder != nullptr
+                 && slots[i].triggers.load() <= slots[slotIndex].triggers.load()
+                 && (victim < 0 || slots[i].triggers.load() < slots[victim].triggers.load()))
+                victim = i;
+
+        if (victim < 0)
+            return false;
+
+        drop (slots[victim]);
+        ++numEvictions;
+    }
+
+    return true;
+}
+
+//==============================================================================
+/*  Same signal path as CustomSamplerVoice::renderNextBlock() with a unit
+    velocity and no release, so that frozen and live hits sound the same.
+ */
+SampleBuffer* FreezeCache::render (const Job& job)
+{
+    if (job.source == nullptr || job.outputSampleRate <= 0)
+        return nullptr;
+
+    const SampleBuffer& source = *job.source;
+    const double sourceRate = source.getSampleRate();
+    const double pitchRatio = std::pow (2.0, job.detune / 12.0) * sourceRate / job.outputSampleRate;
+    const double startPosition = job.sampleStart * source.getLength();
+    const double endPosition = job.sampleEnd * source.getLength();
+
+    if (source.getLength() == 0 || pitchRatio <= 0)
+        return nullptr;
+
+    // count the output samples with the same accumulation as the voice
+    int numSamples = 0;
+
+    for (double position = startPosition; ;)
+    {
+        ++numSamples;
+        position += pitchRatio;
+
+        if (position > endPosition)
+            break;
+    }
+
+    const int numChannels = source.getNumChannels();
+    SampleBuffer* result = new SampleBuffer (numChannels, numSamples, job.outputSampleRate, job.version);
+
+    IIRFilter filterL, filterR;
+    const IIRCoefficients coef = CustomSamplerSound::makeFilterCoefficients (job.filterType, job.filterActive, job.filterCutoff, sourceRate);
+    filterL.setCoefficients (coef);
+    filterR.setCoefficients (coef);
+
+    const int attackSamples = roundToInt (job.attackTime * sourceRate);
+    bool isInAttack = attackSamples > 0;
+    float attackLevel = isInAttack ? 0.0f : 1.0f;
+    const float attackDelta = isInAttack ? (float) (pitchRatio / attackSamples) : 0.0f;
+
+    const float* const inL = source.getBuffer().getReadPointer (0);
+    const float* const inR = numChannels > 1 ? source.getBuffer().getReadPointer (1) : nullptr;
+    float* const outL = result->getBuffer().getWritePointer (0);
+    float* const outR = numChannels > 1 ? result->getBuffer().getWritePointer (1) : nullptr;
+
+    double position = startPosition;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int pos = (int) position;
+        const float alpha = (float) (position - pos);
+        const float invAlpha = 1.0f - alpha;
+
+        float l = inL[pos] * invAlpha + inL[pos + 1] * alpha;
+        float r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha) : l;
+
+        if (isInAttack)
+        {
+            l *= attackLevel;
+            r *= attackLevel;
+
+            attackLevel += attackDelta;
+
+            if (attackLevel >= 1.0f)
+            {
+                attackLevel = 1.0f;
+                isInAttack = false;
+            }
+        }
+
+        outL[i] = filterL.processSingleSampleRaw (l);
+
+        if (outR != nullptr)
+            outR[i] = filterR.processSingleSampleRaw (r);
+
+        position += pitchRatio;
+    }
+
+    return result;
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    FreezeCache.h
+    Created: 19 Oct 2026 4:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef FREEZECACHE_H_INCLUDED
+#define FREEZECACHE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "CustomSampler.h"
+#include "SampleBuffer.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ Pre-renders ("freezes") the processed one-shot of pads whose settings have not
+ changed for a while, so that their hits can be played as a plain copy.
+
+ A frozen render has the pitch, the filter, the start/end trim and the attack
+ applied; the voices only multiply it by the velocity (and by the release ramp
+ after a note-off). It is tagged with the parameter version of the sound and
+ the output sample rate, so a render that no longer matches is never played.
+
+ The message thread watches the sounds and queues the renders, a background
+ thread does them. The total size of the renders is capped: when a new one does
+ not fit, the least played pads are dropped first.
+ */
+class FreezeCache   : private Timer,
+                      private Thread
+{
+public:
+    enum { maxPads = 32 };
+
+    struct Stats
+    {
+        int64 hits, misses;
+        int numFrozen, numRenders, numEvictions;
+        size_t bytesUsed, memoryLimit;
+    };
+
+    FreezeCache (Synthesiser& synthToWatch);
+    ~FreezeCache();
+
+    /** Message thread only. */
+    void setEnabled (bool shouldBeEnabled);
+    bool isEnabled() const noexcept                     { return enabled; }
+
+    void setMemoryLimit (size_t numBytes);
+    void setStableTime (int milliseconds);
+
+    /** Audio thread: the frozen render to play for a hit on this sound, or nullptr. */
+    SampleBuffer::Ptr getFrozen (const CustomSamplerSound& sound, double outputSampleRate) noexcept;
+
+    Stats getStats() const;
+    String getStatusText() const;
+
+private:
+    struct Job
+    {
+        SampleBuffer::Ptr source;
+        double outputSampleRate;
+        int version, detune, filterType;
+        bool filterActive;
+        float filterCutoff, sampleStart, sampleEnd;
+        double attackTime;
+    };
+
+    struct Slot
+    {
+        Slot();
+
+        std::atomic<SampleBuffer*> frozen;
+        std::atomic<int> triggers;
+
+        SampleBuffer::Ptr holder;
+        int version;
+        double outputSampleRate;
+        uint32 changedAt;
+        bool queued, rejected;
+        Job job;
+    };
+
+    void timerCallback() override;
+    void run() override;
+
+    void drop (Slot&);
+    bool makeRoom (int slotIndex, size_t numBytes);
+    static SampleBuffer* render (const Job&);
+
+    Synthesiser& synth;
+    Slot slots[maxPads];
+
+    CriticalSection lock;
+    bool enabled;
+    size_t memoryLimit, bytesUsed;
+    int stableTime, numRenders, numEvictions, tickCount;
+
+    std::atomic<int64> hits, misses;
+
+    SharedResourcePointer<ReleasePool> releasePool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FreezeCache)
+};
+
+
+#endif  // FREEZECACHE_H_INCLUDED
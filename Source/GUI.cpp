@@ -1,289 +1,888 @@
-/*
-  ==============================================================================
-
-    GUI.cpp
-    Created: 28 Feb 2017 9:32:16am
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "GUI.h"
-#include "DrumSynthesiser.h"
-
-//==============================================================================
-
-CustomSlider::CustomSlider(const String& componentName,const String& suffix,int x,int y,bool textbox)
-{
-    slider.setBounds (x+80,y,250,24);
-    slider.setTextValueSuffix (suffix);
-    if (textbox==true)
-    {
-        slider.setTextBoxStyle (Slider::TextBoxRight, true,80,24);
-        slider.setColour(Slider::textBoxOutlineColourId,Colour(0));
-        slider.setColour(Slider::textBoxTextColourId,Colour(24,30,35));
-    }
-    else
-    {
-        slider.setTextBoxStyle (Slider::NoTextBox, true,80,24);
-    }
-    sliderlabel.setText(componentName, dontSendNotification);
-    sliderlabel.attachToComponent (&slider, true);
-    sliderlabel.setColour(Label::textColourId, Colour(24,30,35));
-    slider.setColour(Slider::thumbColourId,Colour(255,201,7));
-   
-}
-
-
-CustomToggleButton::CustomToggleButton(const String& componentName,const String& suffix,int x,int y)
-{
-    button.setBounds (x+80,y,250,24);
-    buttonlabel.setText(componentName, dontSendNotification);
-    buttonlabel.attachToComponent (&button, true);
-    buttonlabel.setColour(Label::textColourId, Colour(24,30,35));
-}
-
-CustomComboBox::CustomComboBox(const String& componentName,const String& suffix,int x,int y)
-{
-    comboBox.setBounds (x+80,y,250,24);
-    comboBoxlabel.setText(componentName, dontSendNotification);
-    comboBoxlabel.attachToComponent (&comboBox, true);
-    comboBoxlabel.setColour(Label::textColourId, Colour(24,30,35));
-}
-
-
-SamplerPage::SamplerPage(DrumSynthesiser& synth_,CustomMidiKeyboardComponent *keyboardComponent_)
-:   synth(synth_),
-    keyboardComponent(keyboardComponent_),
-    dialp("Pitch","",420,210,true),
-    samplecomboBox("Sample","",420,180),
-    bankcomboBox("Bank","",420,150),
-    filter_comboBox("Filter","",420,300),
-    filter_button("Type","",420,270),
-    filter_dialf("Frequency","Hz",420,330,true),
-    filter_dialr("Res","dB",420,360,true)
-{
-    
-    nb_samples=BinaryData::namedResourceListSize;
-
-    
-    //synth.addListener(this);
-    
-    //add bank combo box items
-    for (int indice=0;indice<16;indice++)
-    {
-        bankcomboBox.comboBox.addItem ("Slot"+String(indice), indice+1);
-    }
-    
-    //add filter combo box items
-    filter_comboBox.comboBox.addItem ("Lowpass", 1);
-    filter_comboBox.comboBox.addItem ("Highpass", 2);
-    filter_comboBox.comboBox.addItem ("Bandpass", 3);
-    
-    //add sample combo box items
-    for (int indice=0;indice<nb_samples;indice++)
-    {
-        samplecomboBox.comboBox.addItem (BinaryData::namedResourceList[indice], indice+1);
-    }
-    
-    addAndMakeVisible (bankcomboBox.comboBox);
-    addAndMakeVisible(bankcomboBox.comboBoxlabel);
-    bankcomboBox.comboBox.addListener(this);
-    
-    addAndMakeVisible (samplecomboBox.comboBox);
-    addAndMakeVisible(samplecomboBox.comboBoxlabel);
-    samplecomboBox.comboBox.addListener(this);
-    
-    dialp.slider.setRange (-24, 24);
-    addAndMakeVisible (dialp.slider);
-    addAndMakeVisible(dialp.sliderlabel);
-    dialp.slider.addListener(this);
-    
-    slider_ss.setLookAndFeel (&otherLookAndFeel);
-    slider_ss.setBounds(0, 18, 782, 100);
-    slider_ss.setSliderStyle(Slider::TwoValueHorizontal);
-    slider_ss.setRange(0.,1.,0.001);
-    slider_ss.setMaxValue(1.);
-    slider_ss.setTextBoxStyle (Slider::NoTextBox, true,80,24);
-    slider_ss.addListener(this);
-    addAndMakeVisible (slider_ss);
-    Logger::outputDebugString(String(getRight()));
-    
-    addAndMakeVisible (filter_button.button);
-    addAndMakeVisible (filter_button.buttonlabel);
-    filter_button.button.addListener(this);
-    
-    addAndMakeVisible (filter_comboBox.comboBox);
-    addAndMakeVisible(filter_comboBox.comboBoxlabel);
-    filter_comboBox.comboBox.addListener(this);
-    filter_dialf.slider.setRange (50, 20000);
-    
-    addAndMakeVisible (filter_dialf.slider);
-    addAndMakeVisible(filter_dialf.sliderlabel);
-    filter_dialf.slider.addListener(this);
-    
-    filter_dialr.slider.setRange (0.1, 10);
-    addAndMakeVisible(filter_dialr.slider);
-    addAndMakeVisible(filter_dialr.sliderlabel);
-    
-
-    addAndMakeVisible (keyboardComponent);
-    keyboardComponent->setAvailableRange(36,36+16);
-    
-    keyboardComponent->setBounds(8,150,300,300);
-    keyboardComponent->setKeyWidth();
-    
-    sampler_sound=nullptr;
-}
-void SamplerPage::start_timer()
-{
-    if (isTimerRunning ()==false)
-        {
-        startTimer (40);
-        }
-}
-void SamplerPage::stop_timer()
-{
-    stopTimer();
-}
-
-void SamplerPage::comboBoxChanged (ComboBox* combobox)
-{
-
-    if (combobox==&bankcomboBox.comboBox)
-    {
-        selected_slot=combobox->getSelectedId()-1;
-        CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synth.getSound(selected_slot).get()) };
-        sampler_sound = sound;
-        Logger::outputDebugString(sampler_sound->audioFile.getFullPathName());
-        samplecomboBox.comboBox.setSelectedItemIndex(sampler_sound->sample_index,dontSendNotification);
-        dialp.slider.setValue(sampler_sound->detune,dontSendNotification);
-        filter_button.button.setToggleState(sampler_sound->filter_active,dontSendNotification);
-        filter_dialf.slider.setValue(sampler_sound->filter_cutoff,dontSendNotification);
-        filter_comboBox.comboBox.setSelectedItemIndex(sampler_sound->filter_type-1,dontSendNotification);
-        slider_ss.setMinAndMaxValues(sampler_sound->sample_start,sampler_sound->sample_end );
-        repaint();
-    }
-    
-    
-    if (combobox == &samplecomboBox.comboBox)
-        {
-        int selected_sample=combobox->getSelectedId()-1;
-
-        String filename=String::formatted ("kit%d/mysample%d.aif",synth.num_kit,selected_sample+1);
-        File audioFile = File::getSpecialLocation (File::userApplicationDataDirectory).getChildFile (filename);
-            
-        CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synth.getSound(selected_slot).get()) };
-        sampler_sound = sound;
-        sampler_sound->sample_index=selected_sample+1;
-        sampler_sound->audioFile=audioFile;
-        sampler_sound->loadSound();
-            
-        repaint();
-        }
-    
-    if (combobox == &filter_comboBox.comboBox)
-    {
-        int type=combobox->getSelectedId();
-        sampler_sound->filter_type=type;
-    }
-    
-
-}
-
-void SamplerPage::sliderValueChanged (Slider* slider)
-{
-    if (sampler_sound != NULL)
-    {
-
-    if (slider == &dialp.slider)
-    {
-        sampler_sound->detune=slider->getValue();
-    }
-    if  (slider == &filter_dialf.slider)
-    {
-        sampler_sound->filter_cutoff=slider->getValue();
-    }
-    if ( slider == &slider_ss)
-    {
-        sampler_sound->sample_start=slider->getMinValueObject().getValue();
-        sampler_sound->sample_end=slider->getMaxValueObject().getValue();
-        repaint();
-    }
-    }
-
-    
-}
-
-
-void SamplerPage::buttonStateChanged(Button* button)
-{
-
-}
-
-void SamplerPage::buttonClicked(Button* button)
-{
-    if (button == &filter_button.button)
-    {
-        int value=button->getToggleStateValue().getValue();
-        sampler_sound->filter_active=value;
-    }
-
-}
-
-
-
-
-void SamplerPage::paint (Graphics& g)
-{
-        const Rectangle<int> thumbnailBounds (8,18, getWidth() - 16, 100);
-        Colour wav_back_colour=Colour(24,30,35);
-        Colour wav_colour=Colour(255,201,7);
-        Colour wav_tick=Colour(255,101,0);
-        Colour wav_separator=Colour(255,50,0);
-        Colour pad_off=Colour(110,110,110);
-    
-    
-        if (sampler_sound != NULL)
-        {
-    
-        if (sampler_sound->thumbnail.getNumChannels() != 0)
-        {
-            const double audioLength (sampler_sound->thumbnail.getTotalLength());
-            g.setColour (wav_back_colour);
-            g.fillRect (thumbnailBounds);
-            g.setColour (wav_colour);
-            sampler_sound->thumbnail.drawChannel (g,thumbnailBounds, 0.0,sampler_sound->thumbnail.getTotalLength(), 1,1.0f);
-            
-            const double audioPosition (synth.getCurrentPosition(sampler_sound->midiRootNote));
-            const float drawPosition ((audioPosition / audioLength) * thumbnailBounds.getWidth() + thumbnailBounds.getX());
-
-            if (audioPosition > 0)
-            {
-                g.setColour (wav_tick);
-                g.drawLine (drawPosition, thumbnailBounds.getY(), drawPosition,thumbnailBounds.getBottom(), 2.0f);
-            }
-            g.setColour (wav_separator);
-        }
-        }
-        else{
-            g.setColour (wav_back_colour);
-            g.fillRect (thumbnailBounds);
-            g.setColour (wav_colour);
-            g.drawFittedText ("No File Loaded", thumbnailBounds, Justification::centred, 1.0f);
-        }
-    
-
-}
-
-void SamplerPage::timerCallback()
-{
-    repaint();
-}
-
-
-
-
-
-
+/*
+  ==============================================================================
+
+    GUI.cpp
+    Created: 28 Feb 2017 9:32:16am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "GUI.h"
+#include "DrumSynthesiser.h"
+
+//==============================================================================
+
+CustomSlider::CustomSlider(const String& componentName,const String& suffix,int x,int y,bool textbox)
+{
+    slider.setBounds (x+80,y,250,24);
+    slider.setTextValueSuffix (suffix);
+    if (textbox==true)
+    {
+        slider.setTextBoxStyle (Slider::TextBoxRight, true,80,24);
+        slider.setColour(Slider::textBoxOutlineColourId,Colour(0));
+        slider.setColour(Slider::textBoxTextColourId,Colour(24,30,35));
+    }
+    else
+    {
+        slider.setTextBoxStyle (Slider::NoTextBox, true,80,24);
+    }
+    sliderlabel.setText(componentName, dontSendNotification);
+    sliderlabel.attachToComponent (&slider, true);
+    sliderlabel.setColour(Label::textColourId, Colour(24,30,35));
+    slider.setColour(Slider::thumbColourId,Colour(255,201,7));
+   
+}
+
+
+CustomToggleButton::CustomToggleButton(const String& componentName,const String& suffix,int x,int y)
+{
+    button.setBounds (x+80,y,250,24);
+    buttonlabel.setText(componentName, dontSendNotification);
+    buttonlabel.attachToComponent (&button, true);
+    buttonlabel.setColour(Label::textColourId, Colour(24,30,35));
+}
+
+CustomComboBox::CustomComboBox(const String& componentName,const String& suffix,int x,int y)
+{
+    comboBox.setBounds (x+80,y,250,24);
+    comboBoxlabel.setText(componentName, dontSendNotification);
+    comboBoxlabel.attachToComponent (&comboBox, true);
+    comboBoxlabel.setColour(Label::textColourId, Colour(24,30,35));
+}
+
+
+GainReductionMeter::GainReductionMeter(MasterDynamics& dynamics_)
+:dynamics(dynamics_),
+reductionDb(0.0f),
+clipHold(0)
+{
+    setOpaque(true);
+    startTimerHz(20);
+}
+
+void GainReductionMeter::paint (Graphics& g)
+{
+    const float range=12.0f;
+    const Rectangle<float> area (getLocalBounds().toFloat());
+    
+    g.fillAll (Colour(24,30,35));
+    g.setColour (Colour(255,201,7));
+    g.fillRect (area.withLeft (area.getRight() - area.getWidth() * jmin (1.0f, reductionDb / range)));
+    
+    g.setColour (clipHold > 0 ? Colours::red : Colour(141,141,141));
+    g.drawRect (area);
+    g.setFont (11.0f);
+    g.drawText (String::formatted ("GR %.1f dB", reductionDb), getLocalBounds().reduced (4, 0), Justification::centredLeft, false);
+}
+
+void GainReductionMeter::timerCallback()
+{
+    // the meter keeps the largest reduction seen since the last tick, and falls back slowly
+    const float newReduction = jmax (dynamics.getAndResetGainReductionDb(), reductionDb - 1.0f, 0.0f);
+    const int newClipHold = dynamics.getAndResetOutputPeak() > 1.0f ? 20 : jmax (0, clipHold - 1);
+    
+    if (newReduction != reductionDb || newClipHold != clipHold)
+    {
+        reductionDb = newReduction;
+        clipHold = newClipHold;
+        repaint();
+    }
+}
+
+LoadMeter::LoadMeter(SamplerEngine& engine_)
+:engine(engine_),
+previous(engine_.getTelemetrySnapshot()),
+totalXruns(0),
+alertHold(0)
+{
+    setOpaque(true);
+    startTimerHz(2);
+}
+
+void LoadMeter::paint (Graphics& g)
+{
+    const Rectangle<float> area (getLocalBounds().toFloat());
+    
+    g.fillAll (Colour(24,30,35));
+    g.setColour (Colour(255,201,7));
+    g.fillRect (area.withWidth (area.getWidth() * (float) jmin (1.0, period.getLoadPercent() / 100.0)));
+    
+    g.setColour (alertHold > 0 ? Colours::red : Colour(141,141,141));
+    g.drawRect (area);
+    g.setFont (11.0f);
+    g.drawText (String::formatted ("DSP %d%% (%d%%)  %d voices  %d xruns",
+                                   roundToInt (period.getLoadPercent()), roundToInt (period.maxLoadPercent),
+                                   period.activeVoices, (int) totalXruns),
+                getLocalBounds().reduced (4, 0), Justification::centredLeft, false);
+}
+
+void LoadMeter::timerCallback()
+{
+    const AudioTelemetry::Snapshot current (engine.getTelemetrySnapshot());
+    period = current.since (previous);
+    previous = current;
+    
+    // a late callback is what the user hears as a dropout, whoever caused it
+    const int64 newXruns = current.numOverruns + current.numLateCallbacks + jmax (0, current.deviceXruns);
+    alertHold = newXruns > totalXruns ? 10 : jmax (0, alertHold - 1);
+    totalXruns = newXruns;
+    
+    repaint();
+}
+
+
+//==============================================================================
+PlayheadOverlay::PlayheadOverlay()
+:position(-1.0f)
+{
+    setInterceptsMouseClicks(false,false);
+}
+
+void PlayheadOverlay::setPosition (float proportion)
+{
+    const int oldX = getLineX();
+    position = proportion;
+    const int newX = getLineX();
+    
+    if (newX == oldX)
+        return;
+    
+    if (oldX >= 0)
+        repaint(oldX-2,0,4,getHeight());
+    
+    if (newX >= 0)
+        repaint(newX-2,0,4,getHeight());
+}
+
+int PlayheadOverlay::getLineX() const
+{
+    return position < 0.0f ? -1 : roundToInt(position*getWidth());
+}
+
+void PlayheadOverlay::paint (Graphics& g)
+{
+    const int x = getLineX();
+    
+    if (x >= 0)
+    {
+        g.setColour (Colour(255,101,0));
+        g.drawLine ((float) x, 0.0f, (float) x, (float) getHeight(), 2.0f);
+    }
+}
+
+
+//==============================================================================
+SampleEditor::SampleEditor()
+:sound(nullptr),
+viewStart(0.0),
+samplesPerPixel(1.0),
+dragMode(notDragging),
+dragViewStart(0.0)
+{
+}
+
+void SampleEditor::setSound (CustomSamplerSound* sound_)
+{
+    const bool isNewSound = sound_ != sound;
+    sound = sound_;
+    
+    WaveformPyramid::Ptr newWaveform (sound != nullptr ? sound->getWaveform() : nullptr);
+    const bool isNewLength = newWaveform == nullptr || waveform == nullptr
+                              || newWaveform->getLength() != waveform->getLength();
+    waveform = newWaveform;
+    
+    // a new pad, or a sample of another length, is shown whole
+    if (isNewSound || isNewLength)
+        zoomToFit();
+    
+    image = Image();
+    repaint();
+}
+
+void SampleEditor::zoomToFit()
+{
+    setView (0.0, std::numeric_limits<double>::max());
+}
+
+void SampleEditor::setView (double newViewStart, double newSamplesPerPixel)
+{
+    const int length = waveform != nullptr ? waveform->getLength() : 0;
+    const int width = jmax (1, getWidth());
+    
+    samplesPerPixel = jlimit (1.0 / 16.0, jmax (1.0 / 16.0, length / (double) width), newSamplesPerPixel);
+    viewStart = jlimit (0.0, jmax (0.0, length - width * samplesPerPixel), newViewStart);
+    
+    image = Image();
+    repaint();
+}
+
+double SampleEditor::getSampleForX (float x) const
+{
+    return viewStart + x * samplesPerPixel;
+}
+
+float SampleEditor::getXForSample (double sample) const
+{
+    return (float) ((sample - viewStart) / samplesPerPixel);
+}
+
+int SampleEditor::getXForSeconds (double seconds) const
+{
+    if (waveform == nullptr)
+        return -1;
+    
+    const int x = roundToInt (getXForSample (seconds * waveform->getSampleRate()));
+    return isPositiveAndBelow (x, getWidth()) ? x : -1;
+}
+
+SampleEditor::DragMode SampleEditor::getMarkerAt (float x) const
+{
+    if (sound == nullptr || waveform == nullptr)
+        return notDragging;
+    
+    const float startX = getXForSample (sound->sample_start * waveform->getLength());
+    const float endX = getXForSample (sound->sample_end * waveform->getLength());
+    
+    if (std::abs (x - startX) <= 5.0f && std::abs (x - startX) <= std::abs (x - endX))
+        return draggingStart;
+    
+    if (std::abs (x - endX) <= 5.0f)
+        return draggingEnd;
+    
+    return notDragging;
+}
+
+void SampleEditor::resized()
+{
+    setView (viewStart, samplesPerPixel);
+}
+
+void SampleEditor::mouseMove (const MouseEvent& e)
+{
+    setMouseCursor (getMarkerAt (e.position.x) != notDragging ? MouseCursor::LeftRightResizeCursor
+                                                               : MouseCursor::NormalCursor);
+}
+
+void SampleEditor::mouseDown (const MouseEvent& e)
+{
+    dragMode = getMarkerAt (e.position.x);
+    
+    if (dragMode == notDragging)
+        dragMode = scrolling;
+    
+    dragViewStart = viewStart;
+    repaint();
+}
+
+void SampleEditor::mouseDrag (const MouseEvent& e)
+{
+    if (waveform == nullptr)
+        return;
+    
+    const int length = waveform->getLength();
+    
+    if (dragMode == scrolling)
+    {
+        setView (dragViewStart - e.getDistanceFromDragStartX() * samplesPerPixel, samplesPerPixel);
+        return;
+    }
+    
+    if (sound == nullptr || length == 0)
+        return;
+    
+    // markers sit on whole samples, and the end stays after the start
+    const int sample = jlimit (0, length, roundToInt (getSampleForX (e.position.x)));
+    
+    if (dragMode == draggingStart)
+        sound->sample_start = jmin (sample, roundToInt (sound->sample_end * length) - 1) / (float) length;
+    else if (dragMode == draggingEnd)
+        sound->sample_end = jmax (sample, roundToInt (sound->sample_start * length) + 1) / (float) length;
+    
+    sound->paramsChanged();
+    repaint();
+}
+
+void SampleEditor::mouseUp (const MouseEvent&)
+{
+    dragMode = notDragging;
+    repaint();
+}
+
+void SampleEditor::mouseDoubleClick (const MouseEvent&)
+{
+    zoomToFit();
+}
+
+void SampleEditor::mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel)
+{
+    if (wheel.deltaX != 0.0f)
+        setView (viewStart - wheel.deltaX * 256.0 * samplesPerPixel, samplesPerPixel);
+    
+    if (wheel.deltaY != 0.0f)
+    {
+        // the sample under the mouse stays under it
+        const double anchor = getSampleForX (e.position.x);
+        const double newSamplesPerPixel = samplesPerPixel * std::pow (2.0, -wheel.deltaY * 4.0);
+        setView (anchor - e.position.x * newSamplesPerPixel, newSamplesPerPixel);
+    }
+}
+
+void SampleEditor::renderImage()
+{
+    image = Image (Image::RGB, jmax (1, getWidth()), jmax (1, getHeight()), false);
+    
+    Graphics g (image);
+    g.fillAll (Colour(24,30,35));
+    
+    if (waveform == nullptr || waveform->getLength() == 0)
+        return;
+    
+    const Colour wav_colour=Colour(255,201,7);
+    const int length = waveform->getLength();
+    const int numChannels = waveform->getSource().getNumChannels();
+    const float middle = getHeight() * 0.5f;
+    const float scale = getHeight() * 0.5f;
+    
+    if (samplesPerPixel >= 1.0)
+    {
+        // one summary per column: the min/max line and, brighter, the RMS
+        for (int x = 0; x < image.getWidth(); ++x)
+        {
+            const int start = (int) getSampleForX ((float) x);
+            const int end = jmax (start + 1, (int) getSampleForX ((float) (x + 1)));
+            
+            if (start >= length)
+                break;
+            
+            WaveformPyramid::Summary column;
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const WaveformPyramid::Summary summary (waveform->getSummary (channel, start, end));
+                column.add (summary.minimum, summary.maximum, summary.sumOfSquares, summary.numSamples);
+            }
+            
+            if (column.numSamples == 0)
+                continue;
+            
+            const float top = jlimit (0.0f, (float) getHeight(), middle - column.maximum * scale);
+            const float bottom = jlimit (0.0f, (float) getHeight(), middle - column.minimum * scale);
+            const float rms = jmin (column.getRms(), 1.0f) * scale;
+            
+            g.setColour (wav_colour);
+            g.drawVerticalLine (x, top, jmax (bottom, top + 1.0f));
+            g.setColour (wav_colour.brighter (0.6f));
+            g.drawVerticalLine (x, jmax (top, middle - rms), jmin (jmax (bottom, top + 1.0f), middle + rms));
+        }
+    }
+    else
+    {
+        // fewer samples than pixels: the samples themselves, joined
+        const int first = jmax (0, (int) viewStart);
+        const int last = jmin (length - 1, (int) getSampleForX ((float) image.getWidth()) + 1);
+        const bool showDots = samplesPerPixel <= 1.0 / 6.0;
+        Path path;
+        
+        for (int i = first; i <= last; ++i)
+        {
+            float value = 0.0f;
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                value += waveform->getSource().getBuffer().getSample (channel, i);
+            
+            const float x = getXForSample (i);
+            const float y = middle - value / jmax (1, numChannels) * scale;
+            
+            if (i == first)
+                path.startNewSubPath (x, y);
+            else
+                path.lineTo (x, y);
+            
+            if (showDots)
+            {
+                g.setColour (wav_colour);
+                g.fillEllipse (x - 2.0f, y - 2.0f, 4.0f, 4.0f);
+            }
+        }
+        
+        g.setColour (wav_colour);
+        g.strokePath (path, PathStrokeType (1.5f));
+    }
+}
+
+void SampleEditor::paint (Graphics& g)
+{
+    if (sound == nullptr || waveform == nullptr)
+    {
+        g.fillAll (Colour(24,30,35));
+        g.setColour (Colour(255,201,7));
+        g.drawFittedText ("No File Loaded", getLocalBounds(), Justification::centred, 1);
+        return;
+    }
+    
+    // dragging a marker only repaints, the waveform comes from the cached image
+    if (image.isNull())
+        renderImage();
+    
+    g.drawImageAt (image, 0, 0);
+    
+    const int length = waveform->getLength();
+    const int startSample = roundToInt (sound->sample_start * length);
+    const int endSample = roundToInt (sound->sample_end * length);
+    const float startX = getXForSample (startSample);
+    const float endX = getXForSample (endSample);
+    
+    // what is not played is shaded
+    g.setColour (Colours::black.withAlpha (0.5f));
+    g.fillRect (Rectangle<float> (0.0f, 0.0f, jlimit (0.0f, (float) getWidth(), startX), (float) getHeight()));
+    g.fillRect (Rectangle<float> (jlimit (0.0f, (float) getWidth(), endX), 0.0f, (float) getWidth(), (float) getHeight()));
+    
+    const float markerX[] = { startX, endX };
+    const DragMode markerModes[] = { draggingStart, draggingEnd };
+    
+    for (int i = 0; i < 2; ++i)
+    {
+        g.setColour (dragMode == markerModes[i] ? Colour(255,101,0) : Colour(129,140,150));
+        g.drawLine (markerX[i], 0.0f, markerX[i], (float) getHeight(), 2.0f);
+        
+        Path pointer;
+        pointer.addTriangle (markerX[i] - 5.0f, 0.0f, markerX[i] + 5.0f, 0.0f, markerX[i], 7.0f);
+        g.fillPath (pointer);
+    }
+    
+    g.setColour (Colour(129,140,150));
+    g.setFont (11.0f);
+    g.drawText (String (startSample), 4, getHeight() - 14, 100, 12, Justification::left, false);
+    g.drawText (String (endSample), getWidth() - 104, getHeight() - 14, 100, 12, Justification::right, false);
+}
+
+
+//==============================================================================
+SamplerPage::SamplerPage(DrumSynthesiser& synth_,CustomMidiKeyboardComponent *keyboardComponent_)
+:   synth(synth_),
+    keyboardComponent(keyboardComponent_),
+    dialp("Pitch","",420,210,true),
+    samplecomboBox("Sample","",420,180),
+    bankcomboBox("Bank","",420,150),
+    filter_comboBox("Filter","",420,300),
+    filter_button("Type","",420,270),
+    filter_dialf("Frequency","Hz",420,330,true),
+    filter_dialr("Res","dB",420,360,true)
+{
+    
+    nb_samples=BinaryData::namedResourceListSize;
+
+    
+    //synth.addListener(this);
+    
+    //add bank combo box items
+    for (int indice=0;indice<16;indice++)
+    {
+        bankcomboBox.comboBox.addItem ("Slot"+String(indice), indice+1);
+    }
+    
+    //add filter combo box items
+    filter_comboBox.comboBox.addItem ("Lowpass", 1);
+    filter_comboBox.comboBox.addItem ("Highpass", 2);
+    filter_comboBox.comboBox.addItem ("Bandpass", 3);
+    
+    //add sample combo box items
+    for (int indice=0;indice<nb_samples;indice++)
+    {
+        samplecomboBox.comboBox.addItem (BinaryData::namedResourceList[indice], indice+1);
+    }
+    
+    addAndMakeVisible (bankcomboBox.comboBox);
+    addAndMakeVisible(bankcomboBox.comboBoxlabel);
+    bankcomboBox.comboBox.addListener(this);
+    
+    addAndMakeVisible (samplecomboBox.comboBox);
+    addAndMakeVisible(samplecomboBox.comboBoxlabel);
+    samplecomboBox.comboBox.addListener(this);
+    
+    dialp.slider.setRange (-24, 24);
+    addAndMakeVisible (dialp.slider);
+    addAndMakeVisible(dialp.sliderlabel);
+    dialp.slider.addListener(this);
+    
+    addAndMakeVisible (editor);
+    Logger::outputDebugString(String(getRight()));
+    
+    addAndMakeVisible (filter_button.button);
+    addAndMakeVisible (filter_button.buttonlabel);
+    filter_button.button.addListener(this);
+    
+    addAndMakeVisible (filter_comboBox.comboBox);
+    addAndMakeVisible(filter_comboBox.comboBoxlabel);
+    filter_comboBox.comboBox.addListener(this);
+    filter_dialf.slider.setRange (50, 20000);
+    
+    addAndMakeVisible (filter_dialf.slider);
+    addAndMakeVisible(filter_dialf.sliderlabel);
+    filter_dialf.slider.addListener(this);
+    
+    filter_dialr.slider.setRange (0.1, 10);
+    addAndMakeVisible(filter_dialr.slider);
+    addAndMakeVisible(filter_dialr.sliderlabel);
+    
+    // cuts the sample of the slot at its hits, one slice per slot from this one on
+    slice_button.setButtonText("Slice to pads");
+    slice_button.setBounds(500,400,120,24);
+    slice_button.addListener(this);
+    addAndMakeVisible(slice_button);
+    
+
+    addAndMakeVisible (keyboardComponent);
+    keyboardComponent->setAvailableRange(36,36+16);
+    
+    keyboardComponent->setBounds(8,150,300,300);
+    keyboardComponent->setKeyWidth();
+    
+    // above the editor, so the line shows over it
+    addAndMakeVisible (playhead);
+    
+    sampler_sound=nullptr;
+}
+
+SamplerPage::~SamplerPage()
+{
+    selectSound (nullptr);
+}
+
+void SamplerPage::selectSound (CustomSamplerSound* sound)
+{
+    if (sound == sampler_sound)
+        return;
+    
+    if (sampler_sound != nullptr)
+        sampler_sound->removeChangeListener (this);
+    
+    sampler_sound = sound;
+    editor.setSound (sampler_sound);
+    playhead.setPosition (-1.0f);
+    
+    if (sampler_sound != nullptr)
+        sampler_sound->addChangeListener (this);
+}
+
+void SamplerPage::changeListenerCallback (ChangeBroadcaster* source)
+{
+    // a new sample has been loaded into the selected pad
+    if (source == sampler_sound)
+        editor.setSound (sampler_sound);
+}
+
+void SamplerPage::start_timer()
+{
+    if (isTimerRunning ()==false)
+        {
+        startTimer (40);
+        }
+}
+void SamplerPage::stop_timer()
+{
+    stopTimer();
+}
+
+void SamplerPage::comboBoxChanged (ComboBox* combobox)
+{
+
+    if (combobox==&bankcomboBox.comboBox)
+    {
+        selected_slot=combobox->getSelectedId()-1;
+        CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synth.getSound(selected_slot).get()) };
+        selectSound (sound);
+        Logger::outputDebugString(sampler_sound->getAudioFile().getFullPathName());
+        samplecomboBox.comboBox.setSelectedItemIndex(sampler_sound->sample_index,dontSendNotification);
+        dialp.slider.setValue(sampler_sound->detune,dontSendNotification);
+        filter_button.button.setToggleState(sampler_sound->filter_active,dontSendNotification);
+        filter_dialf.slider.setValue(sampler_sound->filter_cutoff,dontSendNotification);
+        filter_comboBox.comboBox.setSelectedItemIndex(sampler_sound->filter_type-1,dontSendNotification);
+        repaint();
+    }
+    
+    
+    if (combobox == &samplecomboBox.comboBox)
+        {
+        int selected_sample=combobox->getSelectedId()-1;
+
+        File audioFile = synth.getSampleFile (selected_sample+1);
+            
+        CustomSamplerSound* sound{ dynamic_cast<CustomSamplerSound*> (synth.getSound(selected_slot).get()) };
+        selectSound (sound);
+        sampler_sound->sample_index=selected_sample+1;
+        sampler_sound->setAudioFile (audioFile);
+        sampler_sound->loadSound();
+            
+        repaint();
+        }
+    
+    if (combobox == &filter_comboBox.comboBox)
+    {
+        int type=combobox->getSelectedId();
+        sampler_sound->filter_type=type;
+        sampler_sound->paramsChanged();
+    }
+    
+
+}
+
+void SamplerPage::sliderValueChanged (Slider* slider)
+{
+    if (sampler_sound != NULL)
+    {
+
+    if (slider == &dialp.slider)
+    {
+        sampler_sound->detune=slider->getValue();
+        sampler_sound->paramsChanged();
+    }
+    if  (slider == &filter_dialf.slider)
+    {
+        sampler_sound->filter_cutoff=slider->getValue();
+        sampler_sound->paramsChanged();
+    }
+    }
+
+    
+}
+
+
+void SamplerPage::buttonStateChanged(Button* button)
+{
+
+}
+
+void SamplerPage::buttonClicked(Button* button)
+{
+    if (button == &filter_button.button)
+    {
+        int value=button->getToggleStateValue().getValue();
+        sampler_sound->filter_active=value;
+        sampler_sound->paramsChanged();
+    }
+    
+    if (button == &slice_button && sampler_sound != nullptr)
+    {
+        synth.sliceToPadsAsync(sampler_sound->pad_index, TransientSlicer::Options());
+    }
+
+}
+
+
+
+
+Rectangle<int> SamplerPage::getWaveformBounds() const
+{
+    return Rectangle<int> (8,18, getWidth() - 16, 100);
+}
+
+void SamplerPage::resized()
+{
+    editor.setBounds (getWaveformBounds());
+    playhead.setBounds (getWaveformBounds());
+}
+
+void SamplerPage::timerCallback()
+{
+    if (sampler_sound == nullptr)
+        return;
+    
+    if (! isPositiveAndBelow (sampler_sound->pad_index, (int) VoiceStateChannel::maxPads))
+        return;
+    
+    // the overlay takes a fraction of its width, the editor knows where the time is drawn
+    const VoiceStateChannel::PadState pad (synth.getVoiceStates().pads[sampler_sound->pad_index]);
+    const int x = pad.numVoices > 0 ? editor.getXForSeconds (pad.positionSeconds) : -1;
+    playhead.setPosition (x >= 0 && playhead.getWidth() > 0 ? x / (float) playhead.getWidth() : -1.0f);
+}
+
+
+
+//==============================================================================
+
+MixerPage::MixerPage(BusMixer& mixer_,FreezeCache& freezeCache_)
+:mixer(mixer_),
+freezeCache(freezeCache_),
+statusCounter(0)
+{
+    const BusMixer::Routing& routing=mixer.getRouting();
+    
+    for (int bus=0;bus<BusMixer::maxBuses;bus++)
+    {
+        const int y=40+bus*40;
+        
+        Label* label=padLabels.add(new Label());
+        label->setText(String::formatted("Pad %d",bus+1),dontSendNotification);
+        label->setColour(Label::textColourId,Colour(24,30,35));
+        label->setBounds(8,y,60,24);
+        addAndMakeVisible(label);
+        
+        ComboBox* padBus=padBusBoxes.add(new ComboBox());
+        for (int indice=0;indice<BusMixer::maxBuses;indice++)
+        {
+            padBus->addItem(String::formatted("Bus %d",indice+1),indice+1);
+        }
+        padBus->setSelectedId(routing.padBus[bus]+1,dontSendNotification);
+        padBus->setBounds(70,y,90,24);
+        padBus->addListener(this);
+        addAndMakeVisible(padBus);
+        
+        ComboBox* output=outputBoxes.add(new ComboBox());
+        output->addItem("Main mix",mainMixId);
+        for (int channel=0;channel<BusMixer::maxOutputChannels;channel+=2)
+        {
+            output->addItem(String::formatted("Out %d-%d",channel+1,channel+2),stereoOutputId+channel);
+        }
+        for (int channel=0;channel<BusMixer::maxOutputChannels;channel++)
+        {
+            output->addItem(String::formatted("Out %d (mono)",channel+1),monoOutputId+channel);
+        }
+        const BusMixer::BusSettings& settings=routing.buses[bus];
+        if (settings.output==BusMixer::mainMixOutput)
+            output->setSelectedId(mainMixId,dontSendNotification);
+        else
+            output->setSelectedId((settings.mono ? monoOutputId : stereoOutputId)+settings.output,dontSendNotification);
+        output->setBounds(200,y,120,24);
+        output->addListener(this);
+        addAndMakeVisible(output);
+        
+        Slider* gain=gainSliders.add(new Slider());
+        gain->setSliderStyle(Slider::LinearBar);
+        gain->setRange(-60.0,6.0,0.1);
+        gain->setTextValueSuffix(" dB");
+        gain->setValue(settings.gainDb,dontSendNotification);
+        gain->setBounds(330,y,120,24);
+        gain->addListener(this);
+        addAndMakeVisible(gain);
+        
+        Slider* send=sendSliders.add(new Slider());
+        send->setSliderStyle(Slider::LinearBar);
+        send->setRange(0.0,1.0,0.01);
+        send->setTextValueSuffix(" send");
+        send->setValue(settings.reverbSend,dontSendNotification);
+        send->setBounds(460,y,120,24);
+        send->addListener(this);
+        addAndMakeVisible(send);
+        
+        levels[bus][0]=0.0f;
+        levels[bus][1]=0.0f;
+    }
+    
+    const int y=40+BusMixer::maxBuses*40;
+    
+    freezeButton.setButtonText("Freeze static pads");
+    freezeButton.setToggleState(freezeCache.isEnabled(),dontSendNotification);
+    freezeButton.setColour(ToggleButton::textColourId,Colour(24,30,35));
+    freezeButton.setBounds(8,y,160,24);
+    freezeButton.addListener(this);
+    addAndMakeVisible(freezeButton);
+    
+    freezeStatus.setColour(Label::textColourId,Colour(24,30,35));
+    freezeStatus.setBounds(170,y,580,24);
+    addAndMakeVisible(freezeStatus);
+    
+    startTimerHz(20);
+}
+
+void MixerPage::buttonClicked (Button* button)
+{
+    if (button==&freezeButton)
+    {
+        freezeCache.setEnabled(freezeButton.getToggleState());
+    }
+}
+
+void MixerPage::comboBoxChanged (ComboBox* combobox)
+{
+    BusMixer::Routing routing=mixer.getRouting();
+    
+    const int padIndex=padBusBoxes.indexOf(combobox);
+    if (padIndex>=0)
+    {
+        routing.padBus[padIndex]=combobox->getSelectedId()-1;
+    }
+    
+    const int busIndex=outputBoxes.indexOf(combobox);
+    if (busIndex>=0)
+    {
+        const int id=combobox->getSelectedId();
+        BusMixer::BusSettings& settings=routing.buses[busIndex];
+        settings.mono=(id>=monoOutputId);
+        settings.output=(id==mainMixId) ? (int) BusMixer::mainMixOutput : id-(settings.mono ? monoOutputId : stereoOutputId);
+    }
+    
+    mixer.setRouting(routing);
+}
+
+void MixerPage::sliderValueChanged (Slider* slider)
+{
+    BusMixer::Routing routing=mixer.getRouting();
+    
+    const int gainIndex=gainSliders.indexOf(slider);
+    if (gainIndex>=0)
+    {
+        routing.buses[gainIndex].gainDb=(float) slider->getValue();
+    }
+    
+    const int sendIndex=sendSliders.indexOf(slider);
+    if (sendIndex>=0)
+    {
+        routing.buses[sendIndex].reverbSend=(float) slider->getValue();
+    }
+    
+    mixer.setRouting(routing);
+}
+
+void MixerPage::paint (Graphics& g)
+{
+    g.setColour(Colour(24,30,35));
+    g.drawText("Bus",70,12,90,20,Justification::centredLeft,false);
+    g.drawText("Output",200,12,120,20,Justification::centredLeft,false);
+    g.drawText("Fader",330,12,120,20,Justification::centredLeft,false);
+    g.drawText("Reverb",460,12,120,20,Justification::centredLeft,false);
+    
+    for (int bus=0;bus<BusMixer::maxBuses;bus++)
+    {
+        const int y=40+bus*40;
+        
+        for (int channel=0;channel<2;channel++)
+        {
+            const float width=150.0f*jlimit(0.0f,1.0f,1.0f+Decibels::gainToDecibels(levels[bus][channel])/60.0f);
+            g.setColour(Colour(24,30,35));
+            g.fillRect(600,y+channel*12,150,10);
+            g.setColour(levels[bus][channel]>=1.0f ? Colours::red : Colour(255,201,7));
+            g.fillRect(600.0f,(float) (y+channel*12),width,10.0f);
+        }
+    }
+}
+
+void MixerPage::timerCallback()
+{
+    bool changed=false;
+    
+    for (int bus=0;bus<BusMixer::maxBuses;bus++)
+    {
+        for (int channel=0;channel<2;channel++)
+        {
+            // peak hold with a fall-off of about 20 dB per second
+            const float level=jmax(mixer.getAndResetPeak(bus,channel),levels[bus][channel]*0.89f);
+            if (level!=levels[bus][channel])
+            {
+                levels[bus][channel]=level<1.0e-4f ? 0.0f : level;
+                changed=true;
+            }
+        }
+    }
+    
+    if (changed)
+        repaint(600,0,150,getHeight());
+    
+    if (++statusCounter>=20)
+    {
+        statusCounter=0;
+        freezeStatus.setText(freezeCache.getStatusText(),dontSendNotification);
+    }
+}
@@ -1,187 +1,232 @@
-/*
-  ==============================================================================
-
-    GUI.h
-    Created: 28 Feb 2017 9:32:16am
-    Author:  Vincent Choqueuse
-
-  ==============================================================================
-*/
-
-#ifndef GUI_H_INCLUDED
-#define GUI_H_INCLUDED
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "DrumSynthesiser.h"
-#include "CustomMidiKeyboardComponent.h"
-
-//==============================================================================
-
-class OtherLookAndFeel : public LookAndFeel_V3
-{
-public:
-    
-    OtherLookAndFeel()
-    {
-        
-    }
-    
-    void drawLinearSliderBackground (Graphics &, int x, int y, int width, int height, float sliderPos, float minSliderPos, float maxSliderPos, const Slider::SliderStyle style, Slider &) override
-    {
-        
-    }
-    
-    void drawLinearSliderThumb (Graphics& g, int x, int y, int width, int height,
-                                float sliderPos, float minSliderPos, float maxSliderPos,
-                                const Slider::SliderStyle style, Slider& slider) override
-    {
-        Colour knobColour;
-        const float sliderRadius = (float) (getSliderThumbRadius (slider) - 2);
-        
-        bool isDownOrDragging = slider.isEnabled() && (slider.isMouseOverOrDragging() || slider.isMouseButtonDown());
-        
-        if (isDownOrDragging)
-        {
-            knobColour=Colour(255,101,0);
-        }
-        else
-        {
-            knobColour=Colour(129,140,150);
-        }
-        
-        
-        const float outlineThickness = slider.isEnabled() ? 0.8f : 0.3f;
-
-        if (style == Slider::TwoValueHorizontal || style == Slider::ThreeValueHorizontal)
-            {
-      
-                drawGlassPointer (g, minSliderPos,
-                                  jmin (y + height - sliderRadius * 2.0f, y* 0.1f),
-                                  sliderRadius * 2.0f, knobColour, outlineThickness, 1);
-                
-                drawGlassPointer (g, maxSliderPos,
-                                  jmin (y + height - sliderRadius * 2.0f, y * 0.1f),
-                                  sliderRadius * 2.0f, knobColour, outlineThickness, 3);
-            }
-        
-    }
-    
-    void drawGlassPointer (Graphics& g,
-                      const float x, const float y, const float diameter,
-                      const Colour& colour, const float outlineThickness,
-                      const int direction) noexcept
-    {
-        if (diameter <= outlineThickness)
-            return;
-        
-        Colour border=Colour(14,18,20);
-
-        Path p;
-        p.startNewSubPath (x + diameter * 0.5f, y);
-        p.lineTo (x + diameter, y + diameter * 0.8f);
-        p.lineTo (x + diameter, y + diameter);
-        p.lineTo (x, y + diameter);
-        p.lineTo (x, y + diameter * 0.8f);
-        p.closeSubPath();
-        
-        p.applyTransform (AffineTransform::rotation (direction * (float_Pi * 0.5f), x + diameter * 0.5f, y + diameter * 0.5f));
-
-        if (direction==3)
-        {
-            p.applyTransform (AffineTransform::translation(-diameter, 0));
-        }
-        g.setColour (colour);
-        g.fillPath (p);
-        
-        g.setColour (border);
-        //g.strokePath (p, PathStrokeType (outlineThickness));
-        g.setColour (colour);
-        g.drawLine (x, y, x,y+100, 2.0f);
-    
-    }
-};
-
-
-class PadLookAndFeel : public LookAndFeel_V3
-{
-    public:
-    PadLookAndFeel()
-    {
-        setColour (Slider::rotarySliderFillColourId, Colours::red);
-    }
-};
-
-
-class CustomSlider : public Component
-{
-    public:
-    CustomSlider(const String& componentName,const String& suffix,int x,int y,bool textbox);
-    
-    Slider slider;
-    Label sliderlabel;
-    
-    
-};
-
-class CustomToggleButton: public Component
-{
-    public:
-    CustomToggleButton(const String& componentName,const String& suffix,int x,int y);
-    
-    ToggleButton button;
-    Label buttonlabel;
-    
-};
-
-class CustomComboBox : public Component
-{
-    public:
-    CustomComboBox(const String& componentName,const String& suffix,int x,int y);
-    ComboBox comboBox;
-    Label comboBoxlabel;
-};
-
-
-
-struct SamplerPage  :
-public Component,
-private Slider::Listener,
-private Timer,
-private ComboBox::Listener,
-private Button::Listener
-{
-    SamplerPage(DrumSynthesiser& synth_,CustomMidiKeyboardComponent *keyboardComponent);
-    
-    void comboBoxChanged (ComboBox* combobox) override;
-    void sliderValueChanged (Slider* slider) override;
-    void buttonStateChanged(Button* button) override;
-    void buttonClicked (Button * button) override;
-    void paint (Graphics& g) override;
-    void start_timer();
-    void stop_timer();
-    void timerCallback() override;
-    
-    int selected_slot;
-    int nb_samples;
-    
-    
-    OtherLookAndFeel otherLookAndFeel;
-    Slider cutoffSlider;
-    Slider QSlider;
-    Label cutoffSliderLabel;
-    DrumSynthesiser& synth;
-    CustomMidiKeyboardComponent *keyboardComponent;
-    CustomSlider dialp,filter_dialf,filter_dialr;
-    Slider slider_ss;
-    CustomComboBox samplecomboBox,filter_comboBox,bankcomboBox;
-    CustomToggleButton filter_button;
-    AudioThumbnail* thumbnail;
-    CustomSamplerSound* sampler_sound;
-    PadLookAndFeel padLookAndFeel;
-    
-    double startTime;
-};
-
-
-
-#endif  // GUI_H_INCLUDED
+/*
+  ==============================================================================
+
+    GUI.h
+    Created: 28 Feb 2017 9:32:16am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef GUI_H_INCLUDED
+#define GUI_H_INCLUDED
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DrumSynthesiser.h"
+#include "MasterDynamics.h"
+#include "BusMixer.h"
+#include "CustomMidiKeyboardComponent.h"
+#include "SamplerEngine.h"
+
+//==============================================================================
+
+class PadLookAndFeel : public LookAndFeel_V3
+{
+    public:
+    PadLookAndFeel()
+    {
+        setColour (Slider::rotarySliderFillColourId, Colours::red);
+    }
+};
+
+
+class CustomSlider : public Component
+{
+    public:
+    CustomSlider(const String& componentName,const String& suffix,int x,int y,bool textbox);
+    
+    Slider slider;
+    Label sliderlabel;
+    
+    
+};
+
+class CustomToggleButton: public Component
+{
+    public:
+    CustomToggleButton(const String& componentName,const String& suffix,int x,int y);
+    
+    ToggleButton button;
+    Label buttonlabel;
+    
+};
+
+class CustomComboBox : public Component
+{
+    public:
+    CustomComboBox(const String& componentName,const String& suffix,int x,int y);
+    ComboBox comboBox;
+    Label comboBoxlabel;
+};
+
+/** Horizontal bar showing the gain reduction of the master limiter, growing from the right. */
+class GainReductionMeter : public Component,
+private Timer
+{
+    public:
+    GainReductionMeter(MasterDynamics& dynamics_);
+    
+    void paint (Graphics& g) override;
+    void timerCallback() override;
+    
+    MasterDynamics& dynamics;
+    float reductionDb;
+    int clipHold;
+};
+
+
+/** DSP load of the audio callback over the last half second, with its worst
+    callback, the voices playing and the xruns so far. Turns red after an xrun. */
+class LoadMeter : public Component,
+private Timer
+{
+    public:
+    LoadMeter(SamplerEngine& engine_);
+    
+    void paint (Graphics& g) override;
+    void timerCallback() override;
+    
+    SamplerEngine& engine;
+    AudioTelemetry::Snapshot previous, period;
+    int64 totalXruns;
+    int alertHold;
+};
+
+
+/** Playhead line drawn over the waveform. Moving it repaints only the strips
+    under its old and new positions. */
+class PlayheadOverlay : public Component
+{
+    public:
+    PlayheadOverlay();
+    
+    /** Fraction of the width, negative to hide the line. */
+    void setPosition (float proportion);
+    void paint (Graphics& g) override;
+    
+    int getLineX() const;
+    
+    float position;
+};
+
+
+/** The selected pad's sample, drawn from its waveform pyramid at any zoom, down to
+    single samples. The wheel zooms around the mouse, a horizontal swipe or a drag
+    scrolls, and a double click shows the whole sample again. The start and end
+    markers are dragged with sample precision. */
+class SampleEditor : public Component
+{
+    public:
+    SampleEditor();
+    
+    /** Null for no sound. Call again when the sound's sample changes. */
+    void setSound (CustomSamplerSound* sound);
+    void zoomToFit();
+    
+    /** Position of a time of the sample in the component, -1 when outside the view. */
+    int getXForSeconds (double seconds) const;
+    
+    void paint (Graphics& g) override;
+    void resized() override;
+    void mouseMove (const MouseEvent& e) override;
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+    void mouseUp (const MouseEvent& e) override;
+    void mouseDoubleClick (const MouseEvent& e) override;
+    void mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel) override;
+    
+    enum DragMode { notDragging, draggingStart, draggingEnd, scrolling };
+    
+    DragMode getMarkerAt (float x) const;
+    double getSampleForX (float x) const;
+    float getXForSample (double sample) const;
+    void setView (double newViewStart, double newSamplesPerPixel);
+    void renderImage();
+    
+    CustomSamplerSound* sound;
+    WaveformPyramid::Ptr waveform;
+    Image image;            // the waveform alone, cleared when the view, the sample or the size changes
+    double viewStart;       // sample at the left edge
+    double samplesPerPixel;
+    DragMode dragMode;
+    double dragViewStart;
+};
+
+
+struct SamplerPage  :
+public Component,
+private Slider::Listener,
+private Timer,
+private ComboBox::Listener,
+private Button::Listener,
+private ChangeListener
+{
+    SamplerPage(DrumSynthesiser& synth_,CustomMidiKeyboardComponent *keyboardComponent);
+    ~SamplerPage();
+    
+    void comboBoxChanged (ComboBox* combobox) override;
+    void sliderValueChanged (Slider* slider) override;
+    void buttonStateChanged(Button* button) override;
+    void buttonClicked (Button * button) override;
+    void resized() override;
+    void start_timer();
+    void stop_timer();
+    void timerCallback() override;
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+    void selectSound (CustomSamplerSound* sound);
+    Rectangle<int> getWaveformBounds() const;
+    
+    int selected_slot;
+    int nb_samples;
+    
+    
+    Slider cutoffSlider;
+    Slider QSlider;
+    Label cutoffSliderLabel;
+    DrumSynthesiser& synth;
+    CustomMidiKeyboardComponent *keyboardComponent;
+    CustomSlider dialp,filter_dialf,filter_dialr;
+    CustomComboBox samplecomboBox,filter_comboBox,bankcomboBox;
+    CustomToggleButton filter_button;
+    TextButton slice_button;
+    SampleEditor editor;
+    PlayheadOverlay playhead;
+    CustomSamplerSound* sampler_sound;
+    PadLookAndFeel padLookAndFeel;
+    
+    double startTime;
+};
+
+
+/** One row per pad: the bus the pad plays into, and the output, fader, reverb send and meter of that bus.
+    The freeze cache switch and statistics sit below. */
+struct MixerPage  :
+public Component,
+private ComboBox::Listener,
+private Slider::Listener,
+private Button::Listener,
+private Timer
+{
+    MixerPage(BusMixer& mixer_,FreezeCache& freezeCache_);
+    
+    void comboBoxChanged (ComboBox* combobox) override;
+    void sliderValueChanged (Slider* slider) override;
+    void buttonClicked (Button* button) override;
+    void paint (Graphics& g) override;
+    void timerCallback() override;
+    
+    enum { mainMixId = 1, stereoOutputId = 2, monoOutputId = 100 };
+    
+    BusMixer& mixer;
+    FreezeCache& freezeCache;
+    ToggleButton freezeButton;
+    Label freezeStatus;
+    int statusCounter;
+    OwnedArray<Label> padLabels;
+    OwnedArray<ComboBox> padBusBoxes, outputBoxes;
+    OwnedArray<Slider> gainSliders, sendSliders;
+    float levels[BusMixer::maxBuses][2];
+};
+
+
+#endif  // GUI_H_INCLUDED
@@ -0,0 +1,500 @@
+/*
+  ==============================================================================
+
+    GoldenTests.cpp
+    Created: 19 Oct 2026 6:11:04pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "GoldenTests.h"
+#include "SamplerEngine.h"
+#include "OfflineRenderer.h"
+#include "RealtimeChecker.h"
+#include <functional>
+#include <limits>
+
+namespace
+{
+    enum class Samples
+    {
+        embedded,       // the BinaryData kit, 44.1 kHz AIFFs
+        synthetic       // SampleBuffer::createSynthetic() at 44.1 kHz
+    };
+
+    struct Scenario
+    {
+        String name;
+        Samples samples;
+        bool throughEngine;     // buses, reverb, master chain and limiter, or the synth alone
+        double sampleRate;
+        int blockSize;
+        double seconds;
+        double maxDeviation, minSnrDb;
+        std::function<void (DrumSynthesiser&)> setUpPads;
+        MidiMessageSequence midi;   // time stamps in seconds
+    };
+
+    CustomSamplerSound* getPad (DrumSynthesiser& synth, int pad)
+    {
+        return dynamic_cast<CustomSamplerSound*> (synth.getSound (pad).get());
+    }
+
+    void addHit (Scenario& scenario, int pad, double time, float velocity, int channel = 1, double length = -1.0)
+    {
+        scenario.midi.addEvent (MidiMessage::noteOn (channel, 36 + pad, velocity), time);
+
+        if (length >= 0.0)
+            scenario.midi.addEvent (MidiMessage::noteOff (channel, 36 + pad), time + length);
+    }
+
+    Scenario makeScenario (const String& name, Samples samples, double sampleRate, int blockSize)
+    {
+        Scenario scenario;
+        scenario.name = name;
+        scenario.samples = samples;
+        scenario.throughEngine = false;
+        scenario.sampleRate = sampleRate;
+        scenario.blockSize = blockSize;
+        scenario.seconds = 3.0;
+        scenario.maxDeviation = 1.0e-6;
+        scenario.minSnrDb = 110.0;
+        return scenario;
+    }
+
+    //==============================================================================
+    /** Changing one of these invalidates its golden file: record it again. */
+    Array<Scenario> makeScenarios()
+    {
+        Array<Scenario> scenarios;
+
+        {
+            Scenario s (makeScenario ("embedded_hits", Samples::embedded, 48000.0, 512));
+
+            for (int pad = 0; pad < 8; ++pad)
+                addHit (s, pad, 0.3 * pad, 0.3f + 0.1f * (float) pad);
+
+            s.seconds = 4.5;
+            scenarios.add (s);
+        }
+
+        {
+            // event times fall inside blocks, so the synth splits them
+            Scenario s (makeScenario ("odd_block_size", Samples::embedded, 44100.0, 17));
+
+            for (int pad = 0; pad < 8; ++pad)
+                addHit (s, pad, 0.1234 * pad + 0.0007, 0.9f - 0.05f * (float) pad);
+
+            scenarios.add (s);
+        }
+
+        {
+            Scenario s (makeScenario ("pitch", Samples::synthetic, 48000.0, 256));
+
+            s.setUpPads = [] (DrumSynthesiser& synth)
+            {
+                const int detunes[] = { -12, -7, -1, 0, 1, 5, 7, 12 };
+
+                for (int pad = 0; pad < 8; ++pad)
+                    getPad (synth, pad)->detune = detunes[pad];
+            };
+
+            for (int pad = 0; pad < 8; ++pad)
+                addHit (s, pad, 0.15 * pad, 0.7f);
+
+            s.seconds = 4.5;
+            scenarios.add (s);
+        }
+
+        {
+            // the IIR recursion carries rounding differences further than the rest
+            Scenario s (makeScenario ("filters", Samples::embedded, 48000.0, 128));
+            s.maxDeviation = 1.0e-5;
+            s.minSnrDb = 100.0;
+
+            s.setUpPads = [] (DrumSynthesiser& synth)
+            {
+                const float cutoffs[] = { 80.0f, 200.0f, 1000.0f, 5000.0f, 12000.0f, 300.0f, 2500.0f, 18000.0f };
+
+                for (int pad = 0; pad < 8; ++pad)
+                {
+                    CustomSamplerSound* sound = getPad (synth, pad);
+                    sound->filter_active = 1;
+                    sound->filter_type = 1 + pad % 3;
+                    sound->filter_cutoff = cutoffs[pad];
+                }
+            };
+
+            for (int pad = 0; pad < 8; ++pad)
+                addHit (s, pad, 0.25 * pad, 0.8f);
+
+            s.seconds = 4.0;
+            scenarios.add (s);
+        }
+
+        {
+            Scenario s (makeScenario ("trims_and_release", Samples::embedded, 48000.0, 64));
+
+            s.setUpPads = [] (DrumSynthesiser& synth)
+            {
+                for (int pad = 0; pad < 8; ++pad)
+                {
+                    CustomSamplerSound* sound = getPad (synth, pad);
+                    sound->sample_start = 0.05f * (float) pad;
+                    sound->sample_end = 1.0f - 0.08f * (float) pad;
+                }
+            };
+
+            // half the hits are cut short by their note-off
+            for (int pad = 0; pad < 8; ++pad)
+                addHit (s, pad, 0.2 * pad, 0.8f, 1, (pad & 1) != 0 ? 0.05 + 0.01 * pad : -1.0);
+
+            scenarios.add (s);
+        }
+
+        {
+            // more hits at once than the synth has voices
+            Scenario s (makeScenario ("voice_stealing", Samples::synthetic, 48000.0, 256));
+
+            for (int i = 0; i < 24; ++i)
+                addHit (s, i % 8, 0.01 * i, 0.4f + 0.02f * (float) i, 1 + i / 8);
+
+            addHit (s, 3, 0.5, 1.0f, 1);
+            addHit (s, 3, 0.52, 0.5f, 1);
+            s.seconds = 2.5;
+            scenarios.add (s);
+        }
+
+        {
+            // the limiter's gain follows the signal, so small differences move more
+            Scenario s (makeScenario ("full_engine", Samples::embedded, 48000.0, 256));
+            s.throughEngine = true;
+            s.maxDeviation = 1.0e-4;
+            s.minSnrDb = 90.0;
+
+            for (int pad = 0; pad < 8; ++pad)
+            {
+                addHit (s, pad, 0.2 * pad, 1.0f);
+                addHit (s, (pad + 3) % 8, 0.2 * pad + 0.05, 0.6f);
+            }
+
+            s.seconds = 4.0;
+            scenarios.add (s);
+        }
+
+        return scenarios;
+    }
+
+    //==============================================================================
+    void loadSamples (DrumSynthesiser& synth, Samples samples)
+    {
+        AiffAudioFormat aiff;
+
+        for (int pad = 0; pad < synth.getNumSounds(); ++pad)
+        {
+            CustomSamplerSound* sound = getPad (synth, pad);
+
+            if (sound == nullptr)
+                continue;
+
+            if (samples == Samples::synthetic)
+            {
+                // not at the render rate, so the interpolation has work to do
+                sound->setSampleData (SampleBuffer::createSynthetic (44100.0, 1.5, pad + 1));
+                continue;
+            }
+
+            int size = 0;
+            const char* data = BinaryData::getNamedResource (BinaryData::namedResourceList[pad % BinaryData::namedResourceListSize], size);
+            std::unique_ptr<AudioFormatReader> reader (aiff.createReaderFor (new MemoryInputStream (data, (size_t) size, false), true));
+
+            if (reader == nullptr)
+            {
+                jassertfalse;
+                continue;
+            }
+
+            SampleBuffer::Ptr sample (new SampleBuffer (jmin (2, (int) reader->numChannels), (int) reader->lengthInSamples, reader->sampleRate));
+            reader->read (&sample->getBuffer(), 0, sample->getLength(), 0, true, true);
+            sound->setSampleData (sample);
+        }
+    }
+
+    AudioSampleBuffer render (const Scenario& scenario)
+    {
+        const ScopedNoDenormals noDenormals;
+
+        // the synth alone renders straight into the output, without any bus
+        std::unique_ptr<SamplerEngine> engine;
+        std::unique_ptr<DrumSynthesiser> standalone;
+
+        if (scenario.throughEngine)
+        {
+            engine.reset (new SamplerEngine());
+            engine->applySettings (EngineConfig());
+        }
+        else
+        {
+            standalone.reset (new DrumSynthesiser());
+        }
+
+        DrumSynthesiser& synth = engine != nullptr ? engine->getSynth() : *standalone;
+
+        // what it freezes depends on the wall clock
+        synth.getFreezeCache().setEnabled (false);
+        loadSamples (synth, scenario.samples);
+
+        if (scenario.setUpPads)
+            scenario.setUpPads (synth);
+
+        if (engine != nullptr)
+            engine->prepareToPlay (scenario.sampleRate, scenario.blockSize);
+        else
+            synth.setCurrentPlaybackSampleRate (scenario.sampleRate);
+
+        const int length = roundToInt (scenario.seconds * scenario.sampleRate);
+        AudioSampleBuffer result (2, length);
+        AudioSampleBuffer block (2, scenario.blockSize);
+        MidiBuffer midi;
+        int index = 0;
+
+        for (int position = 0; position < length; position += scenario.blockSize)
+        {
+            const int numSamples = jmin (scenario.blockSize, length - position);
+            midi.clear();
+
+            for (; index < scenario.midi.getNumEvents(); ++index)
+            {
+                const MidiMessage& message = scenario.midi.getEventPointer (index)->message;
+                const int time = roundToInt (message.getTimeStamp() * scenario.sampleRate);
+
+                if (time >= position + numSamples)
+                    break;
+
+                midi.addEvent (message, time - position);
+            }
+
+            block.clear();
+
+            {
+                RT_CHECK_SCOPE;
+
+                if (engine != nullptr)
+                    engine->renderBlock (block, 0, numSamples, midi);
+                else
+                    synth.renderNextBlock (block, midi, 0, numSamples);
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                result.copyFrom (ch, position, block, ch, 0, numSamples);
+        }
+
+        return result;
+    }
+
+    Result readWavFile (const File& file, AudioSampleBuffer& audio)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader (wav.createReaderFor (file.createInputStream().release(), true));
+
+        if (reader == nullptr)
+            return Result::fail ("cannot read " + file.getFullPathName() + ", record it with Golden/record.sh");
+
+        audio.setSize ((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read (&audio, 0, audio.getNumSamples(), 0, true, true);
+        return Result::ok();
+    }
+
+    bool matches (const Scenario& scenario, const String& filter)
+    {
+        return filter.isEmpty() || scenario.name.contains (filter);
+    }
+
+    //==============================================================================
+    struct Check
+    {
+        String name;
+        std::function<Result()> run;
+    };
+
+    /** Properties that must hold whatever the exact sound, so they have no golden file. */
+    Array<Check> makeChecks()
+    {
+        Array<Check> checks;
+
+        // a loop with more hits than pads: the pads must still cover all of it
+        checks.add ({ "slices_cover_loop", []
+        {
+            DrumSynthesiser synth;
+            const int numPads = synth.getNumSounds();
+            const int numHits = 2 * numPads;
+            const double sampleRate = 44100.0, beatSeconds = 0.25;
+            const int beatLength = (int) (beatSeconds * sampleRate);
+            const SampleBuffer::Ptr loop (new SampleBuffer (2, numHits * beatLength, sampleRate));
+
+            for (int beat = 0; beat < numHits; ++beat)
+            {
+                const SampleBuffer::Ptr hit (SampleBuffer::createSynthetic (sampleRate, 0.2, beat + 1));
+
+                for (int ch = 0; ch < 2; ++ch)
+                    FloatVectorOperations::copy (loop->getBuffer().getWritePointer (ch, beat * beatLength),
+                                                 hit->getBuffer().getReadPointer (ch), hit->getLength());
+            }
+
+            getPad (synth, 0)->setSampleData (loop);
+
+            TransientSlicer::Options options;
+            options.maxSlices = numHits;
+
+            const Result sliced (synth.sliceToPads (0, options));
+
+            if (sliced.failed())
+                return sliced;
+
+            float expectedStart = 0.0f;
+
+            for (int pad = 0; pad < numPads; ++pad)
+            {
+                const CustomSamplerSound* sound = getPad (synth, pad);
+
+                if (sound->getSampleData() != loop)
+                    return Result::fail ("pad " + String (pad) + " did not get a slice of the loop");
+
+                if (sound->sample_start != expectedStart || sound->sample_end <= sound->sample_start)
+                    return Result::fail ("pad " + String (pad) + " does not start where pad " + String (pad - 1) + " ends");
+
+                expectedStart = sound->sample_end;
+            }
+
+            if (expectedStart != 1.0f)
+                return Result::fail ("the last pad ends at " + String (expectedStart, 4) + " of the loop instead of its end");
+
+            return Result::ok();
+        } });
+
+        return checks;
+    }
+}
+
+//==============================================================================
+Result GoldenTests::record (const File& folder, const String& filter)
+{
+    const Result created (folder.createDirectory());
+
+    if (created.failed())
+        return created;
+
+    for (auto& scenario : makeScenarios())
+    {
+        if (! matches (scenario, filter))
+            continue;
+
+        // 32-bit float, so the file holds exactly what was rendered
+        const Result written (OfflineRenderer::writeWavFile (render (scenario), scenario.sampleRate, 32,
+                                                             folder.getChildFile (scenario.name + ".wav")));
+
+        if (written.failed())
+            return written;
+    }
+
+    return Result::ok();
+}
+
+Array<GoldenTests::Outcome> GoldenTests::verify (const File& folder, const String& filter)
+{
+    Array<Outcome> outcomes;
+
+    for (auto& scenario : makeScenarios())
+    {
+        if (! matches (scenario, filter))
+            continue;
+
+        Outcome outcome;
+        outcome.name = scenario.name;
+        outcome.passed = false;
+        outcome.maxDeviation = 0.0;
+        outcome.snrDb = 0.0;
+
+        AudioSampleBuffer golden;
+        const Result read (readWavFile (folder.getChildFile (scenario.name + ".wav"), golden));
+
+        if (read.failed())
+        {
+            outcome.error = read.getErrorMessage();
+            outcomes.add (outcome);
+            continue;
+        }
+
+        const AudioSampleBuffer rendered (render (scenario));
+
+        if (golden.getNumChannels() != rendered.getNumChannels() || golden.getNumSamples() != rendered.getNumSamples())
+        {
+            outcome.error = "the golden file has " + String (golden.getNumSamples()) + " samples on " + String (golden.getNumChannels())
+                              + " channels, the render " + String (rendered.getNumSamples()) + " on " + String (rendered.getNumChannels());
+            outcomes.add (outcome);
+            continue;
+        }
+
+        double signalEnergy = 0.0, errorEnergy = 0.0;
+
+        for (int ch = 0; ch < golden.getNumChannels(); ++ch)
+        {
+            const float* expected = golden.getReadPointer (ch);
+            const float* actual = rendered.getReadPointer (ch);
+
+            for (int i = 0; i < golden.getNumSamples(); ++i)
+            {
+                const double difference = (double) actual[i] - (double) expected[i];
+                outcome.maxDeviation = jmax (outcome.maxDeviation, std::abs (difference));
+                errorEnergy += difference * difference;
+                signalEnergy += (double) expected[i] * expected[i];
+            }
+        }
+
+        outcome.snrDb = errorEnergy > 0.0 ? 10.0 * std::log10 (signalEnergy / errorEnergy)
+                                          : std::numeric_limits<double>::infinity();
+        outcome.passed = outcome.maxDeviation <= scenario.maxDeviation && outcome.snrDb >= scenario.minSnrDb;
+        outcomes.add (outcome);
+    }
+
+    for (auto& check : makeChecks())
+    {
+        if (filter.isNotEmpty() && ! check.name.contains (filter))
+            continue;
+
+        const Result result (check.run());
+
+        Outcome outcome;
+        outcome.name = check.name;
+        outcome.passed = result.wasOk();
+        outcome.maxDeviation = 0.0;
+        outcome.snrDb = 0.0;
+        outcome.detail = result.wasOk() ? String ("check") : result.getErrorMessage();
+        outcomes.add (outcome);
+    }
+
+    return outcomes;
+}
+
+String GoldenTests::describe (const Outcome& outcome)
+{
+    String line (outcome.name.paddedRight (' ', 20));
+
+    if (outcome.error.isNotEmpty())
+        return line + "ERROR  " + outcome.error;
+
+    if (outcome.detail.isNotEmpty())
+        return line + (outcome.passed ? "pass   " : "FAIL   ") + outcome.detail;
+
+    line << (outcome.passed ? "pass   " : "FAIL   ");
+
+    if (outcome.maxDeviation == 0.0)
+        return line + "bit-exact";
+
+    line << "max deviation " << String (outcome.maxDeviation, 9) << " (" << String (Decibels::gainToDecibels (outcome.maxDeviation, -300.0), 1)
+         << " dB), SNR " << String (outcome.snrDb, 1) << " dB";
+
+    return line;
+}
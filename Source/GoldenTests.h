@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    GoldenTests.h
+    Created: 19 Oct 2026 6:11:04pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef GOLDENTESTS_H_INCLUDED
+#define GOLDENTESTS_H_INCLUDED
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ Regression check of the rendered sound, run with --golden-record and
+ --golden-verify.
+
+ A fixed set of scenarios (hits on the embedded and on synthetic samples,
+ pitch, filters, trims and releases, voice stealing, odd block sizes, the
+ whole effect chain) is rendered offline and compared with golden WAV files
+ recorded on a reference build.
+
+ Each scenario has its own tolerance, on the largest deviation from the golden
+ file and on the signal-to-error ratio, so an optimisation that only reorders
+ float operations passes while one that changes the sound does not.
+
+ A few checks of the engine's behaviour that need no golden file run along
+ with them, e.g. that slicing a loop into pads still reaches its end.
+ */
+struct GoldenTests
+{
+    struct Outcome
+    {
+        String name;
+        bool passed;
+        double maxDeviation;    // largest |rendered - golden|
+        double snrDb;           // golden energy over error energy
+        String error;           // set when the golden file could not be used
+        String detail;          // for the checks without a golden file: what was checked or found wrong
+    };
+
+    /** Renders every scenario whose name contains filter into folder/<name>.wav. */
+    static Result record (const File& folder, const String& filter = String());
+
+    /** Renders the scenarios and compares them with the files in folder, then runs the checks. */
+    static Array<Outcome> verify (const File& folder, const String& filter = String());
+
+    /** One line for the console. */
+    static String describe (const Outcome& outcome);
+};
+
+
+#endif  // GOLDENTESTS_H_INCLUDED
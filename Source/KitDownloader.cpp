@@ -0,0 +1,689 @@
+/*
+  ==============================================================================
+
+    KitDownloader.cpp
+    Created: 19 Oct 2026 2:51:44pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "KitDownloader.h"
+#include "Trace.h"
+
+//==============================================================================
+/** Reads the manifest, then queues the samples that are to be fetched, linked or loaded. */
+class KitDownloader::SyncJob  : public ThreadPoolJob
+{
+public:
+    SyncJob (KitDownloader& d, int kit)
+    :   ThreadPoolJob ("kit sync"), owner (d), kitNumber (kit)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        TRACE_THREAD_NAME ("kit download");
+        const Result result (owner.fetchManifest (kitNumber, *this));
+        const StringPairArray recorded (owner.readLocalManifest());
+        Array<bool> needsJob;
+
+        // all the samples are planned before any job starts, so that a job finds the samples it fetches for
+        for (auto* sample : owner.samples)
+        {
+            if (shouldExit())
+                return jobHasFinished;
+
+            // out of reach of the server, the kit stays as it is on disk
+            if (result.failed())
+            {
+                if (! sample->isPresent)
+                    sample->error = result.getErrorMessage();
+
+                needsJob.add (sample->isPresent && ! sample->loaded);
+            }
+            else
+            {
+                needsJob.add (owner.prepareSample (*sample, recorded[sample->name]));
+            }
+        }
+
+        for (int i = 0; i < owner.samples.size(); ++i)
+        {
+            SampleFile* sample = owner.samples.getUnchecked (i);
+
+            if (! needsJob[i])
+                owner.sampleDone (*sample);
+            else if (sample->fetchedBy == nullptr || sample->fetchedBy == sample)
+                owner.pool->addJob (new SampleJob (owner, *sample), true);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    KitDownloader& owner;
+    const int kitNumber;
+};
+
+//==============================================================================
+/** Fetches a sample if needed, with retries, then links and loads it and the
+    samples of the kit with the same content.
+ */
+class KitDownloader::SampleJob  : public ThreadPoolJob
+{
+public:
+    SampleJob (KitDownloader& d, SampleFile& s)
+    :   ThreadPoolJob ("kit sample"), owner (d), sample (s)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        TRACE_THREAD_NAME ("kit download");
+
+        if (sample.needsFetch)
+        {
+            TRACE_SCOPE ("download sample");
+            Result result (Result::ok());
+
+            for (int attempt = 0; attempt < maxAttempts; ++attempt)
+            {
+                if (attempt > 0 && ! waitBeforeRetry (attempt, *this))
+                    break;
+
+                result = owner.fetchSample (sample, *this);
+
+                if (result.wasOk() || shouldExit())
+                    break;
+
+                Logger::outputDebugString (sample.url.toString (false) + ": " + result.getErrorMessage()
+                                            + ", attempt " + String (attempt + 1) + " of " + String ((int) maxAttempts));
+            }
+
+            if (result.failed())
+                sample.error = result.getErrorMessage();
+        }
+
+        for (auto* other : owner.samples)
+            if (other == &sample || other->fetchedBy == &sample)
+                finish (*other);
+
+        return jobHasFinished;
+    }
+
+private:
+    void finish (SampleFile& s)
+    {
+        s.error = sample.error;
+
+        if (s.error.isEmpty() && s.linkToStore && ! shouldExit())
+        {
+            const Result linked (owner.linkToStore (s));
+
+            if (linked.failed())
+                s.error = linked.getErrorMessage();
+        }
+
+        if (s.error.isEmpty() && ! shouldExit())
+        {
+            owner.synth.loadSample (s.index);
+            s.syncedHash = s.expectedHash;
+            s.loaded = true;
+        }
+
+        owner.sampleDone (s);
+    }
+
+    KitDownloader& owner;
+    SampleFile& sample;
+};
+
+//==============================================================================
+KitDownloader::KitDownloader (DrumSynthesiser& synth_)
+:   progress (0.0),
+    synth (synth_),
+    numPending (0),
+    numFailed (0),
+    manifestFetched (false),
+    maxParallelDownloads (4),
+    serverUrl ("https://s3-eu-west-1.amazonaws.com/choqueuse/drumheaven"),
+    downloadEnabled (true),
+    kitReady (false),
+    busy (false)
+{
+}
+
+KitDownloader::~KitDownloader()
+{
+    cancel();
+}
+
+void KitDownloader::cancel()
+{
+    // the jobs stop between two reads, their .part files stay for the next time;
+    // again if the manifest job queued a download as it was told to stop
+    if (pool != nullptr)
+        while (pool->getNumJobs() > 0)
+            pool->removeAllJobs (true, 10000);
+
+    {
+        const ScopedLock sl (finishedLock);
+        finished.clear();
+    }
+
+    cancelPendingUpdate();
+    busy = false;
+}
+
+void KitDownloader::downloadKit (int kitNumber)
+{
+    TRACE_SCOPE ("start kit download");
+    cancel();
+
+    synth.num_kit = kitNumber;
+    synth.nb_samples = samplesPerKit;
+
+    kitReady = false;
+    progress = 0.0;
+    numFailed = 0;
+    manifestFetched = false;
+    samples.clear();
+    outcomes.clearQuick();
+
+    const File directory (synth.getSampleFile (1).getParentDirectory());
+
+    if (! directory.isDirectory())
+        directory.createDirectory();
+
+    Logger::outputDebugString (directory.getFullPathName());
+
+    int numMissing = 0;
+
+    for (int index = 1; index <= samplesPerKit; ++index)
+    {
+        SampleFile* sample = samples.add (new SampleFile());
+        sample->index = index;
+        sample->name = String::formatted ("Tranche%d.aif", index);
+        sample->target = synth.getSampleFile (index);
+        sample->download = sample->target;
+        sample->url = URL (serverUrl + String::formatted ("/kit%d/", kitNumber) + sample->name);
+        sample->isPresent = sample->target.existsAsFile();
+        sample->linkToStore = false;
+        sample->fetchedBy = nullptr;
+        sample->needsFetch = false;
+        sample->expectedSize = 0;
+        sample->bytesOnDisk = 0;
+        sample->loaded = false;
+
+        if (! sample->isPresent)
+            ++numMissing;
+
+        outcomes.add ({ index, sample->name, String(), String(), false });
+    }
+
+    const bool isPackaged = synth.getKitPackageFile().existsAsFile();
+
+    // nothing to wait for: the kit loads right away, all pads at once, from its package if packed
+    if (numMissing == 0 || isPackaged)
+    {
+        synth.loadKit();
+
+        for (auto* sample : samples)
+            sample->loaded = true;
+
+        for (auto& outcome : outcomes)
+            outcome.loaded = true;
+
+        progress = 1.0;
+        kitReady = true;
+        status = String::formatted ("Kit %d loaded", kitNumber);
+
+        if (isPackaged || ! downloadEnabled)
+        {
+            sendChangeMessage();
+            return;
+        }
+    }
+    else if (! downloadEnabled)
+    {
+        progress = 1.0;
+        status = String::formatted ("Kit %d: %d sample(s) missing and downloads are disabled", kitNumber, numMissing);
+        Logger::outputDebugString (status);
+        sendChangeMessage();
+        return;
+    }
+
+    if (pool == nullptr || pool->getNumThreads() != maxParallelDownloads)
+        pool.reset (new ThreadPool (maxParallelDownloads));
+
+    numPending = samples.size();
+    busy = true;
+
+    if (! kitReady)
+        status = String::formatted ("Downloading kit %d", kitNumber);
+
+    // the pads on disk load once the manifest tells which of them are up to date
+    pool->addJob (new SyncJob (*this, kitNumber), true);
+    sendChangeMessage();
+}
+
+//==============================================================================
+Result KitDownloader::fetchManifest (int kitNumber, ThreadPoolJob& job)
+{
+    const URL url (serverUrl + String::formatted ("/kit%d/manifest.json", kitNumber));
+    String error;
+
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        if (attempt > 0 && ! waitBeforeRetry (attempt, job))
+            break;
+
+        int statusCode = 0;
+        std::unique_ptr<InputStream> stream (url.createInputStream (false, nullptr, nullptr, String(), 10000, nullptr, &statusCode));
+
+        // a server without manifests still serves the files, unchecked
+        if (statusCode == 404 || (url.isLocalFile() && ! url.getLocalFile().existsAsFile()))
+        {
+            Logger::outputDebugString ("No manifest for kit " + String (kitNumber) + ", the samples will not be verified");
+            return Result::ok();
+        }
+
+        if (stream == nullptr)
+        {
+            error = "cannot connect to " + serverUrl;
+            continue;
+        }
+
+        if (statusCode != 200 && statusCode != 0)
+        {
+            error = "HTTP " + String (statusCode) + " for " + url.toString (false);
+            continue;
+        }
+
+        const var json (JSON::parse (stream->readEntireStreamAsString()));
+        const Array<var>* files = json["files"].getArray();
+
+        if (files == nullptr)
+            return Result::fail ("Malformed manifest " + url.toString (false));
+
+        // a server that stores its blobs by content too serves each of them once for all kits
+        const String blobFolder (json["blobs"].toString().trimCharactersAtEnd ("/"));
+
+        for (auto& entry : *files)
+        {
+            const String name (entry["name"].toString());
+
+            for (auto* sample : samples)
+            {
+                // Tranche1.flac stands for Tranche1.aif: the loader finds the format from the content
+                if (sample->name.upToLastOccurrenceOf (".", false, false) == name.upToLastOccurrenceOf (".", false, false))
+                {
+                    sample->name = name;
+                    sample->url = URL (serverUrl + String::formatted ("/kit%d/", kitNumber) + name);
+                    sample->expectedHash = entry["sha256"].toString().toLowerCase();
+                    sample->expectedSize = (int64) entry["size"];
+
+                    if (blobFolder.isNotEmpty() && sample->expectedHash.isNotEmpty())
+                        sample->url = URL (serverUrl + "/" + blobFolder + "/" + sample->expectedHash);
+                }
+            }
+        }
+
+        manifestFetched = true;
+        return Result::ok();
+    }
+
+    return Result::fail (job.shouldExit() ? String ("cancelled") : error);
+}
+
+bool KitDownloader::prepareSample (SampleFile& sample, const String& recordedHash)
+{
+    // not in a manifest: used as it is, fetched from the kit folder if missing
+    if (sample.expectedHash.isEmpty())
+    {
+        sample.needsFetch = ! sample.isPresent;
+        return ! sample.loaded;
+    }
+
+    sample.download = getBlobFile (sample.expectedHash);
+
+    if (sample.isPresent)
+    {
+        if (recordedHash == sample.expectedHash)
+        {
+            sample.syncedHash = recordedHash;
+            return ! sample.loaded;
+        }
+
+        // a file from before the store, or copied by hand: moved into the store if it is what the manifest lists
+        if (recordedHash.isEmpty() && SHA256 (sample.target).toHexString() == sample.expectedHash)
+        {
+            if (! sample.target.isSymbolicLink()
+                 && (sample.download.existsAsFile() || sample.target.moveFileTo (sample.download)))
+                linkToStore (sample);
+
+            sample.syncedHash = sample.expectedHash;
+            return ! sample.loaded;
+        }
+    }
+
+    // new or changed: linked to its blob, fetched first unless another kit brought it already
+    sample.linkToStore = true;
+    sample.needsFetch = ! sample.download.existsAsFile();
+
+    if (sample.needsFetch)
+    {
+        sample.fetchedBy = &sample;
+
+        for (auto* other : samples)
+        {
+            if (other != &sample && other->fetchedBy == other && other->expectedHash == sample.expectedHash)
+            {
+                sample.fetchedBy = other;
+                sample.needsFetch = false;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+Result KitDownloader::fetchSample (SampleFile& sample, ThreadPoolJob& job)
+{
+    const File part (sample.download.getSiblingFile (sample.download.getFileName() + ".part"));
+    part.getParentDirectory().createDirectory();
+    int64 resumeFrom = part.getSize();
+
+    if (sample.expectedSize > 0 && resumeFrom > sample.expectedSize)
+    {
+        part.deleteFile();
+        resumeFrom = 0;
+    }
+
+    sample.bytesOnDisk = resumeFrom;
+    updateProgress();
+
+    if (sample.expectedSize <= 0 || resumeFrom < sample.expectedSize)
+    {
+        StringPairArray responseHeaders;
+        int statusCode = 0;
+        const String headers (resumeFrom > 0 ? "Range: bytes=" + String (resumeFrom) + "-" : String());
+
+        std::unique_ptr<InputStream> stream (sample.url.createInputStream (false, nullptr, nullptr, headers, 10000,
+                                                                          &responseHeaders, &statusCode));
+
+        // nothing after what we have: the .part file is whole already
+        const bool isComplete = statusCode == 416 && resumeFrom > 0;
+
+        if (! isComplete)
+        {
+            if (stream == nullptr)
+                return Result::fail (statusCode != 0 ? "HTTP " + String (statusCode) : String ("cannot connect"));
+
+            const bool isResumed = statusCode == 206
+                                    && responseHeaders["Content-Range"].startsWith ("bytes " + String (resumeFrom) + "-");
+
+            if (statusCode != 200 && statusCode != 0 && ! isResumed)
+                return Result::fail ("HTTP " + String (statusCode));
+
+            // a server that ignores the range sends the whole file again
+            if (! isResumed && resumeFrom > 0)
+            {
+                part.deleteFile();
+                resumeFrom = 0;
+                sample.bytesOnDisk = 0;
+            }
+
+            if (sample.expectedSize <= 0 && stream->getTotalLength() > 0)
+                sample.expectedSize = resumeFrom + stream->getTotalLength();
+
+            {
+                FileOutputStream output (part);
+
+                if (output.failedToOpen())
+                    return Result::fail ("cannot write " + part.getFullPathName());
+
+                HeapBlock<char> buffer (65536);
+
+                for (;;)
+                {
+                    if (job.shouldExit())
+                        return Result::fail ("cancelled");
+
+                    const int numRead = stream->read (buffer, 65536);
+
+                    if (numRead <= 0)
+                        break;
+
+                    if (! output.write (buffer, (size_t) numRead))
+                        return Result::fail ("cannot write " + part.getFullPathName());
+
+                    sample.bytesOnDisk += numRead;
+                    updateProgress();
+                }
+            }
+
+            // the next attempt resumes from here
+            if (sample.expectedSize > 0 && sample.bytesOnDisk < sample.expectedSize)
+                return Result::fail ("connection lost after " + String (sample.bytesOnDisk.load()) + " bytes");
+        }
+    }
+
+    const Result verified (verify (sample));
+
+    if (verified.failed())
+    {
+        part.deleteFile();
+        sample.bytesOnDisk = 0;
+        updateProgress();
+        return verified;
+    }
+
+    if (! part.moveFileTo (sample.download))
+        return Result::fail ("cannot rename " + part.getFullPathName());
+
+    return Result::ok();
+}
+
+Result KitDownloader::verify (SampleFile& sample) const
+{
+    const File part (sample.download.getSiblingFile (sample.download.getFileName() + ".part"));
+
+    if (sample.expectedSize > 0 && part.getSize() != sample.expectedSize)
+        return Result::fail ("size " + String (part.getSize()) + " instead of " + String (sample.expectedSize.load()));
+
+    if (sample.expectedHash.isNotEmpty())
+    {
+        TRACE_SCOPE ("verify sample");
+
+        if (SHA256 (part).toHexString() != sample.expectedHash)
+            return Result::fail ("checksum mismatch");
+    }
+
+    return Result::ok();
+}
+
+Result KitDownloader::linkToStore (SampleFile& sample) const
+{
+    // an old copy or link goes; the new link is relative, so that the kit root can move
+    sample.target.deleteFile();
+
+    if (File::createSymbolicLink (sample.target, sample.download.getRelativePathFrom (sample.target.getParentDirectory()), false))
+        return Result::ok();
+
+    // where links cannot be made, e.g. Windows without the developer mode
+    if (sample.download.copyFileTo (sample.target))
+        return Result::ok();
+
+    return Result::fail ("cannot link " + sample.target.getFullPathName());
+}
+
+bool KitDownloader::waitBeforeRetry (int attempt, ThreadPoolJob& job)
+{
+    // 0.5 s, 1 s, 2 s..., a quarter of it random, so that the files retry apart
+    const int delayMs = 500 << jmin (attempt - 1, 6);
+    const uint32 end = Time::getMillisecondCounter() + (uint32) (delayMs + Random::getSystemRandom().nextInt (delayMs / 4 + 1));
+
+    while (Time::getMillisecondCounter() < end)
+    {
+        if (job.shouldExit())
+            return false;
+
+        Thread::sleep (50);
+    }
+
+    return ! job.shouldExit();
+}
+
+//==============================================================================
+File KitDownloader::getLocalManifestFile() const
+{
+    return synth.getSampleFile (1).getSiblingFile ("manifest.json");
+}
+
+StringPairArray KitDownloader::readLocalManifest() const
+{
+    StringPairArray hashes;
+    const var json (JSON::parse (getLocalManifestFile()));
+
+    if (const Array<var>* files = json["files"].getArray())
+        for (auto& entry : *files)
+            hashes.set (entry["name"].toString(), entry["sha256"].toString().toLowerCase());
+
+    return hashes;
+}
+
+void KitDownloader::writeLocalManifest() const
+{
+    Array<var> files;
+
+    for (auto& outcome : outcomes)
+    {
+        if (outcome.syncedHash.isEmpty())
+            continue;
+
+        DynamicObject::Ptr entry (new DynamicObject());
+        entry->setProperty ("name", outcome.name);
+        entry->setProperty ("size", synth.getSampleFile (outcome.index).getSize());
+        entry->setProperty ("sha256", outcome.syncedHash);
+        files.add (var (entry.get()));
+    }
+
+    DynamicObject::Ptr manifest (new DynamicObject());
+    manifest->setProperty ("files", files);
+
+    if (! getLocalManifestFile().replaceWithText (JSON::toString (var (manifest.get()))))
+        Logger::outputDebugString ("Cannot write " + getLocalManifestFile().getFullPathName());
+}
+
+File KitDownloader::getBlobFile (const String& hash) const
+{
+    return synth.getKitRoot().getChildFile ("blobs").getChildFile (hash);
+}
+
+//==============================================================================
+int64 KitDownloader::getBytesDownloaded() const noexcept
+{
+    int64 total = 0;
+
+    for (auto* sample : samples)
+        if (sample->needsFetch)
+            total += sample->bytesOnDisk;
+
+    return total;
+}
+
+int64 KitDownloader::getTotalBytes() const noexcept
+{
+    int64 total = 0;
+
+    for (auto* sample : samples)
+        if (sample->needsFetch)
+            total += sample->expectedSize;
+
+    return total;
+}
+
+void KitDownloader::updateProgress()
+{
+    const int64 totalBytes = getTotalBytes();
+
+    if (totalBytes > 0)
+        progress = jmin (1.0, getBytesDownloaded() / (double) totalBytes);
+}
+
+void KitDownloader::sampleDone (SampleFile& sample)
+{
+    // download or loader thread: a copy, the strings of the sample stay the job's
+    if (sample.error.isNotEmpty())
+        ++numFailed;
+
+    {
+        const ScopedLock sl (finishedLock);
+        finished.add ({ sample.index, sample.name, sample.error, sample.syncedHash, sample.loaded.load() });
+    }
+
+    --numPending;
+    triggerAsyncUpdate();
+}
+
+void KitDownloader::handleAsyncUpdate()
+{
+    // read first: every job counted out by then has handed its outcome over
+    const bool allDone = numPending.load() == 0;
+
+    {
+        Array<Outcome> justFinished;
+
+        {
+            const ScopedLock sl (finishedLock);
+            justFinished.swapWith (finished);
+        }
+
+        for (auto& outcome : justFinished)
+            outcomes.set (outcome.index - 1, outcome);
+    }
+
+    int numLoaded = 0;
+
+    for (auto& outcome : outcomes)
+        if (outcome.loaded)
+            ++numLoaded;
+
+    if (! allDone)
+    {
+        status = numLoaded == outcomes.size() ? String::formatted ("Kit %d loaded, syncing", synth.num_kit)
+                                              : String::formatted ("Kit %d: %d of %d samples loaded", synth.num_kit, numLoaded, outcomes.size());
+    }
+    else
+    {
+        busy = false;
+        progress = 1.0;
+
+        // a sample whose update failed keeps playing its old version
+        kitReady = numLoaded == outcomes.size();
+
+        if (manifestFetched)
+            writeLocalManifest();
+
+        String firstError;
+
+        for (auto& outcome : outcomes)
+            if (firstError.isEmpty() && outcome.error.isNotEmpty())
+                firstError = outcome.name + ": " + outcome.error;
+
+        if (! kitReady)
+            status = String::formatted ("Kit %d: %d sample(s) missing (", synth.num_kit, outcomes.size() - numLoaded) + firstError + ")";
+        else if (numFailed > 0)
+            status = String::formatted ("Kit %d loaded, %d update(s) failed (", synth.num_kit, numFailed.load()) + firstError + ")";
+        else
+            status = String::formatted ("Kit %d loaded", synth.num_kit) + ", " + File::descriptionOfSizeInBytes (getBytesDownloaded()) + " fetched";
+
+        Logger::outputDebugString (status);
+    }
+
+    sendChangeMessage();
+}
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    KitDownloader.h
+    Created: 19 Oct 2026 2:51:44pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef KITDOWNLOADER_H_INCLUDED
+#define KITDOWNLOADER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "DrumSynthesiser.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ Keeps the kits on disk in step with the server, moving only what changed, and
+ loads each pad as soon as its file is there.
+
+ The server holds kitN/TrancheM.aif and, optionally, kitN/manifest.json:
+
+     { "files": [ { "name": "Tranche1.aif", "size": 123456, "sha256": "9f86d0..." }, ... ],
+       "blobs": "blobs" }
+
+ With a manifest the samples are stored by content, once, in blobs/<sha256>
+ under the kit root, and kitN/mysampleM.aif is a link to its blob (a copy
+ where links cannot be made). A kit that shares a sample with another kit
+ shares its blob too. kitN/manifest.json on disk records what was synced:
+ a switch to a kit loads it from disk at once, then fetches the server's
+ manifest and only the blobs that the store does not have. With "blobs", they
+ are fetched from that folder of the server, else from kitN/TrancheM.aif.
+ Without a manifest, a missing file is fetched and nothing is checked.
+
+ At most getMaxParallelDownloads() files are fetched at once, on the threads of
+ a pool. A file is written to file.part and renamed once complete, so a file
+ on disk is always whole. An interrupted transfer resumes from the end of its
+ .part file with an HTTP Range request. With a manifest, the size and the
+ SHA-256 of every file are checked, and a file that does not match is fetched
+ again from the start. A failed attempt is retried after 0.5 s, 1 s, 2 s...
+ up to maxAttempts attempts. The server can be a file:// URL as well.
+
+ A kit with a package (DrumSynthesiser::getKitPackageFile()) is loaded from it
+ and not synced.
+
+ Listeners (the kit menu of the GUI, the headless app) get a change message,
+ on the message thread, each time a pad is loaded and once the kit is done.
+ They read isKitReady(), getStatus() and progress.
+
+ The jobs own the samples they work on. The message thread only sees a copy of
+ each sample's outcome, handed over under a lock once its job is done.
+ */
+class KitDownloader  : public ChangeBroadcaster,
+                       private AsyncUpdater
+{
+public:
+    enum { samplesPerKit = 8, maxAttempts = 5 };
+
+    KitDownloader (DrumSynthesiser& synth);
+    ~KitDownloader();
+
+    /** When false, a kit with missing samples is reported as such instead of fetched. */
+    void setDownloadEnabled (bool shouldDownload) noexcept  { downloadEnabled = shouldDownload; }
+
+    /** URL of the folder holding the kitN/ folders, without the trailing slash. */
+    void setServer (const String& newServerUrl)             { serverUrl = newServerUrl.trimCharactersAtEnd ("/"); }
+    const String& getServer() const noexcept                { return serverUrl; }
+
+    /** Takes effect from the next downloadKit(). */
+    void setMaxParallelDownloads (int newMaximum) noexcept  { maxParallelDownloads = jlimit (1, 16, newMaximum); }
+    int getMaxParallelDownloads() const noexcept            { return maxParallelDownloads; }
+
+    /** Message thread only. Cancels the kit being fetched, whose files resume
+        next time, loads the kit straight away if all its samples are there,
+        then syncs it with the server.
+     */
+    void downloadKit (int kitNumber);
+
+    /** True once every pad has a sample, possibly an old one while an update is fetched. */
+    bool isKitReady() const noexcept                        { return kitReady; }
+    /** Message thread: true from downloadKit() until the change message of the last sample. */
+    bool isBusy() const noexcept                            { return busy; }
+    const String& getStatus() const noexcept                { return status; }
+    /** Samples of the last sync that could not be fetched or linked, missing or left at an old version. */
+    int getNumFailed() const noexcept                       { return numFailed.load(); }
+
+    /** Bytes of the files being fetched that are on disk, resumed ones included. */
+    int64 getBytesDownloaded() const noexcept;
+    /** Sizes of the files being fetched, those known so far. */
+    int64 getTotalBytes() const noexcept;
+
+    /** Fraction of the bytes fetched, for a ProgressBar. */
+    double progress;
+
+private:
+    //==============================================================================
+    /** A sample of the kit: already there, or to fetch. */
+    struct SampleFile
+    {
+        int index;                          // from 1, as in DrumSynthesiser::getSampleFile()
+        String name;                        // in the manifests, e.g. Tranche1.aif
+        File target;                        // what the synth loads
+        File download;                      // what fetchSample() writes: the blob, or target without a manifest
+        URL url;
+        bool isPresent;                     // target was on disk at the switch
+        bool linkToStore;                   // target is to point to download once there
+        SampleFile* fetchedBy;              // the sample of the kit with the same blob that fetches it
+        std::atomic<bool> needsFetch;
+        String expectedHash;                // lowercase hex, empty without a manifest
+        String syncedHash;                  // content of target once synced, for the local manifest
+        std::atomic<int64> expectedSize;    // 0 until known
+        std::atomic<int64> bytesOnDisk;
+        String error;                       // set by its job once done
+        std::atomic<bool> loaded;
+    };
+
+    /** What the message thread knows of a sample, copied from it once its job is done. */
+    struct Outcome
+    {
+        int index;
+        String name, error, syncedHash;
+        bool loaded;
+    };
+
+    class SyncJob;
+    class SampleJob;
+
+    Result fetchManifest (int kitNumber, ThreadPoolJob& job);
+    bool prepareSample (SampleFile& sample, const String& recordedHash);
+    Result fetchSample (SampleFile& sample, ThreadPoolJob& job);
+    Result verify (SampleFile& sample) const;
+    Result linkToStore (SampleFile& sample) const;
+    void sampleDone (SampleFile& sample);
+
+    File getLocalManifestFile() const;
+    StringPairArray readLocalManifest() const;
+    void writeLocalManifest() const;
+    File getBlobFile (const String& hash) const;
+    void updateProgress();
+    static bool waitBeforeRetry (int attempt, ThreadPoolJob& job);
+
+    void handleAsyncUpdate() override;
+    void cancel();
+
+    DrumSynthesiser& synth;
+    std::unique_ptr<ThreadPool> pool;
+    OwnedArray<SampleFile> samples;     // the jobs', once the sync has started
+    Array<Outcome> outcomes;            // message thread, by index - 1
+    Array<Outcome> finished;            // handed over by the jobs, under finishedLock
+    CriticalSection finishedLock;
+    std::atomic<int> numPending, numFailed;
+    std::atomic<bool> manifestFetched;
+    int maxParallelDownloads;
+    String serverUrl;
+    bool downloadEnabled, kitReady, busy;
+    String status;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KitDownloader)
+};
+
+
+#endif  // KITDOWNLOADER_H_INCLUDED
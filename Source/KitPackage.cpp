@@ -0,0 +1,387 @@
+/*
+  ==============================================================================
+
+    KitPackage.cpp
+    Created: 19 Oct 2026 11:02:36pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "KitPackage.h"
+#include "Trace.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+#endif
+
+namespace
+{
+    int64 alignUp (int64 position)
+    {
+        return (position + KitPackage::payloadAlignment - 1) & ~(int64) (KitPackage::payloadAlignment - 1);
+    }
+
+    int64 getRawSize (int numChannels, int numSamples)
+    {
+        return (int64) sizeof (float) * numChannels * (numSamples + SampleBuffer::numGuardSamples);
+    }
+
+    /** Byte b of every sample, for b = 0 (least significant) to 3, so that zlib
+        finds the runs in the exponents and the high bits of the mantissas.
+     */
+    void shuffle (const float* samples, int numSamples, uint8* planes)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            uint32 bits;
+            memcpy (&bits, samples + i, sizeof (bits));
+
+            for (int b = 0; b < 4; ++b)
+                planes[b * numSamples + i] = (uint8) (bits >> (8 * b));
+        }
+    }
+
+    void unshuffle (const uint8* planes, int numSamples, float* samples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            uint32 bits = 0;
+
+            for (int b = 0; b < 4; ++b)
+                bits |= (uint32) planes[b * numSamples + i] << (8 * b);
+
+            memcpy (samples + i, &bits, sizeof (bits));
+        }
+    }
+
+    bool readFully (InputStream& input, void* dest, int numBytes)
+    {
+        for (int done = 0; done < numBytes;)
+        {
+            const int numRead = input.read (static_cast<char*> (dest) + done, numBytes - done);
+
+            if (numRead <= 0)
+                return false;
+
+            done += numRead;
+        }
+
+        return true;
+    }
+
+    void deflate (const SampleBuffer& sample, int numChannels, MemoryBlock& dest)
+    {
+        const int numSamples = sample.getLength();
+        HeapBlock<uint8> planes ((size_t) numSamples * 4);
+        MemoryOutputStream output (dest, false);
+
+        {
+            GZIPCompressorOutputStream zipper (output, 9);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                shuffle (sample.getBuffer().getReadPointer (ch), numSamples, planes);
+                zipper.write (planes, (size_t) numSamples * 4);
+            }
+
+            zipper.flush();
+        }
+    }
+}
+
+//==============================================================================
+KitPackage::Pad::Pad()
+:   padIndex (0),
+    rootNote (36),
+    detune (0),
+    filterType (1),
+    filterActive (0),
+    filterCutoff (1000.0f),
+    sampleStart (0.0f),
+    sampleEnd (1.0f)
+{
+}
+
+KitPackage::KitPackage (const File& f, MemoryMappedFile* m)
+:   file (f),
+    mapping (m),
+    payloadsLocked (false)
+{
+}
+
+KitPackage::~KitPackage()
+{
+    if (payloadsLocked)
+        lockRawPayloads (false);
+}
+
+void KitPackage::lockRawPayloads (bool shouldLock) noexcept
+{
+   #if JUCE_LINUX
+    // the payloads of one package are locked and unlocked together, so pages they share are not an issue
+    for (auto& entry : entries)
+    {
+        if (entry.encoding != raw)
+            continue;
+
+        const char* payload = static_cast<const char*> (mapping->getData()) + entry.offset;
+
+        if (shouldLock)
+            mlock (payload, (size_t) entry.storedSize);
+        else
+            munlock (payload, (size_t) entry.storedSize);
+    }
+
+    payloadsLocked = shouldLock;
+   #else
+    ignoreUnused (shouldLock);
+   #endif
+}
+
+//==============================================================================
+void KitPackage::writeIndex (OutputStream& output, const Array<Entry>& entries)
+{
+    for (auto& entry : entries)
+    {
+        output.writeString (entry.pad.name);
+        output.writeInt (entry.pad.padIndex);
+        output.writeInt (entry.pad.rootNote);
+        output.writeInt (entry.pad.detune);
+        output.writeInt (entry.pad.filterType);
+        output.writeInt (entry.pad.filterActive);
+        output.writeFloat (entry.pad.filterCutoff);
+        output.writeFloat (entry.pad.sampleStart);
+        output.writeFloat (entry.pad.sampleEnd);
+        output.writeInt (entry.numChannels);
+        output.writeInt (entry.numSamples);
+        output.writeDouble (entry.sampleRate);
+        output.writeInt (entry.encoding);
+        output.writeInt64 (entry.offset);
+        output.writeInt64 (entry.storedSize);
+    }
+}
+
+Result KitPackage::write (const File& file, const Array<Pad>& pads, bool compress)
+{
+    TRACE_SCOPE ("write kit package");
+    Array<Entry> entries;
+    OwnedArray<MemoryBlock> deflatedPayloads;
+
+    for (auto& pad : pads)
+    {
+        if (pad.data == nullptr)
+            return Result::fail ("Pad " + String (pad.padIndex) + " has no audio");
+
+        Entry entry;
+        entry.pad = pad;
+        entry.pad.data = nullptr;
+        entry.numChannels = jmin (2, pad.data->getNumChannels());
+        entry.numSamples = pad.data->getLength();
+        entry.sampleRate = pad.data->getSampleRate();
+        entry.encoding = raw;
+        entry.offset = 0;
+        entry.storedSize = getRawSize (entry.numChannels, entry.numSamples);
+
+        MemoryBlock* payload = deflatedPayloads.add (new MemoryBlock());
+
+        if (compress)
+        {
+            deflate (*pad.data, entry.numChannels, *payload);
+
+            if ((int64) payload->getSize() < entry.storedSize)
+            {
+                entry.encoding = deflated;
+                entry.storedSize = (int64) payload->getSize();
+            }
+        }
+
+        entries.add (entry);
+    }
+
+    // the index takes the same room whatever its offsets, so they can be worked out first
+    MemoryOutputStream index;
+    writeIndex (index, entries);
+
+    const int64 headerSize = alignUp (4 * sizeof (int) + (int64) index.getDataSize());
+    int64 offset = headerSize;
+
+    for (auto& entry : entries)
+    {
+        entry.offset = offset;
+        offset = alignUp (offset + entry.storedSize);
+    }
+
+    TemporaryFile temp (file);
+
+    {
+        FileOutputStream output (temp.getFile());
+
+        if (output.failedToOpen())
+            return Result::fail ("Cannot write " + file.getFullPathName());
+
+        output.writeInt (formatMagic);
+        output.writeInt (formatVersion);
+        output.writeInt (entries.size());
+        output.writeInt ((int) headerSize);
+        writeIndex (output, entries);
+
+        for (int i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries.getReference (i);
+            output.writeRepeatedByte (0, (size_t) (entry.offset - output.getPosition()));
+
+            if (entry.encoding == deflated)
+            {
+                output.write (deflatedPayloads[i]->getData(), deflatedPayloads[i]->getSize());
+                continue;
+            }
+
+            const AudioSampleBuffer& audio = pads.getReference (i).data->getBuffer();
+
+            for (int ch = 0; ch < entry.numChannels; ++ch)
+            {
+               #if JUCE_LITTLE_ENDIAN
+                output.write (audio.getReadPointer (ch), sizeof (float) * (size_t) entry.numSamples);
+               #else
+                for (int n = 0; n < entry.numSamples; ++n)
+                    output.writeFloat (audio.getSample (ch, n));
+               #endif
+
+                output.writeRepeatedByte (0, sizeof (float) * SampleBuffer::numGuardSamples);
+            }
+        }
+
+        output.flush();
+
+        if (output.getStatus().failed())
+            return output.getStatus();
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return Result::fail ("Cannot replace " + file.getFullPathName());
+
+    return Result::ok();
+}
+
+//==============================================================================
+Result KitPackage::open (const File& file, Ptr& package)
+{
+    TRACE_SCOPE ("open kit package");
+    std::unique_ptr<MemoryMappedFile> mapping (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+
+    if (mapping->getData() == nullptr)
+        return Result::fail ("Cannot map " + file.getFullPathName());
+
+    const int64 fileSize = (int64) mapping->getSize();
+    MemoryInputStream input (mapping->getData(), mapping->getSize(), false);
+
+    if (input.readInt() != formatMagic)
+        return Result::fail (file.getFileName() + " is not a kit package");
+
+    if (input.readInt() != formatVersion)
+        return Result::fail (file.getFileName() + " is from another version of the package format");
+
+    const int numPads = input.readInt();
+    const int headerSize = input.readInt();
+
+    if (numPads < 0 || numPads > 128 || headerSize > fileSize)
+        return Result::fail (file.getFileName() + ": corrupt header");
+
+    Ptr result (new KitPackage (file, mapping.release()));
+
+    for (int i = 0; i < numPads; ++i)
+    {
+        Entry entry;
+        entry.pad.name = input.readString();
+        entry.pad.padIndex = input.readInt();
+        entry.pad.rootNote = input.readInt();
+        entry.pad.detune = input.readInt();
+        entry.pad.filterType = input.readInt();
+        entry.pad.filterActive = input.readInt();
+        entry.pad.filterCutoff = input.readFloat();
+        entry.pad.sampleStart = input.readFloat();
+        entry.pad.sampleEnd = input.readFloat();
+        entry.numChannels = input.readInt();
+        entry.numSamples = input.readInt();
+        entry.sampleRate = input.readDouble();
+        entry.encoding = input.readInt();
+        entry.offset = input.readInt64();
+        entry.storedSize = input.readInt64();
+
+        const bool isValid = entry.numChannels >= 1 && entry.numChannels <= 2
+                              && entry.numSamples >= 0 && entry.sampleRate > 0.0
+                              && (entry.encoding == raw || entry.encoding == deflated)
+                              && entry.offset >= headerSize && entry.offset % payloadAlignment == 0
+                              && entry.storedSize >= 0 && entry.offset + entry.storedSize <= fileSize
+                              && (entry.encoding != raw || entry.storedSize == getRawSize (entry.numChannels, entry.numSamples));
+
+        if (! isValid || input.getPosition() > headerSize)
+            return Result::fail (file.getFileName() + ": corrupt index entry " + String (i));
+
+        result->entries.add (entry);
+    }
+
+    if (SampleBuffer::isLockingInMemory())
+        result->lockRawPayloads (true);
+
+    package = result;
+    return Result::ok();
+}
+
+Result KitPackage::getSample (int index, SampleBuffer::Ptr& sample)
+{
+    const Entry& entry = entries.getReference (index);
+    const char* payload = static_cast<const char*> (mapping->getData()) + entry.offset;
+    const int stride = entry.numSamples + SampleBuffer::numGuardSamples;
+
+    if (entry.encoding == raw)
+    {
+       #if JUCE_LITTLE_ENDIAN
+        // the mapping is read-only, and so is a sample once loaded
+        float* channels[2];
+
+        for (int ch = 0; ch < entry.numChannels; ++ch)
+            channels[ch] = const_cast<float*> (reinterpret_cast<const float*> (payload)) + ch * stride;
+
+        sample = new SampleBuffer (channels, entry.numChannels, entry.numSamples, entry.sampleRate, this);
+       #else
+        SampleBuffer::Ptr copy (new SampleBuffer (entry.numChannels, entry.numSamples, entry.sampleRate));
+        MemoryInputStream input (payload, (size_t) entry.storedSize, false);
+
+        for (int ch = 0; ch < entry.numChannels; ++ch)
+        {
+            for (int n = 0; n < stride; ++n)
+            {
+                const float value = input.readFloat();
+
+                if (n < entry.numSamples)
+                    copy->getBuffer().setSample (ch, n, value);
+            }
+        }
+
+        sample = copy;
+       #endif
+
+        return Result::ok();
+    }
+
+    TRACE_SCOPE ("inflate sample");
+    MemoryInputStream compressed (payload, (size_t) entry.storedSize, false);
+    GZIPDecompressorInputStream inflater (compressed);
+
+    SampleBuffer::Ptr inflated (new SampleBuffer (entry.numChannels, entry.numSamples, entry.sampleRate));
+    HeapBlock<uint8> planes ((size_t) entry.numSamples * 4);
+
+    for (int ch = 0; ch < entry.numChannels; ++ch)
+    {
+        if (! readFully (inflater, planes, entry.numSamples * 4))
+            return Result::fail (file.getFileName() + ": corrupt audio for " + entry.pad.name);
+
+        unshuffle (planes, entry.numSamples, inflated->getBuffer().getWritePointer (ch));
+    }
+
+    sample = inflated;
+    return Result::ok();
+}
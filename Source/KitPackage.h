@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    KitPackage.h
+    Created: 19 Oct 2026 11:02:36pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef KITPACKAGE_H_INCLUDED
+#define KITPACKAGE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//==============================================================================
+/**
+ A whole kit in one file: an index of the pads (which pad, root note, pitch,
+ filter, start/end, where the audio is) followed by the audio of each pad.
+
+ Little-endian throughout. The header is the magic "SSKP", the version, the
+ number of pads and the offset of the first payload, then one index record
+ per pad. Each payload starts on a 4096-byte boundary.
+
+ A payload is either raw, the 32-bit float channels one after the other,
+ each followed by SampleBuffer::numGuardSamples zeros, or compressed: the
+ bytes of the floats grouped by significance (all the first bytes, then all
+ the second bytes...) and deflated with zlib, which is lossless. The packer
+ only keeps the compressed form when it is smaller.
+
+ open() maps the file once. Raw payloads become SampleBuffers that point
+ into the mapping, and no audio is copied. Compressed ones are inflated into
+ buffers of their own. When SampleBuffer::isLockingInMemory(), the raw payloads
+ are locked in RAM once for the life of the package, whatever the buffers and
+ views on them come and go.
+ */
+class KitPackage    : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<KitPackage> Ptr;
+
+    ~KitPackage();
+
+    enum Encoding { raw = 0, deflated = 1 };
+    enum { formatMagic = 0x504b5353, formatVersion = 1, payloadAlignment = 4096 };   // "SSKP"
+
+    /** A pad as the packer writes it and the reader finds it. */
+    struct Pad
+    {
+        Pad();
+
+        String name;
+        int padIndex, rootNote;
+        int detune, filterType, filterActive;
+        float filterCutoff, sampleStart, sampleEnd;
+        SampleBuffer::Ptr data;     // only given to write()
+    };
+
+    //==============================================================================
+    /** Writes the pads to file, through a temporary file. */
+    static Result write (const File& file, const Array<Pad>& pads, bool compress);
+
+    /** Maps file and reads its index. */
+    static Result open (const File& file, Ptr& package);
+
+    //==============================================================================
+    int getNumPads() const noexcept                         { return entries.size(); }
+
+    /** The settings of a pad, without its audio. */
+    const Pad& getPad (int index) const                     { return entries.getReference (index).pad; }
+
+    bool isMapped (int index) const                         { return entries.getReference (index).encoding == raw; }
+    int64 getStoredSize (int index) const                   { return entries.getReference (index).storedSize; }
+
+    /** The audio of a pad: straight from the mapping when raw, else inflated. */
+    Result getSample (int index, SampleBuffer::Ptr& sample);
+
+    const File& getFile() const noexcept                    { return file; }
+
+private:
+    struct Entry
+    {
+        Pad pad;
+        int numChannels, numSamples;
+        double sampleRate;
+        int encoding;
+        int64 offset, storedSize;
+    };
+
+    KitPackage (const File& file, MemoryMappedFile* mapping);
+    void lockRawPayloads (bool shouldLock) noexcept;
+
+    static void writeIndex (OutputStream& output, const Array<Entry>& entries);
+
+    File file;
+    std::unique_ptr<MemoryMappedFile> mapping;
+    Array<Entry> entries;
+    bool payloadsLocked;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KitPackage)
+};
+
+
+#endif  // KITPACKAGE_H_INCLUDED
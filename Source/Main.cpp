@@ -1,95 +1,115 @@
-/*
-  ==============================================================================
-
-   This file is part of the JUCE library.
-   Copyright (c) 2015 - ROLI Ltd.
-
-   Permission is granted to use this software under the terms of either:
-   a) the GPL v2 (or any later version)
-   b) the Affero GPL v3
-
-   Details of these licenses can be found at: www.gnu.org/licenses
-
-   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
-   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
-   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
-
-   ------------------------------------------------------------------------------
-
-   To release a closed-source product which uses JUCE, commercial licenses are
-   available: visit www.juce.com for more information.
-
-  ==============================================================================
-*/
-
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include <array>
-#include "DrumSynthesiser.h"
-#include "GUI.h"
-#include "CustomMidiKeyboardComponent.h"
-
-struct Simple_Sampler_Classes
-{
-  
-    #include "MainComponent.h" 
-    
-};
-
-
-//==============================================================================
-class Simple_Sampler_Application  : public JUCEApplication
-{
-public:
-    //==============================================================================
-    Simple_Sampler_Application() {}
-
-    const String getApplicationName() override       { return ProjectInfo::projectName; }
-    const String getApplicationVersion() override    { return ProjectInfo::versionString; }
-    bool moreThanOneInstanceAllowed() override       { return true; }
-
-    //==============================================================================
-    void initialise (const String&) override
-    {
-        mainWindow = new MainWindow (getApplicationName());
-    }
-
-    void shutdown() override
-    {
-        mainWindow = nullptr;
-    }
-
-    void systemRequestedQuit() override
-    {
-        quit();
-    }
-
-    //==============================================================================
-    class MainWindow    : public DocumentWindow
-    {
-    public:
-        MainWindow (String name)
-        : DocumentWindow (name, Colour(90,90,90), DocumentWindow::allButtons)
-        {
-            setUsingNativeTitleBar (true);
-            setContentOwned (new Simple_Sampler_Classes::MainComponent(), true);
-            setResizable (true, false);
-            centreWithSize (getWidth(), getHeight());
-            setVisible (true);
-        }
-
-        void closeButtonPressed() override
-        {
-            JUCEApplication::getInstance()->systemRequestedQuit();
-        }
-    private:
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
-    };
-
-private:
-    //==============================================================================
-    ScopedPointer<MainWindow> mainWindow;
-};
-
-//==============================================================================
-START_JUCE_APPLICATION (Simple_Sampler_Application)
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <array>
+#include <iostream>
+#include "SampleBuffer.h"
+#include "BusMixer.h"
+#include "FreezeCache.h"
+#include "DrumSynthesiser.h"
+#include "FXChain.h"
+#include "MasterDynamics.h"
+#include "ConvolutionReverb.h"
+#include "KitDownloader.h"
+#include "RealtimeTuning.h"
+#include "AudioTelemetry.h"
+#include "EngineConfig.h"
+#include "SamplerEngine.h"
+#include "Benchmarks.h"
+#include "GUI.h"
+#include "CustomMidiKeyboardComponent.h"
+
+struct Simple_Sampler_Classes
+{
+  
+    #include "MainComponent.h" 
+    
+};
+
+
+//==============================================================================
+class Simple_Sampler_Application  : public JUCEApplication
+{
+public:
+    //==============================================================================
+    Simple_Sampler_Application() {}
+
+    const String getApplicationName() override       { return ProjectInfo::projectName; }
+    const String getApplicationVersion() override    { return ProjectInfo::versionString; }
+    bool moreThanOneInstanceAllowed() override       { return true; }
+
+    //==============================================================================
+    void initialise (const String& commandLine) override
+    {
+        if (commandLine.contains ("--benchmark"))
+        {
+            std::cout << Benchmarks::runConvolutionReverb() << std::flush;
+            quit();
+            return;
+        }
+
+        mainWindow = new MainWindow (getApplicationName());
+    }
+
+    void shutdown() override
+    {
+        mainWindow = nullptr;
+    }
+
+    void systemRequestedQuit() override
+    {
+        quit();
+    }
+
+    //==============================================================================
+    class MainWindow    : public DocumentWindow
+    {
+    public:
+        MainWindow (String name)
+        : DocumentWindow (name, Colour(90,90,90), DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar (true);
+            setContentOwned (new Simple_Sampler_Classes::MainComponent(), true);
+            setResizable (true, false);
+            centreWithSize (getWidth(), getHeight());
+            setVisible (true);
+        }
+
+        void closeButtonPressed() override
+        {
+            JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+    private:
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
+    };
+
+private:
+    //==============================================================================
+    ScopedPointer<MainWindow> mainWindow;
+};
+
+//==============================================================================
+START_JUCE_APPLICATION (Simple_Sampler_Application)
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    MasterDynamics.cpp
+    Created: 19 Oct 2026 1:22:05pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MasterDynamics.h"
+#include <cmath>
+
+//==============================================================================
+MasterDynamics::Settings::Settings()
+:   enabled (true),
+    thresholdDb (-1.0f),
+    ratio (0.0f),
+    lookaheadMs (2.0f),
+    releaseMs (80.0f),
+    useRmsDetector (false),
+    rmsWindowMs (10.0f),
+    makeUpDb (0.0f)
+{
+}
+
+//==============================================================================
+MasterDynamics::MasterDynamics()
+:   sampleRate (44100.0),
+    maxBlockSize (0),
+    maxLookahead (0),
+    enabled (true),
+    useRms (false),
+    delaySamples (0),
+    windowSize (1),
+    threshold (1.0f),
+    exponent (1.0f),
+    releaseCoef (1.0f),
+    rmsCoef (1.0f),
+    makeUp (1.0f),
+    segmentPosition (0),
+    forwardMinimum (1.0f),
+    boxPosition (0),
+    boxSum (1.0),
+    envelope (1.0f),
+    meanSquare (0.0f),
+    latency (0),
+    gainReductionMeter (0.0f),
+    outputPeakMeter (0.0f)
+{
+}
+
+MasterDynamics::~MasterDynamics()
+{
+}
+
+void MasterDynamics::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = jmax (1, maximumBlockSize);
+    maxLookahead = roundToInt (sampleRate * maxLookaheadMs * 0.001);
+
+    level.calloc ((size_t) maxBlockSize);
+    gain.calloc ((size_t) maxBlockSize);
+    delayLine.setSize (2, maxLookahead + maxBlockSize);
+
+    segmentValues.calloc ((size_t) maxLookahead + 1);
+    suffixMinima.calloc ((size_t) maxLookahead + 2);
+    boxValues.calloc ((size_t) maxLookahead + 1);
+
+    pendingSettings.update();
+    applySettings (currentSettings);
+    reset();
+}
+
+void MasterDynamics::reset() noexcept
+{
+    delayLine.clear();
+    meanSquare = 0.0f;
+    resetDetector();
+}
+
+void MasterDynamics::resetDetector() noexcept
+{
+    if (segmentValues == nullptr)
+        return;
+
+    // a gain of one means "no reduction", which is the neutral value of every stage
+    FloatVectorOperations::fill (segmentValues, 1.0f, windowSize);
+    FloatVectorOperations::fill (suffixMinima, 1.0f, windowSize + 1);
+    FloatVectorOperations::fill (boxValues, 1.0f, windowSize);
+
+    segmentPosition = 0;
+    forwardMinimum = 1.0f;
+    boxPosition = 0;
+    boxSum = windowSize;
+    envelope = 1.0f;
+}
+
+void MasterDynamics::setSettings (const Settings& newSettings)
+{
+    currentSettings = newSettings;
+    pendingSettings.write (newSettings);
+}
+
+void MasterDynamics::applySettings (const Settings& s) noexcept
+{
+    enabled = s.enabled;
+    useRms = s.useRmsDetector;
+
+    threshold = Decibels::decibelsToGain (jmin (0.0f, s.thresholdDb));
+    makeUp = Decibels::decibelsToGain (s.makeUpDb);
+
+    // the required gain is (threshold / level) ^ (1 - 1 / ratio), a ratio of 0 being a limiter
+    if (s.ratio <= 0.0f)
+        exponent = 1.0f;
+    else
+        exponent = s.ratio <= 1.0f ? 0.0f : 1.0f - 1.0f / s.ratio;
+
+    releaseCoef = (float) (1.0 - std::exp (-1.0 / (jmax (1.0f, s.releaseMs) * 0.001 * sampleRate)));
+    rmsCoef = (float) (1.0 - std::exp (-1.0 / (jmax (0.1f, s.rmsWindowMs) * 0.001 * sampleRate)));
+
+    const int newDelay = jlimit (0, maxLookahead, roundToInt (s.lookaheadMs * 0.001 * sampleRate));
+
+    if (newDelay != delaySamples)
+    {
+        delaySamples = newDelay;
+        windowSize = newDelay + 1;
+        resetDetector();
+    }
+
+    latency = enabled ? delaySamples : 0;
+}
+
+void MasterDynamics::processBlock (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    if (pendingSettings.update())
+        applySettings (pendingSettings.read());
+
+    if (! enabled || maxBlockSize == 0)
+        return;
+
+    while (numSamples > 0)
+    {
+        const int numThisTime = jmin (numSamples, maxBlockSize);
+        processChunk (buffer, startSample, numThisTime);
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void MasterDynamics::processChunk (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    const int numChannels = jmin (2, buffer.getNumChannels());
+
+    if (numChannels == 0)
+        return;
+
+    computeRequiredGain (buffer, startSample, numSamples, numChannels);
+    smoothGain (numSamples);
+
+    float outputPeak = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = buffer.getWritePointer (ch, startSample);
+        float* history = delayLine.getWritePointer (ch);
+
+        // history holds the last delaySamples inputs followed by this chunk
+        FloatVectorOperations::copy (history + delaySamples, data, numSamples);
+        FloatVectorOperations::multiply (data, history, gain, numSamples);
+        memmove (history, history + numSamples, sizeof (float) * (size_t) delaySamples);
+
+        if (makeUp != 1.0f)
+            FloatVectorOperations::multiply (data, makeUp, numSamples);
+
+        const Range<float> range (FloatVectorOperations::findMinAndMax (data, numSamples));
+        outputPeak = jmax (outputPeak, -range.getStart(), range.getEnd());
+    }
+
+    const float minimumGain = FloatVectorOperations::findMinimum (gain.get(), numSamples);
+
+    publishMax (gainReductionMeter, -Decibels::gainToDecibels (minimumGain));
+    publishMax (outputPeakMeter, outputPeak);
+}
+
+void MasterDynamics::computeRequiredGain (const AudioSampleBuffer& buffer, int startSample, int numSamples, int numChannels) noexcept
+{
+    const float* left = buffer.getReadPointer (0, startSample);
+    const float* right = buffer.getReadPointer (numChannels - 1, startSample);
+
+    // the detector is linked: both channels get the gain needed by the loudest one
+    if (useRms)
+    {
+        FloatVectorOperations::multiply (level, left, left, numSamples);
+        FloatVectorOperations::multiply (gain, right, right, numSamples);
+        FloatVectorOperations::max (level, level, gain, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            meanSquare += (level[i] - meanSquare) * rmsCoef;
+            level[i] = std::sqrt (meanSquare);
+        }
+    }
+    else
+    {
+        FloatVectorOperations::abs (level, left, numSamples);
+        FloatVectorOperations::abs (gain, right, numSamples);
+        FloatVectorOperations::max (level, level, gain, numSamples);
+    }
+
+    FloatVectorOperations::max (level, level, threshold, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+        gain[i] = threshold / level[i];
+
+    if (exponent != 1.0f)
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = std::pow (gain[i], exponent);
+}
+
+void MasterDynamics::smoothGain (int numSamples) noexcept
+{
+    const double boxScale = 1.0 / windowSize;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float required = gain[i];
+
+        // minimum over the last windowSize samples: running minimum of the current
+        // segment combined with the suffix minima of the previous one
+        segmentValues[segmentPosition] = required;
+        forwardMinimum = segmentPosition == 0 ? required : jmin (forwardMinimum, required);
+        const float held = jmin (forwardMinimum, suffixMinima[segmentPosition + 1]);
+
+        if (++segmentPosition == windowSize)
+        {
+            segmentPosition = 0;
+
+            for (int k = windowSize; --k >= 0;)
+                suffixMinima[k] = jmin (segmentValues[k], suffixMinima[k + 1]);
+        }
+
+        // the box filter reaches the held value exactly windowSize samples after it appears
+        boxSum += held - boxValues[boxPosition];
+        boxValues[boxPosition] = held;
+
+        if (++boxPosition == windowSize)
+            boxPosition = 0;
+
+        const float smoothed = (float) (boxSum * boxScale);
+
+        envelope = smoothed < envelope ? smoothed
+                                       : envelope + (smoothed - envelope) * releaseCoef;
+        gain[i] = envelope;
+    }
+}
+
+void MasterDynamics::publishMax (std::atomic<float>& meter, float value) noexcept
+{
+    float current = meter.load();
+
+    while (value > current && ! meter.compare_exchange_weak (current, value))
+    {}
+}
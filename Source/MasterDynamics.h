@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    MasterDynamics.h
+    Created: 19 Oct 2026 1:22:05pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef MASTERDYNAMICS_H_INCLUDED
+#define MASTERDYNAMICS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ Lookahead limiter / compressor sitting at the very end of the master bus.
+
+ The detector takes the peak (or RMS) of both channels with vector operations,
+ turns it into the gain needed to stay under the threshold, holds the minimum
+ of that gain over the lookahead window and smooths it with a box filter of the
+ same length. The signal is delayed by the lookahead, so the gain has fully
+ come down by the time the peak comes out: nothing gets over the threshold.
+
+ All buffers are sized in prepare() for the longest lookahead, so changing the
+ settings never allocates, and every stage does the same amount of work per
+ sample whatever the signal is.
+ */
+class MasterDynamics
+{
+public:
+    struct Settings
+    {
+        Settings();
+
+        bool enabled;
+        float thresholdDb;
+        float ratio;            // 0 means infinity, i.e. a limiter
+        float lookaheadMs;
+        float releaseMs;
+        bool useRmsDetector;
+        float rmsWindowMs;
+        float makeUpDb;
+    };
+
+    enum { maxLookaheadMs = 20 };
+
+    MasterDynamics();
+    ~MasterDynamics();
+
+    /** Call while the audio device is stopped. */
+    void prepare (double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    void processBlock (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept;
+
+    /** Message thread only. The new settings are applied at the start of the next block. */
+    void setSettings (const Settings& newSettings);
+    const Settings& getSettings() const noexcept            { return currentSettings; }
+
+    /** Delay added by the lookahead, in samples. */
+    int getLatencySamples() const noexcept                  { return latency.load(); }
+
+    /** Largest gain reduction (positive dB) since the last call. For the GUI. */
+    float getAndResetGainReductionDb() noexcept             { return gainReductionMeter.exchange (0.0f); }
+
+    /** Highest output peak (linear) since the last call. */
+    float getAndResetOutputPeak() noexcept                  { return outputPeakMeter.exchange (0.0f); }
+
+private:
+    void applySettings (const Settings&) noexcept;
+    void resetDetector() noexcept;
+    void processChunk (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    void computeRequiredGain (const AudioSampleBuffer&, int startSample, int numSamples, int numChannels) noexcept;
+    void smoothGain (int numSamples) noexcept;
+    static void publishMax (std::atomic<float>&, float) noexcept;
+
+    double sampleRate;
+    int maxBlockSize, maxLookahead;
+
+    bool enabled, useRms;
+    int delaySamples, windowSize;
+    float threshold, exponent, releaseCoef, rmsCoef, makeUp;
+
+    HeapBlock<float> level, gain;
+    AudioSampleBuffer delayLine;
+
+    // sliding minimum over the lookahead (van Herk / Gil-Werman, fixed cost per sample)
+    HeapBlock<float> segmentValues, suffixMinima;
+    int segmentPosition;
+    float forwardMinimum;
+
+    // moving average of the held gain
+    HeapBlock<float> boxValues;
+    int boxPosition;
+    double boxSum;
+
+    float envelope, meanSquare;
+
+    Settings currentSettings;
+    TripleBuffer<Settings> pendingSettings;
+
+    std::atomic<int> latency;
+    std::atomic<float> gainReductionMeter, outputPeakMeter;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterDynamics)
+};
+
+
+#endif  // MASTERDYNAMICS_H_INCLUDED
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    MidiEventQueue.h
+    Created: 19 Oct 2026 8:41:07pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef MIDIEVENTQUEUE_H_INCLUDED
+#define MIDIEVENTQUEUE_H_INCLUDED
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ Carries MIDI messages from the MIDI and message threads to the audio thread,
+ in place of a MidiMessageCollector, which locks on both sides.
+
+ The events live in a fixed array handed over through an AbstractFifo, so the
+ audio thread neither locks nor allocates. The writers, which can be several
+ (a MIDI device and the on-screen keyboard), take a SpinLock between
+ themselves only. Messages longer than 3 bytes (sysex) are dropped: nothing
+ in the sampler reacts to them.
+ */
+class MidiEventQueue
+{
+public:
+    enum { capacity = 1024 };
+
+    MidiEventQueue() : fifo (capacity) {}
+
+    /** Any thread. The timestamp is in seconds, on the Time::getMillisecondCounterHiRes()
+        clock, like the messages of the MIDI devices. Returns false if the message
+        was dropped, because the queue is full or the message too long.
+     */
+    bool push (const MidiMessage& message) noexcept
+    {
+        const int size = message.getRawDataSize();
+
+        if (size > 3)
+            return false;
+
+        const SpinLock::ScopedLockType sl (writerLock);
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return false;
+
+        Event& event = events[size1 > 0 ? start1 : start2];
+        event.time = message.getTimeStamp();
+        event.size = (uint8) size;
+        memcpy (event.data, message.getRawData(), (size_t) size);
+
+        fifo.finishedWrite (1);
+        return true;
+    }
+
+    /** Audio thread: moves every queued message into destination, which should
+        have room for capacity events. Each lands where it would have with a
+        block of latency: a message from 2 ms ago goes 2 ms before the end.
+     */
+    void popInto (MidiBuffer& destination, int numSamples, double sampleRate, double nowSeconds) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1 + size2; ++i)
+        {
+            const Event& event = events[i < size1 ? start1 + i : start2 + i - size1];
+            const int age = roundToInt ((nowSeconds - event.time) * sampleRate);
+
+            destination.addEvent (event.data, event.size, jlimit (0, numSamples - 1, numSamples - 1 - age));
+        }
+
+        fifo.finishedRead (size1 + size2);
+    }
+
+    /** Reader side, while the audio is stopped: forgets what was queued meanwhile. */
+    void discardAll() noexcept
+    {
+        fifo.finishedRead (fifo.getNumReady());
+    }
+
+private:
+    struct Event
+    {
+        double time;
+        uint8 data[3];
+        uint8 size;
+    };
+
+    AbstractFifo fifo;
+    Event events[capacity];
+    SpinLock writerLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiEventQueue)
+};
+
+
+#endif  // MIDIEVENTQUEUE_H_INCLUDED
@@ -0,0 +1,360 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 19 Oct 2026 5:02:36pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+#include "SamplerEngine.h"
+#include "RealtimeChecker.h"
+#include "Trace.h"
+#include <atomic>
+
+namespace
+{
+    int greatestCommonDivisor (int a, int b)
+    {
+        while (b != 0)
+        {
+            const int r = a % b;
+            a = b;
+            b = r;
+        }
+
+        return a;
+    }
+}
+
+//==============================================================================
+OfflineRenderer::Options::Options()
+:   sampleRate (48000.0),
+    blockSize (512),
+    numThreads (1),
+    tailSeconds (-1.0)
+{
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer (const EngineConfig& engineConfig)
+:   config (engineConfig),
+    impulseResponseRate (0.0)
+{
+    zerostruct (stats);
+
+    if (config.impulseResponse.existsAsFile())
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (config.impulseResponse));
+
+        if (reader != nullptr && reader->sampleRate > 0)
+        {
+            impulseResponse.setSize (jmin (2, (int) reader->numChannels), (int) reader->lengthInSamples);
+            reader->read (&impulseResponse, 0, impulseResponse.getNumSamples(), 0, true, true);
+            impulseResponseRate = reader->sampleRate;
+        }
+    }
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+}
+
+//==============================================================================
+Result OfflineRenderer::prepareEngine (SamplerEngine& engine, const Options& options, SamplerEngine* loadedEngine) const
+{
+    engine.applySettings (config);
+
+    // which pads get frozen depends on wall-clock time, it would make renders differ
+    DrumSynthesiser& synth = engine.getSynth();
+    synth.getFreezeCache().setEnabled (false);
+    synth.num_kit = config.kit;
+    synth.nb_samples = KitDownloader::samplesPerKit;
+
+    if (loadedEngine != nullptr)
+    {
+        synth.copyPadsFrom (loadedEngine->getSynth());
+    }
+    else
+    {
+        const Result loaded (synth.loadKit());
+
+        if (loaded.failed())
+            return Result::fail (loaded.getErrorMessage() + ", run the sampler once to download the kit");
+    }
+
+    engine.prepareToPlay (options.sampleRate, options.blockSize);
+
+    // after prepareToPlay(), so that the IR is resampled to the render rate
+    if (impulseResponse.getNumSamples() > 0)
+        engine.getReverb().setImpulseResponse (impulseResponse, impulseResponseRate, false);
+
+    return Result::ok();
+}
+
+int OfflineRenderer::getVoiceLength (SamplerEngine& engine, int midiNoteNumber, double sampleRate) const
+{
+    DrumSynthesiser& synth = engine.getSynth();
+    double longest = 0.0;
+
+    // a voice plays to the end of its sample at worst, whatever the note-off does
+    for (int i = 0; i < synth.getNumSounds(); ++i)
+    {
+        if (CustomSamplerSound* sound = dynamic_cast<CustomSamplerSound*> (synth.getSound (i).get()))
+        {
+            const SampleBuffer::Ptr data (sound->getSampleData());
+
+            if (data == nullptr || ! sound->appliesToNote (midiNoteNumber))
+                continue;
+
+            const double pitchRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote + sound->detune) / 12.0)
+                                        * data->getSampleRate() / sampleRate;
+            const double sourceLength = data->getLength() * jmax (0.0f, sound->sample_end - sound->sample_start);
+
+            longest = jmax (longest, sourceLength / pitchRatio + sound->getReleaseTime() * sampleRate);
+        }
+    }
+
+    return (int) std::ceil (longest) + 1;
+}
+
+int OfflineRenderer::getEffectTail (SamplerEngine& engine, double sampleRate) const
+{
+    const MasterDynamics::Settings& limiter = engine.getLimiter().getSettings();
+
+    // the release is a one-pole, 20 time constants bring it within 1e-8 of unity gain
+    const double seconds = engine.getReverb().getImpulseResponseLengthSeconds()
+                            + (limiter.lookaheadMs + limiter.rmsWindowMs + 20.0f * limiter.releaseMs) * 0.001
+                            + 0.1; // the master EQ ringing out
+
+    return (int) std::ceil (seconds * sampleRate);
+}
+
+Array<int> OfflineRenderer::chooseSplits (const Array<int>& candidates, int totalLength, int numParts) const
+{
+    Array<int> splits;
+
+    for (int part = 1; part < numParts; ++part)
+    {
+        const int target = (int) ((int64) totalLength * part / numParts);
+        int best = -1;
+
+        for (auto candidate : candidates)
+            if ((splits.isEmpty() || candidate > splits.getLast())
+                 && (best < 0 || std::abs (candidate - target) < std::abs (best - target)))
+                best = candidate;
+
+        if (best > 0 && best < totalLength)
+            splits.addIfNotAlreadyThere (best);
+    }
+
+    return splits;
+}
+
+//==============================================================================
+Result OfflineRenderer::render (const MidiFile& midiFile, const Options& options, AudioSampleBuffer& result)
+{
+    const double startTime = Time::getMillisecondCounterHiRes();
+    zerostruct (stats);
+
+    if (options.sampleRate <= 0 || options.blockSize <= 0)
+        return Result::fail ("Invalid sample rate or block size");
+
+    // all the tracks on one timeline, in samples
+    MidiFile file (midiFile);
+    file.convertTimestampTicksToSeconds();
+
+    MidiMessageSequence sequence;
+
+    for (int t = 0; t < file.getNumTracks(); ++t)
+        sequence.addSequence (*file.getTrack (t), 0.0);
+
+    for (int i = 0; i < sequence.getNumEvents(); ++i)
+    {
+        MidiMessage& message = sequence.getEventPointer (i)->message;
+        message.setTimeStamp (std::round (message.getTimeStamp() * options.sampleRate));
+    }
+
+    SamplerEngine firstEngine;
+    const Result prepared (prepareEngine (firstEngine, options));
+
+    if (prepared.failed())
+        return prepared;
+
+    // find where the file can be cut, and how long it is
+    const int effectTail = getEffectTail (firstEngine, options.sampleRate);
+    const int partitionSize = firstEngine.getReverb().getPartitionSize();
+    const int alignment = options.blockSize / greatestCommonDivisor (options.blockSize, partitionSize) * partitionSize;
+
+    Array<int> candidates;
+    int activeUntil = 0, lastEvent = 0;
+
+    for (int i = 0; i < sequence.getNumEvents(); ++i)
+    {
+        const MidiMessage& message = sequence.getEventPointer (i)->message;
+        const int time = (int) message.getTimeStamp();
+
+        if (message.isMetaEvent())
+            continue;
+
+        lastEvent = jmax (lastEvent, time);
+
+        if (! message.isNoteOn())
+            continue;
+
+        const int boundary = time / alignment * alignment;
+
+        if (boundary > 0 && boundary >= activeUntil + effectTail)
+            candidates.add (boundary);
+
+        activeUntil = jmax (activeUntil, time + getVoiceLength (firstEngine, message.getNoteNumber(), options.sampleRate));
+    }
+
+    const int tail = options.tailSeconds >= 0.0 ? roundToInt (options.tailSeconds * options.sampleRate)
+                                                : effectTail;
+    const int totalLength = jmax (activeUntil, lastEvent) + tail;
+
+    const int numThreads = options.numThreads > 0 ? options.numThreads : SystemStats::getNumCpus();
+    Array<int> bounds (chooseSplits (candidates, totalLength, jmax (1, numThreads)));
+    bounds.insert (0, 0);
+    bounds.add (totalLength);
+
+    result.setSize (2, totalLength);
+    result.clear();
+
+    // the parts write to their own ranges through these, without touching the buffer itself
+    float* const* destination = result.getArrayOfWritePointers();
+
+    // every part but the first renders on its own engine in the pool
+    {
+        ThreadPool pool (jmax (1, bounds.size() - 2));
+        std::atomic<int> numPending (bounds.size() - 2);
+        WaitableEvent allDone;
+        CriticalSection errorLock;
+        String error;
+
+        for (int part = 1; part < bounds.size() - 1; ++part)
+        {
+            const int start = bounds[part], end = bounds[part + 1];
+
+            pool.addJob ([&, start, end]
+            {
+                const ScopedNoDenormals noDenormals;
+                // the samples are shared with the first engine, not decoded again
+                SamplerEngine engine;
+                const Result r (prepareEngine (engine, options, &firstEngine));
+
+                if (r.wasOk())
+                    renderRange (engine, sequence, start, end, options.blockSize, destination);
+                else
+                {
+                    const ScopedLock sl (errorLock);
+                    error = r.getErrorMessage();
+                }
+
+                if (--numPending == 0)
+                    allDone.signal();
+            });
+        }
+
+        {
+            const ScopedNoDenormals noDenormals;
+            renderRange (firstEngine, sequence, bounds[0], bounds[1], options.blockSize, destination);
+        }
+
+        if (bounds.size() > 2)
+            allDone.wait();
+
+        if (error.isNotEmpty())
+            return Result::fail (error);
+    }
+
+    stats.audioSeconds = totalLength / options.sampleRate;
+    stats.renderSeconds = (Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    stats.numSegments = bounds.size() - 1;
+
+    return Result::ok();
+}
+
+void OfflineRenderer::renderRange (SamplerEngine& engine, const MidiMessageSequence& sequence,
+                                   int startSample, int endSample, int blockSize,
+                                   float* const* destination) const
+{
+    TRACE_THREAD_NAME ("offline render");
+    AudioSampleBuffer block (2, blockSize);
+    MidiBuffer midi;
+    int index = sequence.getNextIndexAtTime ((double) startSample);
+
+    for (int position = startSample; position < endSample; position += blockSize)
+    {
+        const int numSamples = jmin (blockSize, endSample - position);
+        midi.clear();
+
+        for (; index < sequence.getNumEvents(); ++index)
+        {
+            const MidiMessage& message = sequence.getEventPointer (index)->message;
+            const int time = (int) message.getTimeStamp();
+
+            if (time >= position + numSamples)
+                break;
+
+            if (! message.isMetaEvent())
+                midi.addEvent (message, time - position);
+        }
+
+        block.clear();
+
+        {
+            // the same code as in the audio callback, so it is held to the same rules
+            RT_CHECK_SCOPE;
+            engine.renderBlock (block, 0, numSamples, midi);
+        }
+
+        for (int ch = 0; ch < 2; ++ch)
+            FloatVectorOperations::copy (destination[ch] + position, block.getReadPointer (ch), numSamples);
+    }
+}
+
+//==============================================================================
+Result OfflineRenderer::readMidiFile (const File& file, MidiFile& midiFile)
+{
+    FileInputStream stream (file);
+
+    if (! stream.openedOk())
+        return Result::fail ("Cannot open " + file.getFullPathName());
+
+    if (! midiFile.readFrom (stream))
+        return Result::fail (file.getFileName() + " is not a standard MIDI file");
+
+    return Result::ok();
+}
+
+Result OfflineRenderer::writeWavFile (const AudioSampleBuffer& audio, double sampleRate, int bitsPerSample, const File& file)
+{
+    file.deleteFile();
+    std::unique_ptr<FileOutputStream> stream (file.createOutputStream());
+
+    if (stream == nullptr)
+        return Result::fail ("Cannot write " + file.getFullPathName());
+
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate, (unsigned int) audio.getNumChannels(),
+                                                                    bitsPerSample, StringPairArray(), 0));
+
+    if (writer == nullptr)
+        return Result::fail (String (bitsPerSample) + "-bit WAV files are not supported");
+
+    // the writer owns the stream now
+    stream.release();
+
+    if (! writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples()))
+        return Result::fail ("Error while writing " + file.getFullPathName());
+
+    return Result::ok();
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 19 Oct 2026 5:02:36pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef OFFLINERENDERER_H_INCLUDED
+#define OFFLINERENDERER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "EngineConfig.h"
+
+class SamplerEngine;
+
+//==============================================================================
+/**
+ Plays a MIDI file through the whole engine (synth, buses, reverb, master
+ chain and limiter) as fast as possible, without an audio device.
+
+ The result only depends on the MIDI file, the config, the sample rate and
+ the block size, so two renders of the same input give the same output.
+
+ Long files can be split across threads. The kit is loaded once, and the
+ engine of each part plays the very same sample buffers. A split is only made where
+ everything started before it has died out: voices, reverb tail and limiter
+ release. It also falls on a multiple of the block size and the reverb
+ partition. The voices and the reverb start each part as they would in a
+ single-threaded render, but the filters and the limiter have only settled to
+ within rounding at the boundary, so a split render is close to a single one
+ rather than identical to it.
+ */
+class OfflineRenderer
+{
+public:
+    struct Options
+    {
+        Options();
+
+        double sampleRate;
+        int blockSize;
+        int numThreads;         // 1: a single engine renders the whole file
+        double tailSeconds;     // rendered after the last note, < 0 for the longest possible tail
+    };
+
+    struct Stats
+    {
+        double audioSeconds, renderSeconds;
+        int numSegments;
+    };
+
+    explicit OfflineRenderer (const EngineConfig& config);
+    ~OfflineRenderer();
+
+    /** Renders the file into a stereo buffer, resized to fit. */
+    Result render (const MidiFile& midiFile, const Options& options, AudioSampleBuffer& result);
+
+    const Stats& getLastStats() const noexcept              { return stats; }
+
+    //==============================================================================
+    static Result readMidiFile (const File& file, MidiFile& midiFile);
+    static Result writeWavFile (const AudioSampleBuffer& audio, double sampleRate, int bitsPerSample, const File& file);
+
+private:
+    Result prepareEngine (SamplerEngine&, const Options&, SamplerEngine* loadedEngine = nullptr) const;
+    void renderRange (SamplerEngine&, const MidiMessageSequence&, int startSample, int endSample,
+                      int blockSize, float* const* destination) const;
+    int getVoiceLength (SamplerEngine&, int midiNoteNumber, double sampleRate) const;
+    int getEffectTail (SamplerEngine&, double sampleRate) const;
+    Array<int> chooseSplits (const Array<int>& candidates, int totalLength, int numParts) const;
+
+    EngineConfig config;
+    AudioSampleBuffer impulseResponse;
+    double impulseResponseRate;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
+
+
+#endif  // OFFLINERENDERER_H_INCLUDED
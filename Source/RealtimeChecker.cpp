@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.cpp
+    Created: 19 Oct 2026 8:05:41pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RealtimeChecker.h"
+#include <atomic>
+#include <iostream>
+
+#if SIMPLE_SAMPLER_RT_CHECK && JUCE_LINUX
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <unistd.h>
+ #include <ctime>
+ #include <cstdarg>
+#endif
+
+// the hooks run before anything is initialised and inside malloc itself: the
+// thread state must be plain static TLS, which never allocates
+#if JUCE_LINUX && (JUCE_GCC || JUCE_CLANG)
+ #define RT_CHECK_TLS   __attribute__ ((tls_model ("initial-exec"))) thread_local
+#else
+ #define RT_CHECK_TLS   thread_local
+#endif
+
+namespace
+{
+    RT_CHECK_TLS int realtimeDepth = 0;
+    RT_CHECK_TLS bool isReporting = false;
+
+    std::atomic<int64> numViolations[RealtimeChecker::numKinds];
+    std::atomic<int> numCallSites (0);
+
+    // hashes of the stacks already reported, 0 marks a free slot
+    const int maxCallSites = 512;
+    std::atomic<uint64> reportedSites[maxCallSites];
+
+    // mutexes whose locks are not reported, nullptr marks a free slot
+    const int maxAllowedLocks = 128;     // one per synth, and the offline renderer makes one per thread
+    std::atomic<const void*> allowedLocks[maxAllowedLocks];
+
+    bool isAllowedLock (const void* mutex) noexcept
+    {
+        for (auto& slot : allowedLocks)
+            if (slot.load (std::memory_order_relaxed) == mutex)
+                return true;
+
+        return false;
+    }
+
+    /** False if the site was reported before, or if the table is full. */
+    bool rememberSite (uint64 hash) noexcept
+    {
+        hash = jmax ((uint64) 1, hash);
+
+        for (int i = 0; i < maxCallSites; ++i)
+        {
+            std::atomic<uint64>& slot = reportedSites[(size_t) ((hash + (uint64) i) % (uint64) maxCallSites)];
+            uint64 expected = 0;
+
+            if (slot.compare_exchange_strong (expected, hash))
+            {
+                ++numCallSites;
+                return true;
+            }
+
+            if (expected == hash)
+                return false;
+        }
+
+        return false;
+    }
+
+    const char* getKindName (RealtimeChecker::Kind kind) noexcept
+    {
+        switch (kind)
+        {
+            case RealtimeChecker::allocation:      return "heap allocation";
+            case RealtimeChecker::deallocation:    return "heap deallocation";
+            case RealtimeChecker::lock:            return "lock";
+            case RealtimeChecker::blockingCall:    return "blocking call";
+            case RealtimeChecker::numKinds:        break;
+        }
+
+        return "call";
+    }
+}
+
+//==============================================================================
+bool RealtimeChecker::isInRealtimeContext() noexcept
+{
+    return realtimeDepth > 0;
+}
+
+void RealtimeChecker::check (Kind kind, const char* function) noexcept
+{
+    if (realtimeDepth == 0 || isReporting)
+        return;
+
+    isReporting = true;
+    ++numViolations[kind];
+
+   #if JUCE_LINUX
+    // frames only, the symbols are looked up when printing
+    void* frames[64];
+    const int numFrames = backtrace (frames, 64);
+    uint64 hash = 14695981039346656037ull;
+
+    for (int i = 1; i < numFrames; ++i)
+        hash = (hash ^ (uint64) (pointer_sized_uint) frames[i]) * 1099511628211ull;
+
+    if (rememberSite (hash))
+    {
+        std::cerr << "Real-time violation: " << getKindName (kind) << " (" << function << ") in a real-time scope" << std::endl;
+        backtrace_symbols_fd (frames + 1, numFrames - 1, STDERR_FILENO);
+        std::cerr << std::endl;
+    }
+   #else
+    const String stack (SystemStats::getStackBacktrace());
+
+    if (rememberSite ((uint64) stack.hashCode64()))
+        std::cerr << "Real-time violation: " << getKindName (kind) << " (" << function << ") in a real-time scope\n"
+                  << stack << std::endl;
+   #endif
+
+    isReporting = false;
+}
+
+void RealtimeChecker::checkLock (const void* mutex, const char* function) noexcept
+{
+    if (realtimeDepth == 0 || isReporting || isAllowedLock (mutex))
+        return;
+
+    check (lock, function);
+}
+
+void RealtimeChecker::addAllowedLock (const void* mutex) noexcept
+{
+    if (mutex == nullptr || isAllowedLock (mutex))
+        return;
+
+    for (auto& slot : allowedLocks)
+    {
+        const void* expected = nullptr;
+
+        if (slot.compare_exchange_strong (expected, mutex))
+            return;
+    }
+
+    jassertfalse;   // more allowed mutexes than slots: the extra ones are reported
+}
+
+void RealtimeChecker::removeAllowedLock (const void* mutex) noexcept
+{
+    for (auto& slot : allowedLocks)
+    {
+        const void* expected = mutex;
+
+        if (slot.compare_exchange_strong (expected, nullptr))
+            return;
+    }
+}
+
+int64 RealtimeChecker::getNumViolations (Kind kind) noexcept
+{
+    return numViolations[kind].load();
+}
+
+int64 RealtimeChecker::getNumViolations() noexcept
+{
+    int64 total = 0;
+
+    for (auto& count : numViolations)
+        total += count.load();
+
+    return total;
+}
+
+int RealtimeChecker::getNumCallSites() noexcept
+{
+    return numCallSites.load();
+}
+
+String RealtimeChecker::getSummary()
+{
+    if (! isCompiledIn())
+        return {};
+
+    return String (getNumViolations()) + " real-time violation(s) at " + String (getNumCallSites()) + " call site(s)";
+}
+
+RealtimeChecker::ScopedRealtime::ScopedRealtime() noexcept
+{
+    ++realtimeDepth;
+}
+
+RealtimeChecker::ScopedRealtime::~ScopedRealtime() noexcept
+{
+    --realtimeDepth;
+}
+
+//==============================================================================
+#if SIMPLE_SAMPLER_RT_CHECK
+ #if JUCE_LINUX
+
+namespace
+{
+    /** The next definition of a function replaced below, normally glibc's. A plain
+        atomic rather than a function-local static: its guard could take a mutex.
+     */
+    template <typename FunctionType>
+    FunctionType getNext (std::atomic<void*>& cache, const char* name) noexcept
+    {
+        void* function = cache.load (std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            function = dlsym (RTLD_NEXT, name);
+            cache.store (function, std::memory_order_relaxed);
+        }
+
+        return reinterpret_cast<FunctionType> (function);
+    }
+
+    std::atomic<void*> nextMutexLock, nextSemWait, nextNanosleep, nextUsleep, nextOpen, nextRead, nextWrite, nextFsync;
+}
+
+// glibc's allocator under its internal names, so that these replace malloc without a dlsym
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void __libc_free (void*);
+
+    void* malloc (size_t size)
+    {
+        RealtimeChecker::check (RealtimeChecker::allocation, "malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t numElements, size_t elementSize)
+    {
+        RealtimeChecker::check (RealtimeChecker::allocation, "calloc");
+        return __libc_calloc (numElements, elementSize);
+    }
+
+    void* realloc (void* block, size_t size)
+    {
+        RealtimeChecker::check (RealtimeChecker::allocation, "realloc");
+        return __libc_realloc (block, size);
+    }
+
+    void free (void* block)
+    {
+        if (block != nullptr)
+            RealtimeChecker::check (RealtimeChecker::deallocation, "free");
+
+        __libc_free (block);
+    }
+
+    // CriticalSection and std::mutex both end up here; trylock never blocks, so it is left alone
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        RealtimeChecker::checkLock (mutex, "pthread_mutex_lock");
+        return getNext<int (*) (pthread_mutex_t*)> (nextMutexLock, "pthread_mutex_lock") (mutex);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        RealtimeChecker::check (RealtimeChecker::lock, "sem_wait");
+        return getNext<int (*) (sem_t*)> (nextSemWait, "sem_wait") (semaphore);
+    }
+
+    int nanosleep (const struct timespec* duration, struct timespec* remaining)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "nanosleep");
+        return getNext<int (*) (const struct timespec*, struct timespec*)> (nextNanosleep, "nanosleep") (duration, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "usleep");
+        return getNext<int (*) (useconds_t)> (nextUsleep, "usleep") (microseconds);
+    }
+
+    // the mode is only passed when a file may be created
+    int open (const char* path, int flags, ...)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "open");
+        mode_t mode = 0;
+
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start (args, flags);
+            mode = (mode_t) va_arg (args, int);
+            va_end (args);
+        }
+
+        return getNext<int (*) (const char*, int, ...)> (nextOpen, "open") (path, flags, mode);
+    }
+
+    ssize_t read (int fd, void* buffer, size_t size)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "read");
+        return getNext<ssize_t (*) (int, void*, size_t)> (nextRead, "read") (fd, buffer, size);
+    }
+
+    ssize_t write (int fd, const void* buffer, size_t size)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "write");
+        return getNext<ssize_t (*) (int, const void*, size_t)> (nextWrite, "write") (fd, buffer, size);
+    }
+
+    int fsync (int fd)
+    {
+        RealtimeChecker::check (RealtimeChecker::blockingCall, "fsync");
+        return getNext<int (*) (int)> (nextFsync, "fsync") (fd);
+    }
+}
+
+ #else
+
+// only the C++ allocations can be caught portably
+void* operator new (size_t size)
+{
+    RealtimeChecker::check (RealtimeChecker::allocation, "operator new");
+
+    if (void* block = std::malloc (jmax ((size_t) 1, size)))
+        return block;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)
+{
+    return operator new (size);
+}
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeChecker::check (RealtimeChecker::allocation, "operator new");
+    return std::malloc (jmax ((size_t) 1, size));
+}
+
+void* operator new[] (size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new (size, tag);
+}
+
+void operator delete (void* block) noexcept
+{
+    if (block != nullptr)
+        RealtimeChecker::check (RealtimeChecker::deallocation, "operator delete");
+
+    std::free (block);
+}
+
+void operator delete[] (void* block) noexcept                           { operator delete (block); }
+void operator delete (void* block, size_t) noexcept                     { operator delete (block); }
+void operator delete[] (void* block, size_t) noexcept                   { operator delete (block); }
+void operator delete (void* block, const std::nothrow_t&) noexcept      { operator delete (block); }
+void operator delete[] (void* block, const std::nothrow_t&) noexcept    { operator delete (block); }
+
+ #endif
+#endif
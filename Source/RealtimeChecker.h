@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.h
+    Created: 19 Oct 2026 8:05:41pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef REALTIMECHECKER_H_INCLUDED
+#define REALTIMECHECKER_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/** Set to 1 in the Projucer's preprocessor definitions, in a debug build, to
+    check the real-time code. At 0 RT_CHECK_SCOPE expands to nothing and no
+    allocator or system function is replaced.
+ */
+#ifndef SIMPLE_SAMPLER_RT_CHECK
+ #define SIMPLE_SAMPLER_RT_CHECK 0
+#endif
+
+//==============================================================================
+/**
+ Reports, with a stack trace, every heap allocation, lock or blocking call made
+ inside an RT_CHECK_SCOPE: the audio callback, and the render of each block
+ offline.
+
+ A thread-local depth marks the real-time code. The checks sit in hooks:
+ - on Linux, malloc/calloc/realloc/free (which operator new and HeapBlock go
+   through), pthread_mutex_lock, sem_wait, nanosleep, usleep, open, read,
+   write and fsync are replaced by versions that check, then call glibc's;
+ - elsewhere only operator new and delete are replaced.
+
+ Each call site is reported once, on stderr, from the thread that made the
+ call: reporting is slow, which is fine for a debug build whose point is to
+ find the site. Nothing made while reporting is checked.
+
+ A mutex known to be taken on the audio thread on purpose can be allowed with
+ addAllowedLock(); locking it is then not counted.
+ */
+class RealtimeChecker
+{
+public:
+    enum Kind
+    {
+        allocation,
+        deallocation,
+        lock,
+        blockingCall,
+        numKinds
+    };
+
+    static constexpr bool isCompiledIn() noexcept           { return SIMPLE_SAMPLER_RT_CHECK != 0; }
+
+    /** True inside an RT_CHECK_SCOPE on the calling thread. */
+    static bool isInRealtimeContext() noexcept;
+
+    /** Called by the hooks: reports the call if the thread is in a real-time
+        scope and this call site has not been reported yet.
+     */
+    static void check (Kind kind, const char* function) noexcept;
+
+    /** Same, for a lock of the given mutex: not reported when it was allowed. */
+    static void checkLock (const void* mutex, const char* function) noexcept;
+
+    /** Stops reporting the locks of a mutex, e.g. the one JUCE's Synthesiser takes
+        around every block. A CriticalSection can be passed as it is, it holds
+        nothing but its mutex. Remove it before the mutex is destroyed.
+     */
+    static void addAllowedLock (const void* mutex) noexcept;
+    static void removeAllowedLock (const void* mutex) noexcept;
+
+    /** Violations counted since the start, of one kind or all, and the distinct
+        call sites reported.
+     */
+    static int64 getNumViolations (Kind kind) noexcept;
+    static int64 getNumViolations() noexcept;
+    static int getNumCallSites() noexcept;
+
+    /** One line for the end of a run, empty when the checks are compiled out. */
+    static String getSummary();
+
+    //==============================================================================
+    struct ScopedRealtime
+    {
+        ScopedRealtime() noexcept;
+        ~ScopedRealtime() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtime)
+    };
+};
+
+#if SIMPLE_SAMPLER_RT_CHECK
+ #define RT_CHECK_SCOPE     const RealtimeChecker::ScopedRealtime JUCE_JOIN_MACRO (realtimeScope_, __LINE__)
+#else
+ #define RT_CHECK_SCOPE
+#endif
+
+
+#endif  // REALTIMECHECKER_H_INCLUDED
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    RealtimeTuning.cpp
+    Created: 19 Oct 2026 4:18:53pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RealtimeTuning.h"
+#include "SampleBuffer.h"
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+ #include <sys/mman.h>
+ #include <cerrno>
+ #include <cstring>
+#endif
+
+namespace
+{
+    String describeError (int error)
+    {
+       #if JUCE_LINUX
+        if (error == EPERM)
+            return "permission denied";
+
+        return String (std::strerror (error));
+       #else
+        return String (error);
+       #endif
+    }
+}
+
+//==============================================================================
+RealtimeTuning::Settings::Settings()
+:   enabled (false),
+    priority (80),
+    audioCpu (-1),
+    lockMemory (false)
+{
+}
+
+RealtimeTuning::RealtimeTuning()
+:   audioThreadPending (false),
+    audioThreadTuned (false),
+    schedError (0),
+    affinityError (0)
+{
+}
+
+void RealtimeTuning::apply (const Settings& newSettings)
+{
+    settings = newSettings;
+    settings.priority = jlimit (1, 99, settings.priority);
+    audioThreadTuned = false;
+    processReport.clear();
+
+    if (! settings.enabled)
+        return;
+
+   #if JUCE_LINUX
+    const int numCpus = SystemStats::getNumCpus();
+
+    if (settings.audioCpu >= numCpus)
+    {
+        processReport << "Audio CPU " << settings.audioCpu << " does not exist (" << numCpus << " CPUs), affinity left alone\n";
+        settings.audioCpu = -1;
+    }
+    else if (settings.audioCpu >= 0 && numCpus < 2)
+    {
+        processReport << "Single CPU, affinity left alone\n";
+        settings.audioCpu = -1;
+    }
+
+    if (settings.audioCpu >= 0)
+    {
+        cpu_set_t others;
+        CPU_ZERO (&others);
+
+        for (int cpu = 0; cpu < numCpus; ++cpu)
+            if (cpu != settings.audioCpu)
+                CPU_SET (cpu, &others);
+
+        // every thread running now (loader, reverb worker, freeze renderer...),
+        // plus the message thread whose affinity the later ones inherit
+        int numMoved = 0, numRefused = 0;
+
+        for (auto& task : File ("/proc/self/task").findChildFiles (File::findDirectories, false))
+        {
+            if (sched_setaffinity ((pid_t) task.getFileName().getIntValue(), sizeof (others), &others) == 0)
+                ++numMoved;
+            else
+                ++numRefused;
+        }
+
+        processReport << "Other threads kept off CPU " << settings.audioCpu << " (" << numMoved << " threads";
+
+        if (numRefused > 0)
+            processReport << ", " << numRefused << " refused";
+
+        processReport << ")\n";
+    }
+
+    if (settings.lockMemory)
+    {
+        // MCL_FUTURE would make later allocations fail once RLIMIT_MEMLOCK is
+        // reached, so only what exists now is locked and new samples lock themselves
+        if (mlockall (MCL_CURRENT) == 0)
+            processReport << "Memory locked\n";
+        else
+            processReport << "Memory not locked: " << describeError (errno) << " (see ulimit -l)\n";
+
+        SampleBuffer::setLockInMemory (true);
+    }
+   #else
+    processReport << "Real-time tuning is only available on Linux\n";
+   #endif
+}
+
+void RealtimeTuning::applyToAudioThread() noexcept
+{
+   #if JUCE_LINUX
+    sched_param param;
+    param.sched_priority = jlimit (sched_get_priority_min (SCHED_FIFO), sched_get_priority_max (SCHED_FIFO), settings.priority);
+    schedError = pthread_setschedparam (pthread_self(), SCHED_FIFO, &param);
+
+    if (settings.audioCpu >= 0)
+    {
+        cpu_set_t audioSet;
+        CPU_ZERO (&audioSet);
+        CPU_SET (settings.audioCpu, &audioSet);
+        affinityError = pthread_setaffinity_np (pthread_self(), sizeof (audioSet), &audioSet);
+    }
+
+    audioThreadTuned = true;
+   #endif
+}
+
+String RealtimeTuning::getReport() const
+{
+    if (! settings.enabled)
+        return "Real-time tuning disabled\n";
+
+    String report (processReport);
+
+   #if JUCE_LINUX
+    if (! audioThreadTuned)
+        return report + "Audio thread not started yet\n";
+
+    if (schedError == 0)
+        report << "Audio thread SCHED_FIFO, priority " << settings.priority << "\n";
+    else
+        report << "Audio thread left at its default priority: " << describeError (schedError)
+               << " (see ulimit -r, or the audio group limits)\n";
+
+    if (settings.audioCpu >= 0)
+    {
+        if (affinityError == 0)
+            report << "Audio thread pinned to CPU " << settings.audioCpu << "\n";
+        else
+            report << "Audio thread not pinned: " << describeError (affinityError) << "\n";
+    }
+   #endif
+
+    return report;
+}
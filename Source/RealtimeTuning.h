@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    RealtimeTuning.h
+    Created: 19 Oct 2026 4:18:53pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef REALTIMETUNING_H_INCLUDED
+#define REALTIMETUNING_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ Scheduling of the audio thread on Linux: SCHED_FIFO priority, a CPU of its
+ own, the other threads kept off that CPU, and sample memory locked in RAM.
+
+ Each step is optional and may be refused by the system (RLIMIT_RTPRIO,
+ RLIMIT_MEMLOCK, a CPU that does not exist...). A refused step is skipped and
+ the reason reported in getReport(); the engine keeps running either way.
+ On the other platforms nothing is changed.
+ */
+class RealtimeTuning
+{
+public:
+    struct Settings
+    {
+        Settings();
+
+        bool enabled;
+        int priority;       // SCHED_FIFO priority, 1 to 99
+        int audioCpu;       // -1: leave the affinity alone
+        bool lockMemory;    // mlockall() and lock every sample buffer
+    };
+
+    RealtimeTuning();
+
+    /** Message thread, before the audio device is opened. Locks the memory and
+        moves every thread of the process off the audio CPU; threads started
+        later inherit that affinity from the message thread.
+     */
+    void apply (const Settings& newSettings);
+
+    /** Call when the device is about to start: the next audio callback
+        re-applies the priority and affinity to the (possibly new) audio thread.
+     */
+    void audioThreadWillChange() noexcept                   { audioThreadPending = settings.enabled; }
+
+    /** Audio thread, at the top of every callback. Only does something (two
+        system calls) on the first callback after audioThreadWillChange().
+     */
+    void applyToAudioThreadIfNeeded() noexcept
+    {
+        if (audioThreadPending.load (std::memory_order_relaxed) && audioThreadPending.exchange (false))
+            applyToAudioThread();
+    }
+
+    /** True once an audio callback has applied (or failed to apply) the settings. */
+    bool isAudioThreadTuned() const noexcept                { return audioThreadTuned.load(); }
+
+    /** One line per setting, saying what was applied and what was refused. */
+    String getReport() const;
+
+    const Settings& getSettings() const noexcept            { return settings; }
+
+private:
+    void applyToAudioThread() noexcept;
+
+    Settings settings;
+    String processReport;
+
+    std::atomic<bool> audioThreadPending, audioThreadTuned;
+    std::atomic<int> schedError, affinityError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeTuning)
+};
+
+
+#endif  // REALTIMETUNING_H_INCLUDED
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    SampleAnalysis.cpp
+    Created: 19 Oct 2026 11:41:12pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SampleAnalysis.h"
+#include "Trace.h"
+
+constexpr float SampleAnalysis::onsetThresholdDb;
+constexpr float SampleAnalysis::tailThresholdDb;
+
+namespace
+{
+    enum { blockSize = 64, filterChunkSize = 4096 };
+
+    const float silenceLufs = -70.0f;
+
+    float getMagnitude (const AudioSampleBuffer& buffer, int numChannels, int start, int num) noexcept
+    {
+        float magnitude = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            magnitude = jmax (magnitude, buffer.getMagnitude (ch, start, num));
+
+        return magnitude;
+    }
+
+    /** The first sample at or above level: the first block that has one, then within it. */
+    int findFirstAbove (const AudioSampleBuffer& buffer, int numChannels, int length, float level) noexcept
+    {
+        for (int start = 0; start < length; start += blockSize)
+        {
+            const int num = jmin ((int) blockSize, length - start);
+
+            if (getMagnitude (buffer, numChannels, start, num) >= level)
+                for (int i = start; i < start + num; ++i)
+                    if (getMagnitude (buffer, numChannels, i, 1) >= level)
+                        return i;
+        }
+
+        return 0;
+    }
+
+    int findLastAbove (const AudioSampleBuffer& buffer, int numChannels, int length, float level) noexcept
+    {
+        for (int start = ((length - 1) / blockSize) * blockSize; start >= 0; start -= blockSize)
+        {
+            const int num = jmin ((int) blockSize, length - start);
+
+            if (getMagnitude (buffer, numChannels, start, num) >= level)
+                for (int i = start + num; --i >= start;)
+                    if (getMagnitude (buffer, numChannels, i, 1) >= level)
+                        return i;
+        }
+
+        return length - 1;
+    }
+
+    /** Sums of x and x * x, on four lanes within a block and into doubles between
+        blocks, so that a long sample keeps its precision.
+     */
+    void addSums (const float* samples, int num, double& sum, double& sumOfSquares) noexcept
+    {
+        for (int start = 0; start < num; start += blockSize)
+        {
+            const int end = jmin (num, start + (int) blockSize);
+            float s[4] = {}, q[4] = {};
+            int i = start;
+
+            for (; i + 4 <= end; i += 4)
+            {
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    s[lane] += samples[i + lane];
+                    q[lane] += samples[i + lane] * samples[i + lane];
+                }
+            }
+
+            for (; i < end; ++i)
+            {
+                s[0] += samples[i];
+                q[0] += samples[i] * samples[i];
+            }
+
+            sum += (double) ((s[0] + s[1]) + (s[2] + s[3]));
+            sumOfSquares += (double) ((q[0] + q[1]) + (q[2] + q[3]));
+        }
+    }
+
+    /** The two stages of the BS.1770 K-weighting at any rate (high shelf, then high pass). */
+    void makeKWeighting (double sampleRate, IIRCoefficients& shelf, IIRCoefficients& highPass)
+    {
+        {
+            const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+            const double k = std::tan (MathConstants<double>::pi * f0 / sampleRate);
+            const double vh = std::pow (10.0, gainDb / 20.0);
+            const double vb = std::pow (vh, 0.4996667741545416);
+
+            shelf = IIRCoefficients (vh + vb * k / q + k * k, 2.0 * (k * k - vh), vh - vb * k / q + k * k,
+                                     1.0 + k / q + k * k, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+        }
+
+        {
+            const double f0 = 38.13547087602444, q = 0.5003270373238773;
+            const double k = std::tan (MathConstants<double>::pi * f0 / sampleRate);
+
+            highPass = IIRCoefficients (1.0, -2.0, 1.0,
+                                        1.0 + k / q + k * k, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+        }
+    }
+}
+
+//==============================================================================
+SampleAnalysis::SampleAnalysis() noexcept
+:   length (0), numChannels (0),
+    onset (0), tailEnd (0),
+    peak (0.0f), rms (0.0f),
+    loudness (silenceLufs),
+    dcOffset (0.0f)
+{
+}
+
+SampleAnalysis SampleAnalysis::analyse (const SampleBuffer& sample)
+{
+    TRACE_SCOPE ("analyse sample");
+    const AudioSampleBuffer& buffer = sample.getBuffer();
+
+    SampleAnalysis result;
+    result.length = sample.getLength();
+    result.numChannels = sample.getNumChannels();
+    result.tailEnd = result.length;
+
+    if (result.length == 0)
+        return result;
+
+    // the thresholds of the scans are relative to the peak of the whole sample
+    const float wholePeak = getMagnitude (buffer, result.numChannels, 0, result.length);
+
+    if (wholePeak > 0.0f)
+    {
+        result.onset = findFirstAbove (buffer, result.numChannels, result.length, wholePeak * Decibels::decibelsToGain (onsetThresholdDb));
+        result.tailEnd = findLastAbove (buffer, result.numChannels, result.length, wholePeak * Decibels::decibelsToGain (tailThresholdDb)) + 1;
+        result.peak = getMagnitude (buffer, result.numChannels, result.onset, result.tailEnd - result.onset);
+    }
+
+    const int numInside = result.tailEnd - result.onset;
+    double sum = 0.0, sumOfSquares = 0.0, outsideSquares = 0.0;
+
+    for (int ch = 0; ch < result.numChannels; ++ch)
+    {
+        const float* samples = buffer.getReadPointer (ch);
+        addSums (samples, result.onset, sum, outsideSquares);
+        addSums (samples + result.onset, numInside, sum, sumOfSquares);
+        addSums (samples + result.tailEnd, result.length - result.tailEnd, sum, outsideSquares);
+    }
+
+    result.dcOffset = (float) (sum / ((double) result.length * result.numChannels));
+    result.rms = numInside > 0 ? (float) std::sqrt (sumOfSquares / ((double) numInside * result.numChannels)) : 0.0f;
+
+    if (numInside == 0 || sample.getSampleRate() <= 0.0)
+        return result;
+
+    // K-weighted mean square of each channel, filtered a chunk at a time
+    IIRCoefficients shelf, highPass;
+    makeKWeighting (sample.getSampleRate(), shelf, highPass);
+    HeapBlock<float> chunk ((size_t) jmin ((int) filterChunkSize, numInside));
+    double weightedPower = 0.0;
+
+    for (int ch = 0; ch < result.numChannels; ++ch)
+    {
+        IIRFilter shelfFilter, highPassFilter;
+        shelfFilter.setCoefficients (shelf);
+        highPassFilter.setCoefficients (highPass);
+        double channelSum = 0.0, channelSquares = 0.0;
+
+        for (int start = 0; start < numInside; start += filterChunkSize)
+        {
+            const int num = jmin ((int) filterChunkSize, numInside - start);
+            FloatVectorOperations::copy (chunk, buffer.getReadPointer (ch, result.onset + start), num);
+            shelfFilter.processSamples (chunk, num);
+            highPassFilter.processSamples (chunk, num);
+            addSums (chunk, num, channelSum, channelSquares);
+        }
+
+        weightedPower += channelSquares / numInside;
+    }
+
+    if (weightedPower > 0.0)
+        result.loudness = jmax (silenceLufs, (float) (-0.691 + 10.0 * std::log10 (weightedPower)));
+
+    return result;
+}
+
+float SampleAnalysis::getNormalisationGain (float targetLufs) const noexcept
+{
+    if (loudness <= silenceLufs || peak <= 0.0f)
+        return 1.0f;
+
+    return jmin (Decibels::decibelsToGain (targetLufs - loudness), 1.0f / peak);
+}
+
+SampleAnalysis SampleAnalysis::trimmed() const noexcept
+{
+    SampleAnalysis result (*this);
+    result.length = tailEnd - onset;
+    result.onset = 0;
+    result.tailEnd = result.length;
+    return result;
+}
+
+//==============================================================================
+bool SampleAnalysis::writeTo (OutputStream& output) const
+{
+    return output.writeInt (formatMagic)
+        && output.writeInt (formatVersion)
+        && output.writeInt (length)
+        && output.writeInt (numChannels)
+        && output.writeInt (onset)
+        && output.writeInt (tailEnd)
+        && output.writeFloat (peak)
+        && output.writeFloat (rms)
+        && output.writeFloat (loudness)
+        && output.writeFloat (dcOffset);
+}
+
+bool SampleAnalysis::readFrom (InputStream& input, const SampleBuffer& sample)
+{
+    const int64 startPosition = input.getPosition();
+
+    if (input.readInt() != formatMagic
+         || input.readInt() != formatVersion
+         || input.readInt() != sample.getLength()
+         || input.readInt() != sample.getNumChannels())
+        return false;
+
+    SampleAnalysis result;
+    result.length = sample.getLength();
+    result.numChannels = sample.getNumChannels();
+    result.onset = input.readInt();
+    result.tailEnd = input.readInt();
+    result.peak = input.readFloat();
+    result.rms = input.readFloat();
+    result.loudness = input.readFloat();
+    result.dcOffset = input.readFloat();
+
+    // a stream cut short reads as zeros
+    if (input.getPosition() - startPosition != (int64) (6 * sizeof (int) + 4 * sizeof (float)))
+        return false;
+
+    if (result.onset < 0 || result.tailEnd < result.onset || result.tailEnd > result.length)
+        return false;
+
+    *this = result;
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    SampleAnalysis.h
+    Created: 19 Oct 2026 11:41:12pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef SAMPLEANALYSIS_H_INCLUDED
+#define SAMPLEANALYSIS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//==============================================================================
+/**
+ What a sample is made of, measured once when it loads: where the hit starts
+ and where its tail fades out, and how loud it is.
+
+ The onset is the first sample within onsetThresholdDb of the peak and the
+ tail ends after the last one within tailThresholdDb of it, so a hit keeps its
+ attack whatever its level. The peak, RMS and loudness are measured between
+ the two; the DC offset over the whole sample.
+
+ The loudness is that of ITU-R BS.1770 (K-weighting, channels summed) without
+ the gating, which is meant for programmes and not for one-shots a fraction
+ of a second long.
+
+ The scans run on blocks of 64 samples with the vectorised min/max of
+ FloatVectorOperations, the sums on four independent accumulators that the
+ compiler can keep in one register.
+ */
+struct SampleAnalysis
+{
+    SampleAnalysis() noexcept;
+
+    static constexpr float onsetThresholdDb = -50.0f;
+    static constexpr float tailThresholdDb = -60.0f;
+
+    /** Analyses the whole sample, in one pass for the sums plus the two scans. */
+    static SampleAnalysis analyse (const SampleBuffer& sample);
+
+    /** Gain that brings the loudness to targetLufs, lowered so that the peak stays below 0 dBFS. */
+    float getNormalisationGain (float targetLufs) const noexcept;
+
+    /** The same analysis for the sample cut to onset..tailEnd. */
+    SampleAnalysis trimmed() const noexcept;
+
+    //==============================================================================
+    bool writeTo (OutputStream& output) const;
+
+    /** False if the stream was written for a sample of another length or layout. */
+    bool readFrom (InputStream& input, const SampleBuffer& sample);
+
+    //==============================================================================
+    int length, numChannels;
+    int onset, tailEnd;             // in samples, tailEnd excluded
+    float peak, rms;                // linear, between onset and tailEnd
+    float loudness;                 // LUFS, -70 for silence
+    float dcOffset;
+
+private:
+    enum { formatMagic = 0x414e4153, formatVersion = 1 };   // "SANA"
+};
+
+
+#endif  // SAMPLEANALYSIS_H_INCLUDED
@@ -0,0 +1,279 @@
+/*
+  ==============================================================================
+
+    SampleBuffer.cpp
+    Created: 19 Oct 2026 4:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+#include <atomic>
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #include <map>
+#endif
+
+namespace
+{
+    std::atomic<bool> lockNewBuffers (false);
+
+   #if JUCE_LINUX
+    /** Linux page locks do not nest: one munlock() unlocks a page whatever the
+        number of mlock() calls on it. Buffers next to each other on the heap can
+        share a page, so the locks are counted here per page, and a page is only
+        unlocked when the last buffer on it goes.
+     */
+    class PageLocks
+    {
+    public:
+        static PageLocks& getInstance()
+        {
+            static PageLocks instance;
+            return instance;
+        }
+
+        void lock (const void* data, size_t numBytes)       { update (data, numBytes, 1); }
+        void unlock (const void* data, size_t numBytes)     { update (data, numBytes, -1); }
+
+    private:
+        void update (const void* data, size_t numBytes, int delta)
+        {
+            const uintptr_t pageSize = (uintptr_t) sysconf (_SC_PAGESIZE);
+            const uintptr_t first = (uintptr_t) data & ~(pageSize - 1);
+            const uintptr_t end = ((uintptr_t) data + numBytes + pageSize - 1) & ~(pageSize - 1);
+
+            const ScopedLock sl (countLock);
+            uintptr_t runStart = end;
+
+            // the pages that go from unlocked to locked (or back) are passed to the kernel in runs
+            auto flush = [&] (uintptr_t runEnd)
+            {
+                if (runStart < runEnd)
+                {
+                    if (delta > 0)
+                        mlock (reinterpret_cast<const void*> (runStart), runEnd - runStart);
+                    else
+                        munlock (reinterpret_cast<const void*> (runStart), runEnd - runStart);
+                }
+
+                runStart = end;
+            };
+
+            for (uintptr_t page = first; page < end; page += pageSize)
+            {
+                auto found = counts.find (page);
+                const int count = found != counts.end() ? found->second : 0;
+                const int newCount = jmax (0, count + delta);
+
+                if (newCount == 0)
+                {
+                    if (found != counts.end())
+                        counts.erase (found);
+                }
+                else
+                {
+                    counts[page] = newCount;
+                }
+
+                if ((count == 0) != (newCount == 0))
+                {
+                    if (runStart == end)
+                        runStart = page;
+                }
+                else
+                {
+                    flush (page);
+                }
+            }
+
+            flush (end);
+        }
+
+        CriticalSection countLock;
+        std::map<uintptr_t, int> counts;
+    };
+   #endif
+}
+
+//==============================================================================
+SampleBuffer::SampleBuffer (int numChannels, int numSamples, double rate, int sourceVersion)
+:   buffer (jmax (1, numChannels), jmax (0, numSamples) + numGuardSamples),
+    length (jmax (0, numSamples)),
+    sampleRate (rate),
+    version (sourceVersion),
+    isLocked (false)
+{
+    buffer.clear();
+
+    if (lockNewBuffers)
+        lockMemory (true);
+}
+
+SampleBuffer::SampleBuffer (float* const* channels, int numChannels, int numSamples, double rate,
+                            ReferenceCountedObject* storageToKeep)
+:   buffer (channels, jmax (1, numChannels), jmax (0, numSamples) + numGuardSamples),
+    storage (storageToKeep),
+    length (jmax (0, numSamples)),
+    sampleRate (rate),
+    version (0),
+    isLocked (false)
+{
+    // the owner of the storage locks it, e.g. KitPackage its mapping, for as long as it lives
+}
+
+SampleBuffer::~SampleBuffer()
+{
+    if (isLocked)
+        lockMemory (false);
+}
+
+void SampleBuffer::setLockInMemory (bool shouldLock) noexcept
+{
+    lockNewBuffers = shouldLock;
+}
+
+bool SampleBuffer::isLockingInMemory() noexcept
+{
+    return lockNewBuffers;
+}
+
+SampleBuffer::Ptr SampleBuffer::readFrom (AudioFormatReader& reader, int64 maxNumSamples)
+{
+    const int numSamples = (int) jlimit ((int64) 0, jmin (maxNumSamples, (int64) std::numeric_limits<int>::max() - numGuardSamples),
+                                         reader.lengthInSamples);
+    Ptr sample (new SampleBuffer (jmin (2, (int) reader.numChannels), numSamples, reader.sampleRate));
+
+    // the decoders work through one chunk at a time, the guard samples stay zero
+    for (int start = 0; start < numSamples; start += decodeChunkSize)
+        reader.read (&sample->getBuffer(), start, jmin ((int) decodeChunkSize, numSamples - start), start, true, true);
+
+    return sample;
+}
+
+SampleBuffer::Ptr SampleBuffer::createRange (int start, int end) const
+{
+    jassert (0 <= start && start <= end && end <= length);
+    const int numChannels = buffer.getNumChannels();
+
+    // the samples that follow end are still there to be read as guard samples
+    if (storage != nullptr)
+    {
+        HeapBlock<float*> channels ((size_t) numChannels);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch] = const_cast<float*> (buffer.getReadPointer (ch, start));
+
+        return new SampleBuffer (channels, numChannels, end - start, sampleRate, storage.get());
+    }
+
+    Ptr range (new SampleBuffer (numChannels, end - start, sampleRate, version));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        FloatVectorOperations::copy (range->buffer.getWritePointer (ch), buffer.getReadPointer (ch, start), end - start);
+
+    return range;
+}
+
+SampleBuffer::Ptr SampleBuffer::createSynthetic (double sampleRate, double seconds, int seed)
+{
+    const int numSamples = (int) (seconds * sampleRate);
+    Ptr sample (new SampleBuffer (2, numSamples, sampleRate));
+    Random random (seed);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* data = sample->getBuffer().getWritePointer (ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = std::exp (-3.0f * (float) i / (float) numSamples)
+                        * (0.5f * std::sin (MathConstants<float>::twoPi * 110.0f * (float) i / (float) sampleRate)
+                           + 0.3f * (random.nextFloat() * 2.0f - 1.0f));
+    }
+
+    return sample;
+}
+
+void SampleBuffer::lockMemory (bool shouldLock) noexcept
+{
+   #if JUCE_LINUX
+    const size_t numBytes = sizeof (float) * (size_t) buffer.getNumSamples();
+
+    // a refused lock (RLIMIT_MEMLOCK) just leaves the buffer pageable
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        const void* data = buffer.getReadPointer (ch);
+
+        if (shouldLock)
+            PageLocks::getInstance().lock (data, numBytes);
+        else
+            PageLocks::getInstance().unlock (data, numBytes);
+    }
+
+    isLocked = shouldLock;
+   #else
+    ignoreUnused (shouldLock);
+   #endif
+}
+
+//==============================================================================
+ReleasePool::ReleasePool()
+{
+    startTimer (1000);
+}
+
+ReleasePool::~ReleasePool()
+{
+    stopTimer();
+}
+
+void ReleasePool::add (ReferenceCountedObject* object)
+{
+    if (object == nullptr)
+        return;
+
+    const ScopedLock sl (lock);
+
+    for (int i = 0; i < entries.size(); ++i)
+        if (entries.getReference (i).object.get() == object)
+            return;
+
+    Entry entry;
+    entry.object = object;
+    entry.unused = false;
+    entries.add (entry);
+}
+
+void ReleasePool::timerCallback()
+{
+    Array<Entry> toDelete;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = entries.size(); --i >= 0;)
+        {
+            Entry& entry = entries.getReference (i);
+
+            if (entry.object->getReferenceCount() > 1)
+            {
+                entry.unused = false;
+            }
+            else if (! entry.unused)
+            {
+                entry.unused = true;
+            }
+            else
+            {
+                toDelete.add (entry);
+                entries.remove (i);
+            }
+        }
+    }
+
+    // the objects are freed here, outside the lock
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    SampleBuffer.h
+    Created: 19 Oct 2026 4:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef SAMPLEBUFFER_H_INCLUDED
+#define SAMPLEBUFFER_H_INCLUDED
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ Reference-counted audio shared between the loader threads and the voices.
+
+ The buffer has a few extra zeroed samples after the end, so the interpolation
+ can read one sample past the last one.
+ */
+class SampleBuffer    : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<SampleBuffer> Ptr;
+
+    enum { numGuardSamples = 4, decodeChunkSize = 32768 };
+
+    SampleBuffer (int numChannels, int numSamples, double sampleRate, int sourceVersion = 0);
+
+    /** Refers to audio that storage owns (e.g. a memory-mapped KitPackage) and keeps
+        alive, without copying it. Each channel must be followed by numGuardSamples
+        zeros. The audio is read-only: it may be mapped from a file opened for reading.
+     */
+    SampleBuffer (float* const* channels, int numChannels, int numSamples, double sampleRate,
+                  ReferenceCountedObject* storage);
+
+    ~SampleBuffer();
+
+    AudioSampleBuffer& getBuffer() noexcept                 { return buffer; }
+    const AudioSampleBuffer& getBuffer() const noexcept     { return buffer; }
+
+    int getNumChannels() const noexcept                     { return buffer.getNumChannels(); }
+    int getLength() const noexcept                          { return length; }
+    double getSampleRate() const noexcept                   { return sampleRate; }
+
+    /** Identifies what the data was made from, e.g. the parameters of a frozen pad. */
+    int getVersion() const noexcept                         { return version; }
+    size_t getSizeInBytes() const noexcept                  { return sizeof (float) * (size_t) (buffer.getNumChannels() * buffer.getNumSamples()); }
+
+    /** When set, the buffers created afterwards are locked in RAM (Linux only), so
+        the first hit on a pad never waits for a page fault. Set by RealtimeTuning.
+        Buffers on external storage are not locked by themselves: the owner of the
+        storage locks it once, for as long as it keeps it.
+     */
+    static void setLockInMemory (bool shouldLock) noexcept;
+    static bool isLockingInMemory() noexcept;
+
+    /** Decodes the first maxNumSamples samples of reader, two channels at most,
+        straight into a new buffer, decodeChunkSize samples at a time.
+     */
+    static Ptr readFrom (AudioFormatReader& reader, int64 maxNumSamples);
+
+    /** The samples from start to end (excluded). A buffer that refers to external
+        storage gives a view on the same memory; one that owns its audio gives a
+        copy, so that the rest can be freed.
+     */
+    Ptr createRange (int start, int end) const;
+
+    /** A stereo drum-like hit (decaying tone plus noise) with every band of the
+        spectrum in it, for the benchmarks and the golden tests. The same seed
+        always gives the same audio.
+     */
+    static Ptr createSynthetic (double sampleRate, double seconds, int seed);
+
+private:
+    void lockMemory (bool shouldLock) noexcept;
+
+    AudioSampleBuffer buffer;
+    ReferenceCountedObjectPtr<ReferenceCountedObject> storage;
+    int length;
+    double sampleRate;
+    int version;
+    bool isLocked;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleBuffer)
+};
+
+
+//==============================================================================
+/**
+ Keeps a reference to every object handed over to the audio thread, and deletes
+ them on the message thread once nobody else uses them.
+
+ The audio thread can then drop its references without ever freeing memory.
+ An object is only deleted after it has been seen unused on two consecutive
+ ticks, which also covers an audio thread that has just read a raw pointer and
+ not yet taken its reference.
+
+ Share a single instance with SharedResourcePointer<ReleasePool>.
+ */
+class ReleasePool    : private Timer
+{
+public:
+    ReleasePool();
+    ~ReleasePool();
+
+    /** Can be called from any thread but the audio one. */
+    void add (ReferenceCountedObject* object);
+
+private:
+    void timerCallback() override;
+
+    struct Entry
+    {
+        ReferenceCountedObjectPtr<ReferenceCountedObject> object;
+        bool unused;
+    };
+
+    CriticalSection lock;
+    Array<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReleasePool)
+};
+
+
+#endif  // SAMPLEBUFFER_H_INCLUDED
@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    SamplerEngine.cpp
+    Created: 19 Oct 2026 3:06:21pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SamplerEngine.h"
+#include "Trace.h"
+#include "RealtimeChecker.h"
+
+//==============================================================================
+SamplerEngine::SamplerEngine()
+:   deviceSampleRate (0.0),
+    kitDownloader (synth),
+    midiInputHandler (nullptr),
+    isRunning (false)
+{
+    synth.setBusMixer (&mixer);
+}
+
+SamplerEngine::~SamplerEngine()
+{
+    shutdown();
+}
+
+String SamplerEngine::initialise (const EngineConfig& config)
+{
+    shutdown();
+    applySettings (config);
+
+    if (config.impulseResponse.existsAsFile())
+        reverb.loadImpulseResponse (config.impulseResponse);
+
+    // before the device opens, so that its thread starts off the other threads' CPUs
+    realtimeTuning.apply (config.realtime);
+
+    const String error (openAudioDevice (config));
+
+    enableMidiInputs (config.midiInputs);
+    audioDeviceManager.addMidiInputDeviceCallback (String(), this);
+    audioDeviceManager.addAudioCallback (this);
+    isRunning = true;
+
+    // the kit is loaded last, so that a slow or missing download does not hold up the devices
+    kitDownloader.setDownloadEnabled (config.downloadMissingSamples);
+    kitDownloader.setMaxParallelDownloads (config.maxParallelDownloads);
+
+    if (config.kitServer.isNotEmpty())
+        kitDownloader.setServer (config.kitServer);
+
+    if (config.kit > 0)
+        kitDownloader.downloadKit (config.kit);
+
+    return error;
+}
+
+void SamplerEngine::applySettings (const EngineConfig& config)
+{
+    mixer.setRouting (config.routing);
+    limiter.setSettings (config.limiter);
+    reverb.setSendLevel (config.reverbSend);
+    reverb.setReturnLevel (config.reverbReturn);
+    reverb.setUseWorkerThread (config.reverbWorkerThread);
+    synth.setKitRoot (config.kitRoot);
+    synth.setSampleProcessing (config.trimSilence, config.normaliseLoudness);
+}
+
+void SamplerEngine::shutdown()
+{
+    if (! isRunning)
+        return;
+
+    audioDeviceManager.removeAudioCallback (this);
+    audioDeviceManager.removeMidiInputDeviceCallback (String(), this);
+    audioDeviceManager.closeAudioDevice();
+    isRunning = false;
+}
+
+String SamplerEngine::openAudioDevice (const EngineConfig& config)
+{
+    AudioDeviceManager::AudioDeviceSetup setup;
+    setup.outputDeviceName = config.audioDeviceName;
+    setup.sampleRate = config.sampleRate;
+    setup.bufferSize = config.bufferSize;
+
+    // buses can be routed to any output, devices with fewer channels just open the ones they have
+    String error (audioDeviceManager.initialise (0, config.numOutputChannels, nullptr, true,
+                                                 config.audioDeviceName, &setup));
+
+    if (config.audioDeviceType.isNotEmpty()
+         && config.audioDeviceType != audioDeviceManager.getCurrentAudioDeviceType())
+    {
+        audioDeviceManager.setCurrentAudioDeviceType (config.audioDeviceType, true);
+        error = audioDeviceManager.setAudioDeviceSetup (setup, true);
+    }
+
+    if (error.isEmpty() && audioDeviceManager.getCurrentAudioDevice() == nullptr)
+        error = "No audio output device available";
+
+    return error;
+}
+
+void SamplerEngine::enableMidiInputs (const StringArray& names)
+{
+    for (auto& device : MidiInput::getAvailableDevices())
+        if (names.isEmpty() || names.contains (device.name) || names.contains (device.identifier))
+            audioDeviceManager.setMidiInputDeviceEnabled (device.identifier, true);
+}
+
+bool SamplerEngine::isPlayable() const noexcept
+{
+    return isRunning && audioDeviceManager.getCurrentAudioDevice() != nullptr && kitDownloader.isKitReady();
+}
+
+AudioTelemetry::Snapshot SamplerEngine::getTelemetrySnapshot() const
+{
+    AudioTelemetry::Snapshot snapshot (telemetry.getSnapshot());
+
+    if (AudioIODevice* device = audioDeviceManager.getCurrentAudioDevice())
+        snapshot.deviceXruns = device->getXRunCount();
+
+    return snapshot;
+}
+
+void SamplerEngine::addMidiMessage (const MidiMessage& message)
+{
+    midiQueue.push (message);
+}
+
+//==============================================================================
+void SamplerEngine::handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message)
+{
+    if (MidiInputCallback* handler = midiInputHandler.load())
+        handler->handleIncomingMidiMessage (source, message);
+    else
+        midiQueue.push (message);
+}
+
+void SamplerEngine::audioDeviceIOCallback (const float** /*inputChannelData*/, int /*numInputChannels*/,
+                                           float** outputChannelData, int numOutputChannels,
+                                           int numSamples)
+{
+    // first, outside the checked scope: the thread's first trace event claims its ring
+    TRACE_THREAD_NAME ("audio");
+    RT_CHECK_SCOPE;
+    const int64 startTicks = telemetry.callbackStarted();
+    TRACE_SCOPE ("audio callback");
+    const ScopedNoDenormals noDenormals;
+    realtimeTuning.applyToAudioThreadIfNeeded();
+
+    // refers to the device's channels, within the buffer's own preallocated channel space
+    AudioBuffer<float> outputs (outputChannelData, numOutputChannels, numSamples);
+    outputs.clear();
+
+    if (mixer.getMaximumBlockSize() == 0)
+        return;
+
+    callbackMidi.clear();
+
+    {
+        TRACE_SCOPE ("midi in");
+        midiQueue.popInto (callbackMidi, numSamples, deviceSampleRate, Time::getMillisecondCounterHiRes() * 0.001);
+    }
+
+    // the buses are sized for the announced buffer size, bigger callbacks are split
+    for (int startSample = 0; startSample < numSamples;)
+    {
+        const int numThisTime = jmin (numSamples - startSample, mixer.getMaximumBlockSize());
+
+        if (numThisTime == numSamples)
+        {
+            renderBlock (outputs, startSample, numThisTime, callbackMidi);
+        }
+        else
+        {
+            chunkMidi.clear();
+            chunkMidi.addEvents (callbackMidi, startSample, numThisTime, -startSample);
+            renderBlock (outputs, startSample, numThisTime, chunkMidi);
+        }
+
+        startSample += numThisTime;
+    }
+
+    telemetry.callbackFinished (startTicks, numSamples, synth.getNumActiveVoices());
+}
+
+void SamplerEngine::renderBlock (AudioBuffer<float>& outputs, int startSample, int numSamples, const MidiBuffer& midi) noexcept
+{
+    AudioSampleBuffer& mainMix = mixer.beginBlock (numSamples);
+
+    {
+        TRACE_SCOPE ("synth");
+        synth.renderNextBlock (mainMix, midi, 0, numSamples);
+    }
+
+    {
+        TRACE_SCOPE ("bus mix");
+        mixer.mixBuses (outputs, startSample, numSamples);
+    }
+
+    {
+        TRACE_SCOPE ("reverb");
+        reverb.process (mixer.getReverbSend(), mainMix, 0, numSamples);
+    }
+
+    {
+        TRACE_SCOPE ("master chain");
+        masterChain.processBlock (mainMix, 0, numSamples);
+    }
+
+    {
+        TRACE_SCOPE ("limiter");
+        limiter.processBlock (mainMix, 0, numSamples);
+    }
+
+    mixer.writeMainMix (outputs, startSample, numSamples);
+}
+
+void SamplerEngine::audioDeviceAboutToStart (AudioIODevice* device)
+{
+    realtimeTuning.audioThreadWillChange();
+    deviceSampleRate = device->getCurrentSampleRate();
+
+    // room for everything the queue can hold, so the callback never grows them
+    callbackMidi.ensureSize ((size_t) MidiEventQueue::capacity * 16);
+    chunkMidi.ensureSize ((size_t) MidiEventQueue::capacity * 16);
+    midiQueue.discardAll();
+
+    telemetry.prepare (device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+    prepareToPlay (device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+}
+
+void SamplerEngine::prepareToPlay (double sampleRate, int maximumBlockSize)
+{
+    synth.setCurrentPlaybackSampleRate (sampleRate);
+    mixer.prepare (sampleRate, maximumBlockSize);
+    reverb.prepare (sampleRate, maximumBlockSize);
+    masterChain.prepare (sampleRate, maximumBlockSize);
+    limiter.prepare (sampleRate, maximumBlockSize);
+}
+
+void SamplerEngine::audioDeviceStopped()
+{
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    SamplerEngine.h
+    Created: 19 Oct 2026 3:06:21pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef SAMPLERENGINE_H_INCLUDED
+#define SAMPLERENGINE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "DrumSynthesiser.h"
+#include "BusMixer.h"
+#include "FXChain.h"
+#include "MasterDynamics.h"
+#include "ConvolutionReverb.h"
+#include "KitDownloader.h"
+#include "EngineConfig.h"
+#include "RealtimeTuning.h"
+#include "AudioTelemetry.h"
+#include "MidiEventQueue.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ The audio side of the sampler: devices, synth, buses, reverb, master chain
+ and limiter, and the callback that runs them.
+
+ Nothing in here depends on the GUI modules, so the same engine runs inside
+ the desktop app (MainComponent) and the headless console build.
+ */
+class SamplerEngine  : private AudioIODeviceCallback,
+                       private MidiInputCallback
+{
+public:
+    SamplerEngine();
+    ~SamplerEngine();
+
+    /** Opens the devices named in the config, applies its routing and effect
+        settings and starts loading its kit. Returns an error message, or an
+        empty string if the audio device could be opened.
+     */
+    String initialise (const EngineConfig& config);
+
+    /** Stops the audio and closes the devices. */
+    void shutdown();
+
+    /** The routing, limiter, reverb levels and worker, and kit folder of the config, without
+        touching the devices, the kit or the IR (initialise() calls it).
+     */
+    void applySettings (const EngineConfig& config);
+
+    //==============================================================================
+    /** Used when the engine is driven without an audio device, by the offline
+        renderer. The device callback calls the same two functions.
+     */
+    void prepareToPlay (double sampleRate, int maximumBlockSize);
+
+    /** Renders numSamples (at most the maximumBlockSize given to prepareToPlay())
+        into outputs, from startSample. The MIDI event positions are relative to
+        startSample. The outputs must be cleared beforehand.
+     */
+    void renderBlock (AudioBuffer<float>& outputs, int startSample, int numSamples, const MidiBuffer& midi) noexcept;
+
+    /** Queues a message for the next audio block. Any thread, never blocks the audio one. */
+    void addMidiMessage (const MidiMessage& message);
+
+    /** By default the MIDI coming from the devices goes straight to the synth.
+        With a handler set it goes to the handler instead, which should pass it
+        on with addMidiMessage() (the GUI does so through its keyboard state).
+        Set before initialise().
+     */
+    void setMidiInputHandler (MidiInputCallback* handler) noexcept  { midiInputHandler = handler; }
+
+    /** True once the audio device runs and the kit is loaded. */
+    bool isPlayable() const noexcept;
+
+    /** Callback timing and voice counts so far, with the xruns counted by the device. Any thread. */
+    AudioTelemetry::Snapshot getTelemetrySnapshot() const;
+
+    //==============================================================================
+    AudioDeviceManager& getDeviceManager() noexcept             { return audioDeviceManager; }
+    DrumSynthesiser& getSynth() noexcept                        { return synth; }
+    BusMixer& getMixer() noexcept                               { return mixer; }
+    ConvolutionReverb& getReverb() noexcept                     { return reverb; }
+    FXChain& getMasterChain() noexcept                          { return masterChain; }
+    MasterDynamics& getLimiter() noexcept                       { return limiter; }
+    KitDownloader& getKitDownloader() noexcept                  { return kitDownloader; }
+    const RealtimeTuning& getRealtimeTuning() const noexcept    { return realtimeTuning; }
+    AudioTelemetry& getTelemetry() noexcept                     { return telemetry; }
+
+private:
+    //==============================================================================
+    void audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
+                                float** outputChannelData, int numOutputChannels,
+                                int numSamples) override;
+    void audioDeviceAboutToStart (AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+    void handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message) override;
+
+    String openAudioDevice (const EngineConfig& config);
+    void enableMidiInputs (const StringArray& names);
+
+    AudioDeviceManager audioDeviceManager;
+    DrumSynthesiser synth;
+    BusMixer mixer;
+    ConvolutionReverb reverb;
+    FXChain masterChain;
+    MasterDynamics limiter;
+    MidiEventQueue midiQueue;
+    MidiBuffer callbackMidi, chunkMidi;     // sized in audioDeviceAboutToStart(), only cleared afterwards
+    double deviceSampleRate;
+    KitDownloader kitDownloader;
+    RealtimeTuning realtimeTuning;
+    AudioTelemetry telemetry;
+    std::atomic<MidiInputCallback*> midiInputHandler;
+    bool isRunning;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerEngine)
+};
+
+
+#endif  // SAMPLERENGINE_H_INCLUDED
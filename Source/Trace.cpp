@@ -0,0 +1,248 @@
+/*
+  ==============================================================================
+
+    Trace.cpp
+    Created: 19 Oct 2026 7:26:12pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Trace.h"
+#include <memory>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        int64 start, end;
+    };
+
+    struct Ring
+    {
+        HeapBlock<Event> events;
+        std::atomic<uint64> numWritten { 0 };
+        std::atomic<uint64> firstEvent { 0 };     // the first event of the thread that owns it now
+        std::atomic<const char*> threadName { nullptr };
+        std::atomic<bool> inUse { false };
+    };
+
+    struct State
+    {
+        State (int eventsPerThread, int maxThreads)
+        :   capacity (nextPowerOfTwo (jmax (16, eventsPerThread))),
+            numRings (jmax (1, maxThreads)),
+            rings (new Ring[(size_t) numRings]),
+            originTicks (Time::getHighResolutionTicks())
+        {
+            for (int i = 0; i < numRings; ++i)
+                rings[i].events.calloc ((size_t) capacity);
+        }
+
+        const int capacity, numRings;
+        std::unique_ptr<Ring[]> rings;
+        const int64 originTicks;
+    };
+
+    // never deleted: a traced thread may still be writing while the app quits
+    std::atomic<State*> state (nullptr);
+
+    /** Gives the ring back when its thread ends. Its events stay readable until
+        another thread claims it.
+     */
+    struct RingOwner
+    {
+        ~RingOwner()
+        {
+            if (ring != nullptr)
+                ring->inUse.store (false, std::memory_order_release);
+        }
+
+        Ring* ring = nullptr;
+    };
+
+    thread_local Ring* threadRing = nullptr;
+    thread_local bool noRingLeft = false;
+    thread_local RingOwner ringOwner;
+
+    /** The calling thread's ring, claimed on its first event. Lock free; the claim
+        registers the release at thread exit, which may allocate once.
+     */
+    Ring* getThreadRing() noexcept
+    {
+        if (threadRing == nullptr && ! noRingLeft)
+        {
+            State* s = state.load (std::memory_order_acquire);
+
+            if (s == nullptr)
+                return nullptr;
+
+            for (int i = 0; i < s->numRings && threadRing == nullptr; ++i)
+            {
+                Ring& ring = s->rings[i];
+                bool expected = false;
+
+                if (ring.inUse.compare_exchange_strong (expected, true, std::memory_order_acquire))
+                {
+                    ring.threadName = nullptr;
+                    ring.firstEvent = ring.numWritten.load (std::memory_order_relaxed);
+                    threadRing = ringOwner.ring = &ring;
+                }
+            }
+
+            // every ring is owned by a live thread: this one stays untraced
+            noRingLeft = (threadRing == nullptr);
+        }
+
+        return threadRing;
+    }
+}
+
+//==============================================================================
+void Trace::enable (int eventsPerThread, int maxThreads)
+{
+    if (state.load() != nullptr)
+        return;
+
+    State* newState = new State (eventsPerThread, maxThreads);
+    State* expected = nullptr;
+
+    if (! state.compare_exchange_strong (expected, newState))
+        delete newState;
+}
+
+bool Trace::isEnabled() noexcept
+{
+    return state.load() != nullptr;
+}
+
+void Trace::setThreadName (const char* name) noexcept
+{
+    if (Ring* ring = getThreadRing())
+        ring->threadName = name;
+}
+
+void Trace::record (const char* name, int64 startTicks, int64 endTicks) noexcept
+{
+    if (Ring* ring = getThreadRing())
+    {
+        State* s = state.load (std::memory_order_relaxed);
+        const uint64 index = ring->numWritten.load (std::memory_order_relaxed);
+
+        Event& event = ring->events[(size_t) (index & (uint64) (s->capacity - 1))];
+        event.name = name;
+        event.start = startTicks;
+        event.end = endTicks;
+
+        ring->numWritten.store (index + 1, std::memory_order_release);
+    }
+}
+
+//==============================================================================
+String Trace::toChromeJson()
+{
+    MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    State* s = state.load (std::memory_order_acquire);
+
+    if (s != nullptr)
+    {
+        const double microsecondsPerTick = 1.0e6 / (double) Time::getHighResolutionTicksPerSecond();
+        bool first = true;
+        HeapBlock<Event> copy ((size_t) s->capacity);
+
+        for (int tid = 0; tid < s->numRings; ++tid)
+        {
+            Ring& ring = s->rings[tid];
+            const char* threadName = ring.threadName.load();
+
+            if (threadName == nullptr && ring.numWritten.load() == 0)
+                continue;   // never claimed
+
+            json << (first ? "" : ",")
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\""
+                 << (threadName != nullptr ? String (threadName) : "thread " + String (tid)) << "\"}}";
+            first = false;
+
+            // copy, then drop what the thread may have overwritten meanwhile
+            const uint64 end = ring.numWritten.load (std::memory_order_acquire);
+            const uint64 begin = jmax (ring.firstEvent.load(), end > (uint64) s->capacity ? end - (uint64) s->capacity : (uint64) 0);
+
+            for (uint64 i = begin; i < end; ++i)
+                copy[(size_t) (i - begin)] = ring.events[(size_t) (i & (uint64) (s->capacity - 1))];
+
+            const uint64 written = ring.numWritten.load (std::memory_order_acquire);
+            const uint64 firstValid = jmax (begin, written >= (uint64) s->capacity ? written - (uint64) s->capacity + 1 : (uint64) 0);
+
+            for (uint64 i = firstValid; i < end; ++i)
+            {
+                const Event& event = copy[(size_t) (i - begin)];
+
+                json << ",{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                     << ",\"ts\":" << String ((double) (event.start - s->originTicks) * microsecondsPerTick, 3)
+                     << ",\"dur\":" << String ((double) (event.end - event.start) * microsecondsPerTick, 3) << "}";
+            }
+        }
+    }
+
+    json << "]}\n";
+    return json.toString();
+}
+
+Result Trace::writeChromeJson (const File& file)
+{
+    if (! file.replaceWithText (toChromeJson()))
+        return Result::fail ("Cannot write " + file.getFullPathName());
+
+    return Result::ok();
+}
+
+//==============================================================================
+TraceDumper::TraceDumper (const File& f, std::function<int64()> xrunCount)
+:   folder (f),
+    getXrunCount (xrunCount),
+    lastXrunCount (xrunCount()),
+    dumpDueMs (0.0),
+    lastDumpMs (0.0)
+{
+    startTimer (100);
+}
+
+File TraceDumper::dumpNow()
+{
+    lastDumpMs = Time::getMillisecondCounterHiRes();
+    folder.createDirectory();
+
+    const File file (folder.getChildFile ("trace-" + Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S") + ".json")
+                           .getNonexistentSibling());
+    const Result result (Trace::writeChromeJson (file));
+
+    if (result.failed())
+    {
+        Logger::writeToLog (result.getErrorMessage());
+        return File();
+    }
+
+    Logger::writeToLog ("Trace written to " + file.getFullPathName());
+    return file;
+}
+
+void TraceDumper::timerCallback()
+{
+    const double now = Time::getMillisecondCounterHiRes();
+    const int64 xrunCount = getXrunCount();
+
+    if (xrunCount > lastXrunCount && dumpDueMs == 0.0 && now - lastDumpMs >= 5000.0)
+        dumpDueMs = now + 250.0;
+
+    lastXrunCount = xrunCount;
+
+    if (dumpDueMs > 0.0 && now >= dumpDueMs)
+    {
+        dumpDueMs = 0.0;
+        dumpNow();
+    }
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    Trace.h
+    Created: 19 Oct 2026 7:26:12pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+/** Set to 1 in the Projucer's preprocessor definitions to build the trace
+    points in. At 0 the TRACE_ macros expand to nothing.
+ */
+#ifndef SIMPLE_SAMPLER_TRACE
+ #define SIMPLE_SAMPLER_TRACE 0
+#endif
+
+//==============================================================================
+/**
+ Timeline of what each thread did, exported to the Chrome trace format (open
+ it in chrome://tracing or ui.perfetto.dev).
+
+ Every thread writes into a ring of its own, picked from buffers allocated by
+ enable(), so recording an event never allocates or locks: two clock reads
+ and a store. Events are complete spans (name, start, duration) written when
+ the scope ends, so a ring that has wrapped still shows whole spans.
+
+ A thread claims its ring with its first event and gives it back when it
+ ends, so threads that come and go (pool jobs, downloads) do not use the rings
+ up. The claim registers that release with the runtime, which may allocate
+ once: real-time threads should name themselves before their real-time code.
+
+ Names must be string literals: only the pointer is stored.
+ */
+class Trace
+{
+public:
+    /** Allocates the rings, before the threads to trace start. Until then
+        (and when the trace points are compiled out) nothing is recorded.
+     */
+    static void enable (int eventsPerThread = 32768, int maxThreads = 16);
+    static bool isEnabled() noexcept;
+    static constexpr bool isCompiledIn() noexcept           { return SIMPLE_SAMPLER_TRACE != 0; }
+
+    /** Names the calling thread in the trace. */
+    static void setThreadName (const char* name) noexcept;
+
+    /** The last events of every thread, as Chrome trace JSON. Any thread but
+        the traced ones; the recording goes on meanwhile.
+     */
+    static String toChromeJson();
+    static Result writeChromeJson (const File& file);
+
+    //==============================================================================
+    static void record (const char* name, int64 startTicks, int64 endTicks) noexcept;
+
+    struct Scope
+    {
+        explicit Scope (const char* n) noexcept  : name (n), start (Time::getHighResolutionTicks()) {}
+        ~Scope() noexcept                        { Trace::record (name, start, Time::getHighResolutionTicks()); }
+
+        const char* name;
+        int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+};
+
+#if SIMPLE_SAMPLER_TRACE
+ #define TRACE_SCOPE(name)          const Trace::Scope JUCE_JOIN_MACRO (traceScope_, __LINE__) (name)
+ #define TRACE_THREAD_NAME(name)    Trace::setThreadName (name)
+#else
+ #define TRACE_SCOPE(name)
+ #define TRACE_THREAD_NAME(name)
+#endif
+
+
+//==============================================================================
+/**
+ Writes the trace to a folder when the xrun count goes up, a quarter of a
+ second later so that what followed is in it too, and at most every 5 seconds.
+ dumpNow() writes one on demand.
+ */
+class TraceDumper    : private Timer
+{
+public:
+    TraceDumper (const File& folder, std::function<int64()> getXrunCount);
+
+    /** Returns the file written, or an invalid File if it failed. */
+    File dumpNow();
+
+private:
+    void timerCallback() override;
+
+    File folder;
+    std::function<int64()> getXrunCount;
+    int64 lastXrunCount;
+    double dumpDueMs, lastDumpMs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TraceDumper)
+};
+
+
+#endif  // TRACE_H_INCLUDED
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    TransientSlicer.cpp
+    Created: 19 Oct 2026 11:58:03pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TransientSlicer.h"
+#include "Trace.h"
+
+namespace
+{
+    enum { numBins = TransientSlicer::fftSize / 2 + 1, neighbourhood = 8 };
+
+    // log (1 + compression * magnitude) evens out loud and soft hits
+    const float compression = 100.0f;
+
+    float getMagnitude (const AudioSampleBuffer& buffer, int numChannels, int position) noexcept
+    {
+        float magnitude = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            magnitude = jmax (magnitude, std::abs (buffer.getSample (ch, position)));
+
+        return magnitude;
+    }
+
+    struct Candidate
+    {
+        int frame;
+        float strength;
+    };
+}
+
+//==============================================================================
+TransientSlicer::Options::Options()
+:   maxSlices (8),        // the pads of a kit
+    threshold (0.1f),
+    minimumSliceSeconds (0.05)
+{
+}
+
+//==============================================================================
+Array<float> TransientSlicer::computeFlux (const SampleBuffer& sample)
+{
+    TRACE_SCOPE ("spectral flux");
+    const AudioSampleBuffer& buffer = sample.getBuffer();
+    const int length = sample.getLength();
+    const int numChannels = sample.getNumChannels();
+    const int numFrames = length / hopSize + 1;
+
+    dsp::FFT fft (fftOrder);
+    dsp::WindowingFunction<float> window ((size_t) fftSize, dsp::WindowingFunction<float>::hann, false);
+
+    // the frequency-only transform works in place on twice the size
+    HeapBlock<float> frame ((size_t) (2 * fftSize));
+    HeapBlock<float> previous ((size_t) numBins, true), current ((size_t) numBins);
+
+    Array<float> flux;
+    flux.ensureStorageAllocated (numFrames);
+
+    for (int n = 0; n < numFrames; ++n)
+    {
+        // centred on n * hopSize, zero outside the sample
+        const int start = n * hopSize - fftSize / 2;
+        const int first = jmax (0, start), last = jmin (length, start + (int) fftSize);
+
+        FloatVectorOperations::clear (frame, 2 * fftSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            FloatVectorOperations::addWithMultiply (frame + (first - start), buffer.getReadPointer (ch, first),
+                                                    1.0f / numChannels, last - first);
+
+        window.multiplyWithWindowingTable (frame, (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform (frame);
+
+        // a full-scale sine comes out of the windowed transform at about fftSize / 4
+        const float scale = compression * 4.0f / fftSize;
+        float sum = 0.0f;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            current[bin] = std::log1p (scale * frame[bin]);
+            sum += jmax (0.0f, current[bin] - previous[bin]);
+        }
+
+        flux.add (n > 0 ? sum : 0.0f);
+        previous.swapWith (current);
+    }
+
+    return flux;
+}
+
+Array<int> TransientSlicer::findSlices (const SampleBuffer& sample, const Options& options)
+{
+    TRACE_SCOPE ("find slices");
+    Array<int> slices;
+    slices.add (0);
+
+    const int length = sample.getLength();
+
+    if (options.maxSlices <= 1 || length < (int) fftSize || sample.getSampleRate() <= 0.0)
+        return slices;
+
+    const Array<float> flux (computeFlux (sample));
+    const float strongest = FloatVectorOperations::findMaximum (flux.begin(), flux.size());
+
+    if (strongest <= 0.0f)
+        return slices;
+
+    // local maxima above the mean of their neighbourhood
+    Array<Candidate> candidates;
+    const float margin = jlimit (0.0f, 1.0f, options.threshold) * strongest;
+
+    for (int n = 1; n < flux.size(); ++n)
+    {
+        const int first = jmax (0, n - (int) neighbourhood), last = jmin (flux.size(), n + (int) neighbourhood + 1);
+        float sum = 0.0f;
+        bool isMaximum = true;
+
+        // on a plateau, the first frame is the maximum
+        for (int i = first; i < last; ++i)
+        {
+            sum += flux.getUnchecked (i);
+
+            if (i < n ? flux.getUnchecked (i) >= flux.getUnchecked (n) : flux.getUnchecked (i) > flux.getUnchecked (n))
+                isMaximum = false;
+        }
+
+        if (isMaximum && flux.getUnchecked (n) >= sum / (last - first) + margin)
+            candidates.add ({ n, flux.getUnchecked (n) });
+    }
+
+    // the strongest ones first, each far enough from those already taken
+    std::sort (candidates.begin(), candidates.end(),
+               [] (const Candidate& a, const Candidate& b) { return a.strength > b.strength; });
+
+    const int minimumDistance = jmax (1, roundToInt (options.minimumSliceSeconds * sample.getSampleRate()));
+
+    for (auto& candidate : candidates)
+    {
+        if (slices.size() >= options.maxSlices)
+            break;
+
+        const int position = findAttack (sample, candidate.frame * hopSize);
+        bool isFarEnough = position < length;
+
+        for (auto slice : slices)
+            isFarEnough = isFarEnough && std::abs (position - slice) >= minimumDistance;
+
+        if (isFarEnough)
+            slices.add (position);
+    }
+
+    slices.sort();
+    return slices;
+}
+
+int TransientSlicer::findAttack (const SampleBuffer& sample, int frameCentre) noexcept
+{
+    const AudioSampleBuffer& buffer = sample.getBuffer();
+    const int numChannels = sample.getNumChannels();
+    const int first = jmax (0, frameCentre - (int) hopSize);
+    const int last = jmin (sample.getLength(), frameCentre + (int) fftSize / 2);
+
+    if (last <= first)
+        return first;
+
+    float peak = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        peak = jmax (peak, buffer.getMagnitude (ch, first, last - first));
+
+    // the first sample that gets within 6 dB of the loudest one around...
+    int attack = first;
+
+    while (attack < last - 1 && getMagnitude (buffer, numChannels, attack) < 0.5f * peak)
+        ++attack;
+
+    // ...then back to the zero crossing before it, within a hop
+    for (int i = attack; i > jmax (0, attack - (int) hopSize); --i)
+    {
+        float before = 0.0f, after = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            before += buffer.getSample (ch, i - 1);
+            after += buffer.getSample (ch, i);
+        }
+
+        if (before * after <= 0.0f)
+            return i;
+    }
+
+    return attack;
+}
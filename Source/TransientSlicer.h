@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    TransientSlicer.h
+    Created: 19 Oct 2026 11:58:03pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef TRANSIENTSLICER_H_INCLUDED
+#define TRANSIENTSLICER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//==============================================================================
+/**
+ Finds the hits in a loop, to cut it into slices ("tranches") that each start
+ on one.
+
+ The detection function is the spectral flux: the channels are mixed down,
+ cut into Hann-windowed frames of fftSize samples every hopSize samples, and
+ for each frame the log magnitudes that rose since the previous one are summed.
+ A frame is an onset when its flux is the largest in its neighbourhood and
+ stands above the local mean by threshold times the strongest flux of the loop.
+
+ The flux peaks while the attack is still in the second half of the frame, so
+ each slice point is then moved to where the attack reaches half its peak in
+ the audio, and back to the zero crossing just before it, so that a slice does
+ not begin with a click.
+ */
+class TransientSlicer
+{
+public:
+    enum { fftOrder = 10, fftSize = 1 << fftOrder, hopSize = 256 };
+
+    struct Options
+    {
+        Options();
+
+        int maxSlices;                  // the strongest onsets are kept, in time order; 8 by default, a kit's pads
+        float threshold;                // 0..1, of the strongest flux; lower finds softer hits
+        double minimumSliceSeconds;     // two slice points are at least this far apart
+    };
+
+    /** Start of each slice in samples, the first one at 0, at most options.maxSlices
+        of them. Takes a while on a long sample, not for the audio or message thread.
+     */
+    static Array<int> findSlices (const SampleBuffer& sample, const Options& options);
+
+    /** The spectral flux of each frame, frame n being centred on sample n * hopSize. */
+    static Array<float> computeFlux (const SampleBuffer& sample);
+
+private:
+    static int findAttack (const SampleBuffer& sample, int frameCentre) noexcept;
+};
+
+
+#endif  // TRANSIENTSLICER_H_INCLUDED
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 19 Oct 2026 9:02:11am
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef TRIPLEBUFFER_H_INCLUDED
+#define TRIPLEBUFFER_H_INCLUDED
+
+#include <atomic>
+
+//==============================================================================
+/**
+ A wait-free single-writer / single-reader exchange for small structs.
+
+ The writer fills its private slot and publishes it with one atomic exchange,
+ the reader picks up the latest published slot with another one. Neither side
+ ever blocks or allocates, so this is safe to read from the audio thread while
+ the message thread keeps writing.
+ */
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : middle (1), front (0), back (2) {}
+
+    /** Writer side: publishes a new value. */
+    void write (const Type& newValue) noexcept
+    {
+        slots[back] = newValue;
+        back = middle.exchange (back | dirtyFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /** Reader side: returns true and updates the read slot if a new value has
+        been published since the last call.
+     */
+    bool update() noexcept
+    {
+        if ((middle.load (std::memory_order_acquire) & dirtyFlag) == 0)
+            return false;
+
+        front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader side: the value picked up by the last successful update(). */
+    const Type& read() const noexcept       { return slots[front]; }
+
+private:
+    enum { indexMask = 3, dirtyFlag = 4 };
+
+    Type slots[3];
+    std::atomic<int> middle;
+    int front, back;
+};
+
+
+#endif  // TRIPLEBUFFER_H_INCLUDED
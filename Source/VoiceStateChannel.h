@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    VoiceStateChannel.h
+    Created: 19 Oct 2026 9:12:48pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef VOICESTATECHANNEL_H_INCLUDED
+#define VOICESTATECHANNEL_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ What each pad is playing, published by the audio thread after every block
+ for any number of readers (the sampler page, the headless stats).
+
+ A seqlock: the writer makes the sequence odd, stores the fields and makes it
+ even again, and a reader copies the fields until it gets the same even
+ sequence before and after. The writer never waits. A reader only retries
+ when it overlapped a publish, which takes a few hundred nanoseconds. The
+ fields are relaxed atomics, so an overlapped copy is discarded, never torn.
+ */
+class VoiceStateChannel
+{
+public:
+    enum { maxPads = 32 };
+
+    struct PadState
+    {
+        int numVoices;
+        float positionSeconds;      // of the latest voice, in seconds of the sample
+        float envelopeLevel;        // attack/release level of that voice, 0 to 1
+        float peakLevel;            // of all its voices, falling by half every 0.3 s
+    };
+
+    struct Snapshot
+    {
+        Snapshot()                  { zeromem (pads, sizeof (pads)); }
+
+        PadState pads[maxPads];
+    };
+
+    VoiceStateChannel() : sequence (0)
+    {
+        publish (Snapshot());
+    }
+
+    /** The audio thread, the only writer. */
+    void publish (const Snapshot& snapshot) noexcept
+    {
+        const uint32 start = sequence.load (std::memory_order_relaxed);
+        sequence.store (start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        for (int i = 0; i < maxPads; ++i)
+        {
+            pads[i].numVoices.store (snapshot.pads[i].numVoices, std::memory_order_relaxed);
+            pads[i].positionSeconds.store (snapshot.pads[i].positionSeconds, std::memory_order_relaxed);
+            pads[i].envelopeLevel.store (snapshot.pads[i].envelopeLevel, std::memory_order_relaxed);
+            pads[i].peakLevel.store (snapshot.pads[i].peakLevel, std::memory_order_relaxed);
+        }
+
+        sequence.store (start + 2, std::memory_order_release);
+    }
+
+    /** Any thread. */
+    Snapshot read() const noexcept
+    {
+        Snapshot snapshot;
+
+        for (;;)
+        {
+            const uint32 before = sequence.load (std::memory_order_acquire);
+
+            if ((before & 1) != 0)
+                continue;
+
+            for (int i = 0; i < maxPads; ++i)
+            {
+                snapshot.pads[i].numVoices = pads[i].numVoices.load (std::memory_order_relaxed);
+                snapshot.pads[i].positionSeconds = pads[i].positionSeconds.load (std::memory_order_relaxed);
+                snapshot.pads[i].envelopeLevel = pads[i].envelopeLevel.load (std::memory_order_relaxed);
+                snapshot.pads[i].peakLevel = pads[i].peakLevel.load (std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if (sequence.load (std::memory_order_relaxed) == before)
+                return snapshot;
+        }
+    }
+
+private:
+    struct AtomicPadState
+    {
+        std::atomic<int> numVoices;
+        std::atomic<float> positionSeconds, envelopeLevel, peakLevel;
+    };
+
+    std::atomic<uint32> sequence;
+    AtomicPadState pads[maxPads];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoiceStateChannel)
+};
+
+
+#endif  // VOICESTATECHANNEL_H_INCLUDED
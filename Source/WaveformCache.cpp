@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    WaveformCache.cpp
+    Created: 19 Oct 2026 10:21:05pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+#include "Trace.h"
+
+//==============================================================================
+WaveformCache::WaveformCache()
+:   numHits (0),
+    numMisses (0)
+{
+}
+
+void WaveformCache::setFolder (const File& newFolder)
+{
+    const ScopedLock sl (lock);
+    folder = newFolder;
+}
+
+File WaveformCache::getFolder() const
+{
+    const ScopedLock sl (lock);
+    return folder;
+}
+
+String WaveformCache::getKey (const File& audioFile)
+{
+    const String identity (audioFile.getFullPathName()
+                            + "|" + String (audioFile.getSize())
+                            + "|" + String (audioFile.getLastModificationTime().toMilliseconds()));
+
+    return String::toHexString (identity.hashCode64());
+}
+
+WaveformPyramid::Ptr WaveformCache::getWaveform (const File& audioFile, SampleBuffer::Ptr data)
+{
+    TRACE_SCOPE ("waveform");
+    const File cacheFolder (getFolder());
+
+    if (cacheFolder == File() || ! audioFile.existsAsFile())
+        return new WaveformPyramid (data);
+
+    const File entry (cacheFolder.getChildFile (getKey (audioFile) + ".wpyr"));
+
+    {
+        FileInputStream input (entry);
+
+        if (input.openedOk())
+        {
+            if (WaveformPyramid::Ptr cached = WaveformPyramid::readFrom (data, input))
+            {
+                ++numHits;
+                return cached;
+            }
+        }
+    }
+
+    ++numMisses;
+    WaveformPyramid::Ptr waveform (new WaveformPyramid (data));
+    store (entry, [&waveform] (OutputStream& output) { return waveform->writeTo (output); });
+    return waveform;
+}
+
+SampleAnalysis WaveformCache::getAnalysis (const File& audioFile, const SampleBuffer& data)
+{
+    const File cacheFolder (getFolder());
+
+    if (cacheFolder == File() || ! audioFile.existsAsFile())
+        return SampleAnalysis::analyse (data);
+
+    const File entry (cacheFolder.getChildFile (getKey (audioFile) + ".sana"));
+    SampleAnalysis analysis;
+
+    {
+        FileInputStream input (entry);
+
+        if (input.openedOk() && analysis.readFrom (input, data))
+            return analysis;
+    }
+
+    analysis = SampleAnalysis::analyse (data);
+    store (entry, [&analysis] (OutputStream& output) { return analysis.writeTo (output); });
+    return analysis;
+}
+
+void WaveformCache::store (const File& entry, const std::function<bool (OutputStream&)>& write)
+{
+    // a cache that cannot be written only costs the next run a rebuild
+    if (entry.getParentDirectory().createDirectory().failed())
+        return;
+
+    TemporaryFile temp (entry);
+
+    {
+        FileOutputStream output (temp.getFile());
+
+        if (! output.openedOk() || ! write (output))
+            return;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        Logger::outputDebugString ("Cannot write the cache entry " + entry.getFullPathName());
+}
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    WaveformCache.h
+    Created: 19 Oct 2026 10:21:05pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef WAVEFORMCACHE_H_INCLUDED
+#define WAVEFORMCACHE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+#include "SampleAnalysis.h"
+#include <atomic>
+#include <functional>
+
+//==============================================================================
+/**
+ Waveform pyramids and analyses of the sample files, kept on disk between runs.
+
+ A file's entry is named after a hash of its path, size and modification
+ time, so a file that is replaced, e.g. downloaded again, gets a new entry
+ instead of the old waveform. The key is not a hash of the content, which
+ would take a second read of the file. An entry that does not match the
+ decoded sample (a different length or channel count) is rebuilt.
+
+ Any thread may ask for a waveform: the entries are written to a temporary
+ file and moved into place, so two loaders of the same file do not clash.
+ */
+class WaveformCache
+{
+public:
+    WaveformCache();
+
+    /** Where the entries go. An empty File turns the cache off. */
+    void setFolder (const File& newFolder);
+    File getFolder() const;
+
+    /** The pyramid of data, decoded from audioFile: read from the cache if the
+        file has not changed since it was stored, else built and stored.
+     */
+    WaveformPyramid::Ptr getWaveform (const File& audioFile, SampleBuffer::Ptr data);
+
+    /** The SampleAnalysis of data, decoded from audioFile, cached the same way. */
+    SampleAnalysis getAnalysis (const File& audioFile, const SampleBuffer& data);
+
+    /** Name of the entry of a file, from its path, size and modification time. */
+    static String getKey (const File& audioFile);
+
+    int getNumHits() const noexcept                         { return numHits.load(); }
+    int getNumMisses() const noexcept                       { return numMisses.load(); }
+
+private:
+    void store (const File& entry, const std::function<bool (OutputStream&)>& write);
+
+    CriticalSection lock;
+    File folder;
+    std::atomic<int> numHits, numMisses;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformCache)
+};
+
+
+#endif  // WAVEFORMCACHE_H_INCLUDED
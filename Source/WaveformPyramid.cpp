@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.cpp
+    Created: 19 Oct 2026 9:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+#include <limits>
+
+//==============================================================================
+WaveformPyramid::Summary::Summary() noexcept
+:   minimum (std::numeric_limits<float>::max()),
+    maximum (std::numeric_limits<float>::lowest()),
+    sumOfSquares (0.0),
+    numSamples (0)
+{
+}
+
+void WaveformPyramid::Summary::add (float newMinimum, float newMaximum, double newSumOfSquares, int newNumSamples) noexcept
+{
+    minimum = jmin (minimum, newMinimum);
+    maximum = jmax (maximum, newMaximum);
+    sumOfSquares += newSumOfSquares;
+    numSamples += newNumSamples;
+}
+
+float WaveformPyramid::Summary::getRms() const noexcept
+{
+    return numSamples > 0 ? (float) std::sqrt (sumOfSquares / numSamples) : 0.0f;
+}
+
+//==============================================================================
+WaveformPyramid::WaveformPyramid (SampleBuffer::Ptr sourceData)
+:   WaveformPyramid (sourceData, true)
+{
+}
+
+WaveformPyramid::WaveformPyramid (SampleBuffer::Ptr sourceData, bool shouldBuild)
+:   source (sourceData),
+    length (sourceData->getLength()),
+    numChannels (jmax (1, sourceData->getNumChannels())),
+    bucketsPerChannel (0)
+{
+    // one level per halving, down to a single bucket
+    for (int size = jmax (1, (length + baseSize - 1) >> baseShift);; size = (size + 1) / 2)
+    {
+        levelOffsets.add (bucketsPerChannel);
+        levelSizes.add (size);
+        bucketsPerChannel += size;
+
+        if (size == 1)
+            break;
+    }
+
+    buckets.calloc ((size_t) (numChannels * bucketsPerChannel));
+
+    if (shouldBuild)
+        build();
+}
+
+void WaveformPyramid::build() noexcept
+{
+    for (int channel = 0; channel < source->getNumChannels(); ++channel)
+    {
+        const float* samples = source->getBuffer().getReadPointer (channel);
+        Bucket* level = buckets + channel * bucketsPerChannel;
+
+        for (int i = 0; i < levelSizes[0]; ++i)
+        {
+            const int start = i << baseShift;
+            const int num = jmin ((int) baseSize, length - start);
+
+            if (num <= 0)
+                break;
+
+            const Range<float> range (FloatVectorOperations::findMinAndMax (samples + start, num));
+            float sumOfSquares = 0.0f;
+
+            for (int n = 0; n < num; ++n)
+                sumOfSquares += samples[start + n] * samples[start + n];
+
+            level[i] = { range.getStart(), range.getEnd(), sumOfSquares };
+        }
+
+        for (int l = 1; l < levelSizes.size(); ++l)
+        {
+            const Bucket* below = buckets + channel * bucketsPerChannel + levelOffsets[l - 1];
+            Bucket* above = buckets + channel * bucketsPerChannel + levelOffsets[l];
+
+            for (int i = 0; i < levelSizes[l]; ++i)
+            {
+                const Bucket& a = below[2 * i];
+
+                if (2 * i + 1 < levelSizes[l - 1])
+                {
+                    const Bucket& b = below[2 * i + 1];
+                    above[i] = { jmin (a.minimum, b.minimum), jmax (a.maximum, b.maximum), a.sumOfSquares + b.sumOfSquares };
+                }
+                else
+                {
+                    above[i] = a;
+                }
+            }
+        }
+    }
+}
+
+bool WaveformPyramid::writeTo (OutputStream& output) const
+{
+    return output.writeInt (formatMagic)
+        && output.writeInt (formatVersion)
+        && output.writeInt (baseShift)
+        && output.writeInt (length)
+        && output.writeInt (numChannels)
+        && output.writeInt (bucketsPerChannel)
+        && output.write (buckets, getSizeInBytes());
+}
+
+WaveformPyramid::Ptr WaveformPyramid::readFrom (SampleBuffer::Ptr sourceData, InputStream& input)
+{
+    Ptr pyramid (new WaveformPyramid (sourceData, false));
+
+    if (input.readInt() != formatMagic
+         || input.readInt() != formatVersion
+         || input.readInt() != baseShift
+         || input.readInt() != pyramid->length
+         || input.readInt() != pyramid->numChannels
+         || input.readInt() != pyramid->bucketsPerChannel)
+        return nullptr;
+
+    const size_t numBytes = pyramid->getSizeInBytes();
+
+    if (input.read (pyramid->buckets, (int) numBytes) != (int) numBytes)
+        return nullptr;
+
+    return pyramid;
+}
+
+const WaveformPyramid::Bucket& WaveformPyramid::getBucket (int channel, int level, int index) const noexcept
+{
+    return buckets[channel * bucketsPerChannel + levelOffsets.getUnchecked (level) + index];
+}
+
+void WaveformPyramid::addSamples (Summary& summary, const float* samples, int numSamples) const noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const Range<float> range (FloatVectorOperations::findMinAndMax (samples, numSamples));
+    double sumOfSquares = 0.0;
+
+    for (int i = 0; i < numSamples; ++i)
+        sumOfSquares += samples[i] * samples[i];
+
+    summary.add (range.getStart(), range.getEnd(), sumOfSquares, numSamples);
+}
+
+WaveformPyramid::Summary WaveformPyramid::getSummary (int channel, int startSample, int endSample) const noexcept
+{
+    Summary summary;
+    startSample = jlimit (0, length, startSample);
+    endSample = jlimit (startSample, length, endSample);
+
+    if (! isPositiveAndBelow (channel, source->getNumChannels()) || endSample == startSample)
+        return summary;
+
+    const float* samples = source->getBuffer().getReadPointer (channel);
+
+    if (endSample - startSample <= 2 * baseSize)
+    {
+        addSamples (summary, samples + startSample, endSample - startSample);
+        return summary;
+    }
+
+    // the ends that do not fill a level 0 bucket come from the samples...
+    const int alignedStart = (startSample + baseSize - 1) & ~(baseSize - 1);
+    const int alignedEnd = endSample & ~(baseSize - 1);
+
+    addSamples (summary, samples + startSample, alignedStart - startSample);
+    addSamples (summary, samples + alignedEnd, endSample - alignedEnd);
+
+    // ...and the rest from the largest buckets that fit, like a segment tree
+    int first = alignedStart >> baseShift;
+    int last = alignedEnd >> baseShift;
+
+    for (int level = 0; first < last; ++level, first >>= 1, last >>= 1)
+    {
+        const int levelShift = baseShift + level;
+
+        if ((first & 1) != 0)
+        {
+            const Bucket& bucket = getBucket (channel, level, first);
+            summary.add (bucket.minimum, bucket.maximum, bucket.sumOfSquares,
+                         jmin (1 << levelShift, length - (first << levelShift)));
+            ++first;
+        }
+
+        if ((last & 1) != 0)
+        {
+            --last;
+            const Bucket& bucket = getBucket (channel, level, last);
+            summary.add (bucket.minimum, bucket.maximum, bucket.sumOfSquares,
+                         jmin (1 << levelShift, length - (last << levelShift)));
+        }
+    }
+
+    return summary;
+}
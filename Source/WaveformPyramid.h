@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.h
+    Created: 19 Oct 2026 9:47:20pm
+    Author:  Vincent Choqueuse
+
+  ==============================================================================
+*/
+
+#ifndef WAVEFORMPYRAMID_H_INCLUDED
+#define WAVEFORMPYRAMID_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "SampleBuffer.h"
+
+//==============================================================================
+/**
+ Minimum, maximum and sum of squares of a decoded sample at power-of-two
+ resolutions, for drawing it at any zoom in a time that depends on the width
+ drawn and not on the number of samples.
+
+ Level 0 sums up blocks of 64 samples, read once from the buffer with
+ vectorised min/max. Each level above merges pairs of the one below, until a
+ single bucket covers the whole sample. That costs 0.4 bytes per sample and
+ channel, a tenth of the audio. getSummary() answers any range with a
+ logarithmic number of buckets plus at most 128 samples at its ends, read
+ from the sample, which the pyramid keeps a reference to.
+
+ The buckets can be written to a stream and read back for the same sample,
+ which is what WaveformCache does.
+ */
+class WaveformPyramid    : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<WaveformPyramid> Ptr;
+
+    enum { baseShift = 6, baseSize = 1 << baseShift };
+
+    struct Summary
+    {
+        Summary() noexcept;
+
+        void add (float minimum, float maximum, double sumOfSquares, int numSamples) noexcept;
+        float getRms() const noexcept;
+
+        float minimum, maximum;
+        double sumOfSquares;
+        int numSamples;
+    };
+
+    /** Builds the pyramid, in a single pass over the sample. */
+    explicit WaveformPyramid (SampleBuffer::Ptr source);
+
+    const SampleBuffer& getSource() const noexcept          { return *source; }
+    int getLength() const noexcept                          { return length; }
+    int getNumChannels() const noexcept                     { return numChannels; }
+    double getSampleRate() const noexcept                   { return source->getSampleRate(); }
+    int getNumLevels() const noexcept                       { return levelOffsets.size(); }
+    size_t getSizeInBytes() const noexcept                  { return sizeof (Bucket) * (size_t) (numChannels * bucketsPerChannel); }
+
+    /** The samples startSample to endSample (excluded) of a channel, clipped to the sample. */
+    Summary getSummary (int channel, int startSample, int endSample) const noexcept;
+
+    //==============================================================================
+    /** Writes the buckets, in the byte order of this machine. */
+    bool writeTo (OutputStream& output) const;
+
+    /** The pyramid of source from what writeTo() wrote, or nullptr if the stream
+        was written for a sample of another length or layout, or is cut short.
+     */
+    static Ptr readFrom (SampleBuffer::Ptr source, InputStream& input);
+
+private:
+    enum { formatMagic = 0x52595057, formatVersion = 1 };   // "WPYR"
+
+    WaveformPyramid (SampleBuffer::Ptr source, bool shouldBuild);
+    void build() noexcept;
+
+    struct Bucket
+    {
+        float minimum, maximum, sumOfSquares;
+    };
+
+    void addSamples (Summary& summary, const float* samples, int numSamples) const noexcept;
+    const Bucket& getBucket (int channel, int level, int index) const noexcept;
+
+    SampleBuffer::Ptr source;
+    int length, numChannels, bucketsPerChannel;
+    Array<int> levelOffsets, levelSizes;
+    HeapBlock<Bucket> buckets;              // [channel][level][index]
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformPyramid)
+};
+
+
+#endif  // WAVEFORMPYRAMID_H_INCLUDED